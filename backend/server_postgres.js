@@ -2,6 +2,7 @@ const express = require('express');
 const cors = require('cors');
 const bodyParser = require('body-parser');
 const { Pool } = require('pg');
+const crypto = require('crypto');
 const path = require('path');
 
 const app = express();
@@ -51,6 +52,16 @@ async function initializeDatabase() {
         `);
         console.log('Index created/verified');
 
+        // 再送による重複登録を防ぐためのキー（クライアントID:記録ID）
+        await pool.query(`
+            ALTER TABLE leaderboard ADD COLUMN IF NOT EXISTS "submissionKey" TEXT
+        `);
+        await pool.query(`
+            CREATE UNIQUE INDEX IF NOT EXISTS idx_submission_key 
+            ON leaderboard("submissionKey")
+        `);
+        console.log('Submission key index created/verified');
+
         // replaysテーブル
         await pool.query(`
             CREATE TABLE IF NOT EXISTS replays (
@@ -78,11 +89,55 @@ async function initializeDatabase() {
 // データベース初期化
 initializeDatabase();
 
+// 頻繁に取得されるレスポンスにETagを付けて返す
+// クライアントのIf-None-Matchと一致する（内容が変わっていない）場合は、本文なしの304を返す
+function sendWithETag(req, res, body) {
+    const etag = computeETag(body);
+    res.set('ETag', etag);
+    res.set('Cache-Control', 'no-cache'); // キャッシュしてよいが、使う前に再検証する
+    if (req.get('If-None-Match') === etag) {
+        return res.status(304).end();
+    }
+    res.type('application/json').send(JSON.stringify(body));
+}
+
 // ヘルスチェック
 app.get('/api/health', (req, res) => {
     res.json({ status: 'ok', message: 'Leaderboard API is running' });
 });
 
+// ステージ別ランキング（トップ10）を取得する
+async function queryStageBoard(stageNumber) {
+    const result = await pool.query(
+        `SELECT l.id, l.playerName, l.time, l.timestamp, 
+                CASE WHEN r.id IS NOT NULL THEN true ELSE false END as "hasReplay"
+         FROM leaderboard l
+         LEFT JOIN replays r ON l.id = r."leaderboardId"
+         WHERE l."stageNumber" = $1 
+         ORDER BY l.time ASC 
+         LIMIT 10`,
+        [stageNumber]
+    );
+    
+    const records = result.rows.map(row => ({
+        id: row.id,
+        playerName: row.playerName,
+        time: parseFloat(row.time),
+        timestamp: row.timestamp,
+        hasReplay: row.hasReplay
+    }));
+    
+    return {
+        stageNumber: stageNumber,
+        records: records
+    };
+}
+
+// ETag（ランキング単体の取得とまとめての取得で同じ値になる）
+function computeETag(body) {
+    return '"' + crypto.createHash('sha1').update(JSON.stringify(body)).digest('base64') + '"';
+}
+
 // ステージ別ランキング取得（トップ10）
 app.get('/api/leaderboard/:stageNumber', async (req, res) => {
     const stageNumber = parseInt(req.params.stageNumber);
@@ -92,28 +147,33 @@ app.get('/api/leaderboard/:stageNumber', async (req, res) => {
     }
     
     try {
-        const result = await pool.query(
-            `SELECT l.id, l.playerName, l.time, l.timestamp, 
-                    CASE WHEN r.id IS NOT NULL THEN true ELSE false END as "hasReplay"
-             FROM leaderboard l
-             LEFT JOIN replays r ON l.id = r."leaderboardId"
-             WHERE l."stageNumber" = $1 
-             ORDER BY l.time ASC 
-             LIMIT 10`,
-            [stageNumber]
-        );
-        
-        const records = result.rows.map(row => ({
-            id: row.id,
-            playerName: row.playerName,
-            time: parseFloat(row.time),
-            timestamp: row.timestamp,
-            hasReplay: row.hasReplay
-        }));
-        
+        sendWithETag(req, res, await queryStageBoard(stageNumber));
+    } catch (err) {
+        console.error('Database error:', err);
+        res.status(500).json({ error: 'Database error' });
+    }
+});
+
+// 複数ステージのランキングをまとめて取得（例: /api/leaderboards?stages=1,2,3,4,5）
+// クライアントがステージごとに再検証できるよう、ランキングごとのETagを含める
+app.get('/api/leaderboards', async (req, res) => {
+    const stageNumbers = String(req.query.stages || '1,2,3,4,5')
+        .split(',')
+        .map(value => parseInt(value))
+        .filter((value, index, array) => !isNaN(value) && value >= 1 && value <= 5 && array.indexOf(value) === index);
+    
+    if (stageNumbers.length === 0) {
+        return res.status(400).json({ error: 'Invalid stage numbers' });
+    }
+    
+    try {
+        const boards = await Promise.all(stageNumbers.map(queryStageBoard));
         res.json({
-            stageNumber: stageNumber,
-            records: records
+            boards: boards.map(board => ({
+                stageNumber: board.stageNumber,
+                etag: computeETag(board),
+                records: board.records
+            }))
         });
     } catch (err) {
         console.error('Database error:', err);
@@ -123,7 +183,7 @@ app.get('/api/leaderboard/:stageNumber', async (req, res) => {
 
 // タイム記録の送信
 app.post('/api/leaderboard', async (req, res) => {
-    const { stageNumber, time, playerName, replayData } = req.body;
+    const { stageNumber, time, playerName, replayData, clientId, submissionId } = req.body;
     
     // バリデーション
     if (!stageNumber || !time || !playerName) {
@@ -147,18 +207,44 @@ app.post('/api/leaderboard', async (req, res) => {
         return res.status(400).json({ error: 'Invalid player name' });
     }
     
+    // クライアントが再送する記録には、クライアントIDと記録IDが付いている（古いクライアントは付けない）
+    let submissionKey = null;
+    if (clientId !== undefined || submissionId !== undefined) {
+        if (typeof clientId !== 'string' || clientId.length === 0 || clientId.length > 64 ||
+            !Number.isSafeInteger(submissionId) || submissionId <= 0) {
+            return res.status(400).json({ error: 'Invalid submission id' });
+        }
+        submissionKey = `${clientId}:${submissionId}`;
+    }
+    
     const client = await pool.connect();
     try {
         await client.query('BEGIN');
         
-        // ランキングに挿入
+        // ランキングに挿入（同じキーの記録が登録済みなら挿入しない）
         const leaderboardResult = await client.query(
-            `INSERT INTO leaderboard ("stageNumber", "playerName", time) 
-             VALUES ($1, $2, $3) 
+            `INSERT INTO leaderboard ("stageNumber", "playerName", time, "submissionKey") 
+             VALUES ($1, $2, $3, $4) 
+             ON CONFLICT ("submissionKey") DO NOTHING
              RETURNING id`,
-            [stageNum, playerName.substring(0, 50), timeValue]
+            [stageNum, playerName.substring(0, 50), timeValue, submissionKey]
         );
         
+        if (leaderboardResult.rows.length === 0) {
+            // 再送された記録: 登録済みの記録のIDを返す
+            const existing = await client.query(
+                `SELECT id FROM leaderboard WHERE "submissionKey" = $1`,
+                [submissionKey]
+            );
+            await client.query('COMMIT');
+            console.log(`Duplicate submission ${submissionKey}, returning entry ${existing.rows[0].id}`);
+            return res.json({
+                success: true,
+                id: existing.rows[0].id,
+                message: 'Record already saved'
+            });
+        }
+        
         const leaderboardId = leaderboardResult.rows[0].id;
         
         // リプレイデータがあれば保存
@@ -245,7 +331,7 @@ app.get('/api/leaderboard/global/top', async (req, res) => {
             };
         });
         
-        res.json({ topRecords });
+        sendWithETag(req, res, { topRecords });
     } catch (err) {
         console.error('Database error:', err);
         res.status(500).json({ error: 'Database error' });
@@ -18,16 +18,26 @@
 #include "../game/gravity_system.h"
 #include "../game/switch_system.h"
 #include "../game/cannon_system.h"
+#include "../game/trigger_system.h"
 #include "../physics/physics_system.h"
 #include "../core/utils/physics_utils.h"
 #include "../core/utils/ui_config_manager.h"
 #include "../core/utils/resource_path.h"
+#include "../core/utils/time_utils.h"
+#include "../core/utils/completion_queue.h"
+#include "render_interpolation.h"
 #include "../io/input_system.h"
 #include "../io/audio_manager.h"
 #include "../gfx/minimap_renderer.h"
 #include "../game/replay_manager.h"
+#include "../game/replay_recorder.h"
+#include "../game/replay_stream_writer.h"
+#include "../game/input_replay_system.h"
+#include "../game/ghost_system.h"
 #include "../game/save_manager.h"
 #include "../game/online_leaderboard_manager.h"
+#include "../game/leaderboard_cache.h"
+#include "../game/replay_download.h"
 #include "../game/stage_editor.h"
 #include "tutorial_manager.h"
 #include <set>
@@ -42,6 +52,11 @@ namespace GameLoop {
     template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
     template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
+    // ランキングUIの取得の置き換えキー（ステージを切り替えたら古い取得を取り消す）
+    constexpr const char* LEADERBOARD_UI_REQUEST = "leaderboard_ui";
+    // 1フレームで通信などの結果の反映（CompletionQueue::drain）に使う時間の目安（秒）
+    constexpr float COMPLETION_BUDGET_SECONDS = 0.002f;
+
 
     void run(GLFWwindow* window, GameState& gameState, StageManager& stageManager, 
             PlatformSystem& platformSystem,
@@ -51,7 +66,8 @@ namespace GameLoop {
             std::map<int, InputUtils::KeyState>& keyStates,
             std::function<void()> resetStageStartTime,
             std::chrono::high_resolution_clock::time_point& startTime,
-            io::AudioManager& audioManager) {
+            io::AudioManager& audioManager,
+            const LoopSettings& loopSettings) {
         
         if (gameState.audioEnabled) {
             audioManager.loadSFX("jump", ResourcePath::getResourcePath("assets/audio/se/jump.ogg"));
@@ -66,8 +82,23 @@ namespace GameLoop {
         
         auto lastFrameTime = startTime;
         bool gameRunning = true;
+        
+        TimeUtils::FixedTimestep fixedTimestep(loopSettings.simulationTickRate, loopSettings.maxStepsPerFrame);
+        auto frameInterval = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+            std::chrono::duration<double>(loopSettings.renderFpsLimit > 0 ? 1.0 / loopSettings.renderFpsLimit : 0.0));
+        auto nextFrameTime = std::chrono::high_resolution_clock::now();
+        RenderInterpolator renderInterpolator;
+        long long frameIndex = 0;
+        long long lastGameplayFrameIndex = -1;
+        
+        if (loopSettings.useFixedTimestep) {
+            printf("GAME LOOP: Fixed timestep %d Hz (max %d steps/frame), render limit: %s\n",
+                   loopSettings.simulationTickRate, loopSettings.maxStepsPerFrame,
+                   loopSettings.renderFpsLimit > 0 ? std::to_string(loopSettings.renderFpsLimit).c_str() : "vsync");
+        }
 
         while (!glfwWindowShouldClose(window) && gameRunning) {
+            frameIndex++;
             auto currentTime = std::chrono::high_resolution_clock::now();
             float deltaTime = std::chrono::duration<float>(currentTime - lastFrameTime).count();
             
@@ -82,6 +113,10 @@ namespace GameLoop {
             
             float scaledDeltaTime = deltaTime * gameState.progress.timeScale;
             
+            // 通信スレッドなどで終わった処理の結果を、フレームの更新前にメインスレッドで反映する
+            CompletionQueue::drain(COMPLETION_BUDGET_SECONDS);
+            LeaderboardCache::flush();
+            
             if (!gameState.ui.showTitleScreen) {
             int currentStage = stageManager.getCurrentStage();
             // フェードアウト中はBGMを再生しない
@@ -377,11 +412,61 @@ namespace GameLoop {
                 }
             }
 
-            updateGameState(window, gameState, stageManager, platformSystem, deltaTime, scaledDeltaTime, keyStates, resetStageStartTime, audioManager);
+            const RenderSnapshot* renderSnapshot = nullptr;
+            if (loopSettings.useFixedTimestep) {
+                // タイトル画面・Ready画面などから戻った直後は、以前のスナップショットで補間しない
+                if (lastGameplayFrameIndex != frameIndex - 1) {
+                    renderInterpolator.reset();
+                }
+                lastGameplayFrameIndex = frameIndex;
+                
+                // 押した瞬間の入力はフレームごとに保持し、ティックが進まないフレームに押して離しても次のティックで処理する
+                for (auto& [key, state] : keyStates) {
+                    state.latch(glfwGetKey(window, key) == GLFW_PRESS);
+                }
+                InputSystem::latchJumpInput(window);
+                
+                int steps = fixedTimestep.advance(deltaTime);
+                float tickDeltaTime = fixedTimestep.getTickDeltaTime();
+                for (int step = 0; step < steps; step++) {
+                    int stageBeforeStep = stageManager.getCurrentStage();
+                    updateGameState(window, gameState, stageManager, platformSystem, tickDeltaTime, tickDeltaTime * gameState.progress.timeScale, keyStates, resetStageStartTime, audioManager);
+                    // 保持したジャンプはこのティックで処理しなかった場合（UIの操作中など）も次のティックに持ち越さない
+                    InputSystem::clearLatchedJump();
+                    
+                    // 画面遷移が発生した場合は残りのステップを破棄して、次のフレームで遷移先の処理を行う
+                    if (gameState.ui.showTitleScreen || gameState.ui.showReadyScreen ||
+                        gameState.ui.isCountdownActive || gameState.ui.isEndingSequence) {
+                        fixedTimestep.reset();
+                        renderInterpolator.reset();
+                        break;
+                    }
+                    
+                    if (stageManager.getCurrentStage() != stageBeforeStep) {
+                        renderInterpolator.reset();
+                    }
+                    renderInterpolator.capture(gameState, platformSystem);
+                }
+                
+                renderSnapshot = renderInterpolator.interpolate(fixedTimestep.getAlpha(), gameState, platformSystem);
+            } else {
+                updateGameState(window, gameState, stageManager, platformSystem, deltaTime, scaledDeltaTime, keyStates, resetStageStartTime, audioManager);
+            }
 
-            GameLoop::GameRenderer::renderFrame(window, gameState, stageManager, platformSystem, renderer, uiRenderer, gameStateUIRenderer, keyStates, deltaTime);
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(GameConstants::FRAME_DELAY_MS));
+            GameLoop::GameRenderer::renderFrame(window, gameState, stageManager, platformSystem, renderer, uiRenderer, gameStateUIRenderer, keyStates, deltaTime, renderSnapshot);
+            
+            if (!loopSettings.useFixedTimestep) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(GameConstants::FRAME_DELAY_MS));
+            } else if (loopSettings.renderFpsLimit > 0) {
+                // 固定の待機ではなく次フレームの予定時刻まで待機する（処理時間分の遅延を上乗せしない）
+                nextFrameTime += frameInterval;
+                auto now = std::chrono::high_resolution_clock::now();
+                if (nextFrameTime > now) {
+                    std::this_thread::sleep_until(nextFrameTime);
+                } else {
+                    nextFrameTime = now;
+                }
+            }
             
             glfwPollEvents();
         }
@@ -420,6 +505,7 @@ namespace GameLoop {
         GameLoop::GameRenderer::renderPlatforms(platformSystem, renderer, gameState, stageManager);
         
         GameLoop::GameRenderer::renderPlayer(gameState, renderer);
+        GameLoop::GameRenderer::renderGhosts(gameState, renderer, stageManager.getCurrentStage(), 0.0f);
         
         gameStateUIRenderer->renderReadyScreen(width, height, gameState.ui.readyScreenSpeedLevel, gameState.camera.isFirstPersonMode);
         
@@ -503,6 +589,7 @@ namespace GameLoop {
         GameLoop::GameRenderer::renderPlatforms(platformSystem, renderer, gameState, stageManager);
         
         GameLoop::GameRenderer::renderPlayer(gameState, renderer);
+        GameLoop::GameRenderer::renderGhosts(gameState, renderer, stageManager.getCurrentStage(), 0.0f);
         
         int count = (int)gameState.ui.countdownTimer + 1;
         if (count > 0) {
@@ -538,20 +625,11 @@ namespace GameLoop {
                 gameState.progress.timeAttackStartTime = gameState.progress.gameTime;
                 gameState.progress.currentTimeAttackTime = 0.0f;
                 
-                gameState.replay.isRecordingReplay = true;
-                gameState.replay.replayBuffer.clear();
-                gameState.replay.replayRecordTimer = 0.0f;
-                
-                ReplayFrame firstFrame;
-                firstFrame.timestamp = 0.0f;
-                firstFrame.playerPosition = gameState.player.position;
-                firstFrame.playerVelocity = gameState.player.velocity;
-                firstFrame.timeScale = gameState.progress.timeScale;
-                firstFrame.itemCollectedStates.clear();
-                for (const auto& item : gameState.items.items) {
-                    firstFrame.itemCollectedStates.push_back(item.isCollected);
-                }
-                gameState.replay.replayBuffer.push_back(firstFrame);
+                ReplayStreamWriter::begin(stageManager.getCurrentStage(), gameState.items.items.size(), gameState.replay.maxRecordInterval);
+                ReplayRecorder::begin(gameState.replay, ReplayRecorder::captureFrame(gameState, 0.0f));
+                InputReplaySystem::begin(gameState.replay.inputRecording, gameState, platformSystem, stageManager.getCurrentStage());
+                gameState.replay.isRecordingInputs = true;
+                loadGhosts(gameState, stageManager.getCurrentStage());
                 
                 printf("TIME ATTACK: Started at %.2f\n", gameState.progress.timeAttackStartTime);
                 printf("REPLAY: Recording started\n");
@@ -648,18 +726,24 @@ namespace GameLoop {
     void handleStageSelectionArea(GLFWwindow* window, GameState& gameState, StageManager& stageManager, 
                                  PlatformSystem& platformSystem, std::function<void()> resetStageStartTime,
                                  std::map<int, InputUtils::KeyState>& keyStates, float deltaTime) {
+        // フィールドに入るたびに全ステージのランキングを1回のリクエストでまとめて取得しておく
+        // （ランキングボードを開いたときやステージを切り替えたときは、キャッシュから表示できる）
+        static bool isLeaderboardPrefetched = false;
+        if (stageManager.getCurrentStage() != 0) {
+            isLeaderboardPrefetched = false;
+        } else if (!isLeaderboardPrefetched) {
+            isLeaderboardPrefetched = true;
+            if (OnlineLeaderboardManager::isOnlineEnabled()) {
+                OnlineLeaderboardManager::fetchLeaderboards({1, 2, 3, 4, 5});
+            }
+        }
+        
         if (stageManager.getCurrentStage() == 0) {
+            // 選択エリアとランキングボードはTriggerSystemに登録済み（直前のupdateTriggersの結果を参照する）
             int selectedStage = -1;
-            for (int stage = 0; stage < 5; stage++) {
-                const auto& stageArea = GameConstants::STAGE_AREAS[stage];
-                if (gameState.player.position.x > stageArea.x - GameConstants::STAGE_SELECTION_RANGE && 
-                    gameState.player.position.x < stageArea.x + GameConstants::STAGE_SELECTION_RANGE && 
-                    gameState.player.position.z > stageArea.z - GameConstants::STAGE_SELECTION_RANGE && 
-                    gameState.player.position.z < stageArea.z + GameConstants::STAGE_SELECTION_RANGE
-                ) {
-                    selectedStage = stage + 1;
-                    break;
-                }
+            int stageAreaIndex = 0;
+            if (TriggerSystem::findInside(gameState, TriggerType::StageArea, stageAreaIndex)) {
+                selectedStage = stageAreaIndex + 1;
             }
             
             if (selectedStage > 0) {
@@ -677,12 +761,8 @@ namespace GameLoop {
             }
             
             // ランキングボードの検出（JSONから読み込んだ位置を使用）
-            const glm::vec3& leaderboardPos = gameState.ui.leaderboardPosition;
-            bool isNearLeaderboard = 
-                gameState.player.position.x > leaderboardPos.x - GameConstants::LEADERBOARD_SELECTION_RANGE &&
-                gameState.player.position.x < leaderboardPos.x + GameConstants::LEADERBOARD_SELECTION_RANGE &&
-                gameState.player.position.z > leaderboardPos.z - GameConstants::LEADERBOARD_SELECTION_RANGE &&
-                gameState.player.position.z < leaderboardPos.z + GameConstants::LEADERBOARD_SELECTION_RANGE;
+            int leaderboardIndex = 0;
+            bool isNearLeaderboard = TriggerSystem::findInside(gameState, TriggerType::Leaderboard, leaderboardIndex);
             
             if (isNearLeaderboard) {
                 gameState.ui.showLeaderboardAssist = true;
@@ -718,9 +798,14 @@ namespace GameLoop {
                                    MAX_RETRY_COUNT);
                             
                             // リトライ
+                            int retryStage = gameState.ui.leaderboardTargetStage;
                             OnlineLeaderboardManager::fetchLeaderboard(
-                                gameState.ui.leaderboardTargetStage, 
-                                [&gameState](const std::vector<LeaderboardEntry>& entries) {
+                                retryStage, 
+                                [&gameState, retryStage](const std::vector<LeaderboardEntry>& entries) {
+                                    // 表示中のステージと違う（切り替え前のステージの）結果は使わない
+                                    if (retryStage != gameState.ui.leaderboardTargetStage) {
+                                        return;
+                                    }
                                     if (!entries.empty()) {
                                         printf("ONLINE: Loaded leaderboard (%zu entries)\n", entries.size());
                                         gameState.ui.leaderboardEntries = entries;
@@ -731,7 +816,8 @@ namespace GameLoop {
                                         // まだ失敗している場合は、isLoadingLeaderboardをtrueのままにしてリトライを続ける
                                         printf("ONLINE: Failed to load leaderboard, will retry...\n");
                                     }
-                                }
+                                },
+                                LEADERBOARD_UI_REQUEST
                             );
                         }
                     }
@@ -752,6 +838,10 @@ namespace GameLoop {
                     
                     // 新しいステージのランキングを取得
                     OnlineLeaderboardManager::fetchLeaderboard(newStage, [&gameState, newStage](const std::vector<LeaderboardEntry>& entries) {
+                        // 表示中のステージと違う（切り替え前のステージの）結果は使わない
+                        if (newStage != gameState.ui.leaderboardTargetStage) {
+                            return;
+                        }
                         if (!entries.empty()) {
                             printf("ONLINE: Loaded leaderboard for stage %d (%zu entries)\n", newStage, entries.size());
                             gameState.ui.leaderboardEntries = entries;
@@ -762,7 +852,7 @@ namespace GameLoop {
                             // エラー時はLOADINGを続ける（リトライロジックが処理する）
                             printf("ONLINE: Failed to load leaderboard for stage %d, will retry...\n", newStage);
                         }
-                    });
+                    }, LEADERBOARD_UI_REQUEST);
                 }
                 
                 if (keyStates[GLFW_KEY_D].justPressed() || keyStates[GLFW_KEY_RIGHT].justPressed()) {
@@ -779,6 +869,10 @@ namespace GameLoop {
                     
                     // 新しいステージのランキングを取得
                     OnlineLeaderboardManager::fetchLeaderboard(newStage, [&gameState, newStage](const std::vector<LeaderboardEntry>& entries) {
+                        // 表示中のステージと違う（切り替え前のステージの）結果は使わない
+                        if (newStage != gameState.ui.leaderboardTargetStage) {
+                            return;
+                        }
                         if (!entries.empty()) {
                             printf("ONLINE: Loaded leaderboard for stage %d (%zu entries)\n", newStage, entries.size());
                             gameState.ui.leaderboardEntries = entries;
@@ -789,7 +883,7 @@ namespace GameLoop {
                             // エラー時はLOADINGを続ける（リトライロジックが処理する）
                             printf("ONLINE: Failed to load leaderboard for stage %d, will retry...\n", newStage);
                         }
-                    });
+                    }, LEADERBOARD_UI_REQUEST);
                 }
                 
                 // W/Sキーでエントリ選択
@@ -828,35 +922,14 @@ namespace GameLoop {
                                 printf("ONLINE: Loading replay for entry ID %d\n", selectedEntry.id);
                                 gameState.ui.isLoadingReplay = true;
                                 
-                                // リプレイを取得（コールバック内でステージを読み込む）
-                                OnlineLeaderboardManager::fetchReplay(selectedEntry.id, [&gameState](const ReplayData* replayData) {
-                                    if (replayData != nullptr) {
-                                        printf("ONLINE: Replay loaded successfully (%zu frames, stage %d)\n", 
-                                               replayData->frames.size(), replayData->stageNumber);
-                                        
-                                        // リプレイデータをコピーして保存
-                                        gameState.replay.currentReplay = *replayData;
-                                        gameState.replay.pendingReplayStage = replayData->stageNumber;
-                                        gameState.replay.pendingReplayLoad = true;
-                                        gameState.replay.isOnlineReplay = true;  // オンラインリプレイフラグを設定
-                                        
-                                        printf("ONLINE: Replay data prepared - pendingReplayLoad: %s, pendingReplayStage: %d\n",
-                                               gameState.replay.pendingReplayLoad ? "true" : "false",
-                                               gameState.replay.pendingReplayStage);
-                                        
-                                        // ランキングUIを閉じる
-                                        gameState.ui.showLeaderboardUI = false;
-                                        gameState.ui.leaderboardEntries.clear();
-                                        gameState.ui.leaderboardTargetStage = 0;
-                                        gameState.ui.leaderboardSelectedIndex = 0;
-                                        
-                                        printf("ONLINE: Replay data prepared for stage %d (Clear time: %.2fs)\n", 
-                                               replayData->stageNumber, replayData->clearTime);
-                                    } else {
-                                        printf("ONLINE: Failed to load replay - replayData is nullptr\n");
-                                    }
-                                    gameState.ui.isLoadingReplay = false;
-                                });
+                                // 受信しながら復元し、最初の数秒分が届いたら再生を始める（GameUpdaterで受け取る）
+                                if (gameState.replay.replayDownload) {
+                                    gameState.replay.replayDownload->cancel();
+                                }
+                                gameState.replay.replayDownload = std::make_shared<ReplayDownload>();
+                                gameState.replay.isReplayStreaming = false;
+                                gameState.replay.isReplayBuffering = false;
+                                OnlineLeaderboardManager::fetchReplayStream(selectedEntry.id, gameState.replay.replayDownload);
                             } else {
                                 // リプレイがない場合のメッセージ
                                 if (!selectedEntry.hasReplay) {
@@ -882,6 +955,13 @@ namespace GameLoop {
                     gameState.ui.isLoadingLeaderboard = false;
                     gameState.ui.leaderboardRetryCount = 0;
                     gameState.ui.leaderboardRetryTimer = 0.0f;
+                    
+                    // 再生前のリプレイの受信を取り消す
+                    if (gameState.replay.replayDownload && !gameState.replay.isReplayStreaming) {
+                        gameState.replay.replayDownload->cancel();
+                        gameState.replay.replayDownload.reset();
+                        gameState.ui.isLoadingReplay = false;
+                    }
                 }
             } else if (!gameState.ui.showWarpTutorialUI && 
                 !gameState.ui.showUnlockConfirmUI &&
@@ -903,6 +983,10 @@ namespace GameLoop {
                     
                     // ランキングを取得
                     OnlineLeaderboardManager::fetchLeaderboard(targetStage, [&gameState, targetStage](const std::vector<LeaderboardEntry>& entries) {
+                        // 表示中のステージと違う（切り替え前のステージの）結果は使わない
+                        if (targetStage != gameState.ui.leaderboardTargetStage) {
+                            return;
+                        }
                         if (!entries.empty()) {
                             printf("ONLINE: Loaded leaderboard for stage %d (%zu entries)\n", targetStage, entries.size());
                             for (size_t i = 0; i < entries.size(); i++) {
@@ -917,7 +1001,7 @@ namespace GameLoop {
                             // エラー時はLOADINGを続ける（リトライロジックが処理する）
                             printf("ONLINE: Failed to load leaderboard for stage %d, will retry...\n", targetStage);
                         }
-                    });
+                    }, LEADERBOARD_UI_REQUEST);
                 }
             }
         }
@@ -949,6 +1033,53 @@ namespace GameLoop {
         GameLoop::GameRenderer::renderPlayer(gameState, renderer);
     }
 
+    void loadGhosts(GameState& gameState, int stageNumber) {
+        constexpr int ONLINE_GHOST_COUNT = 10;  // オンラインランキングの上位何件をゴーストにするか
+        
+        bool isNewStage = gameState.ghosts.stageNumber != stageNumber;
+        if (isNewStage) {
+            GhostSystem::clear(gameState.ghosts, stageNumber);
+        } else {
+            GhostSystem::removeSource(gameState.ghosts, GhostSource::LocalBest);
+        }
+        
+        ReplayData bestReplay;
+        if (ReplayManager::loadReplay(bestReplay, stageNumber)) {
+            GhostSystem::add(gameState.ghosts, bestReplay, GhostSource::LocalBest, OnlineLeaderboardManager::getPlayerName());
+        }
+        
+        if (!isNewStage || !OnlineLeaderboardManager::isOnlineEnabled()) {
+            return;
+        }
+        
+        // キャッシュと再検証の結果で2回呼ばれることがあるため、ゴーストの取得は最初の1回だけにする
+        auto requested = std::make_shared<bool>(false);
+        OnlineLeaderboardManager::fetchLeaderboard(stageNumber, [stageNumber, requested](const std::vector<LeaderboardEntry>& entries) {
+            if (*requested || entries.empty()) {
+                return;
+            }
+            *requested = true;
+            
+            int rank = 0;
+            for (const auto& entry : entries) {
+                rank++;
+                bool isFriend = OnlineLeaderboardManager::isFriend(entry.playerName);
+                if (!entry.hasReplay || entry.id <= 0 || (rank > ONLINE_GHOST_COUNT && !isFriend)) {
+                    continue;
+                }
+                
+                GhostSource source = isFriend ? GhostSource::Friend : GhostSource::Online;
+                std::string name = entry.playerName;
+                OnlineLeaderboardManager::fetchReplay(entry.id, [stageNumber, source, name](const ReplayData* replayData) {
+                    if (replayData != nullptr) {
+                        GhostSystem::enqueue(stageNumber, *replayData, source, name);
+                    }
+                });
+            }
+            printf("GHOST: Requested online ghosts for stage %d (%zu entries)\n", stageNumber, entries.size());
+        });
+    }
+
     void _old_renderFrame_removed(GLFWwindow* window, GameState& gameState, StageManager& stageManager, 
                     PlatformSystem& platformSystem,
                     std::unique_ptr<gfx::OpenGLRenderer>& renderer,
@@ -1372,6 +1503,13 @@ namespace GameLoop {
             uiRenderer->renderText("SPACE: Pause/Resume  A/D: Rewind/FastForward  T: Speed  ESC: Exit", 
                                   instructionsPos, instructionsConfig.color, instructionsConfig.scale);
             
+            // オンラインリプレイの受信待ち
+            if (gameState.replay.isReplayBuffering) {
+                glm::vec2 bufferingPos = pressTPos;
+                bufferingPos.y += 40.0f;
+                uiRenderer->renderText("BUFFERING...", bufferingPos, pressTConfig.color, pressTConfig.scale);
+            }
+            
             uiRenderer->end2DMode();
         }
         
@@ -19,12 +19,26 @@
 #include "../gfx/game_state_ui_renderer.h"
 #include "../gfx/camera_system.h"
 #include "../core/utils/input_utils.h"
+#include "../core/constants/window_constants.h"
 #include "../io/audio_manager.h"
 
 namespace GameLoop {
+    /**
+     * @brief ゲームループの設定
+     * @details シミュレーションのタイムステップと描画フレームレートを指定します。
+     */
+    struct LoopSettings {
+        bool useFixedTimestep = true;                                          // falseの場合は描画1フレームにつき1回更新（従来の可変タイムステップ）
+        int simulationTickRate = GameConstants::SIMULATION_TICK_RATE;           // シミュレーションのティックレート（Hz）
+        int maxStepsPerFrame = GameConstants::MAX_SIMULATION_STEPS_PER_FRAME;  // 1フレームあたりの最大ステップ数
+        int renderFpsLimit = GameConstants::RENDER_FPS_LIMIT;                  // 描画フレームレート上限（0の場合は垂直同期のみ）
+    };
+    
     /**
      * @brief ゲームループの実行
      * @details メインゲームループを実行し、更新処理と描画処理を統合的に管理します。
+     * 固定タイムステップ時は経過時間をアキュムレータに蓄積し、描画1フレームにつき
+     * 0回以上のシミュレーションステップを実行します。
      * 
      * @param window GLFWウィンドウ
      * @param gameState ゲーム状態
@@ -37,6 +51,7 @@ namespace GameLoop {
      * @param resetStageStartTime ステージ開始時間をリセットする関数
      * @param startTime 開始時刻
      * @param audioManager オーディオマネージャー
+     * @param loopSettings ゲームループの設定（固定タイムステップ、描画フレームレート上限）
      */
     void run(GLFWwindow* window, GameState& gameState, StageManager& stageManager, 
              PlatformSystem& platformSystem,
@@ -46,7 +61,8 @@ namespace GameLoop {
              std::map<int, InputUtils::KeyState>& keyStates,
              std::function<void()> resetStageStartTime,
              std::chrono::high_resolution_clock::time_point& startTime,
-             io::AudioManager& audioManager);
+             io::AudioManager& audioManager,
+             const LoopSettings& loopSettings = LoopSettings());
     
     /**
      * @brief Ready画面の処理
@@ -250,4 +266,14 @@ namespace GameLoop {
      */
     void renderPlayer(GameState& gameState, 
                      std::unique_ptr<gfx::OpenGLRenderer>& renderer);
+    
+    /**
+     * @brief ゴーストを読み込む
+     * @details ローカルの自己ベストを毎回読み込み直します。ステージが変わった場合は全ゴーストを削除し、
+     * オンラインランキングの上位とフレンドのリプレイの取得を開始します（取得したものは描画時に追加されます）。
+     * 
+     * @param gameState ゲーム状態
+     * @param stageNumber ステージ番号
+     */
+    void loadGhosts(GameState& gameState, int stageNumber);
 }
@@ -10,6 +10,7 @@
 #include "../core/utils/resource_path.h"
 #include "../gfx/minimap_renderer.h"
 #include "../game/stage_editor.h"
+#include "../game/ghost_system.h"
 #ifdef __APPLE__
     #include <OpenGL/gl.h>
 #else
@@ -27,7 +28,8 @@ void GameRenderer::renderFrame(GLFWwindow* window, GameState& gameState, StageMa
                     std::unique_ptr<gfx::UIRenderer>& uiRenderer,
                     std::unique_ptr<gfx::GameStateUIRenderer>& gameStateUIRenderer,
                     std::map<int, InputUtils::KeyState>& keyStates,
-                    float deltaTime) {
+                    float deltaTime,
+                    const RenderSnapshot* renderSnapshot) {
         EditorState* editorState = gameState.editorState;
         if (!editorState) {
             static EditorState defaultEditorState;
@@ -101,7 +103,7 @@ void GameRenderer::renderFrame(GLFWwindow* window, GameState& gameState, StageMa
             return;  // タイトル画面中は他の処理をスキップ
         }
         
-        GameRenderer::prepareFrame(window, gameState, stageManager, renderer, width, height, deltaTime);
+        GameRenderer::prepareFrame(window, gameState, stageManager, renderer, width, height, deltaTime, renderSnapshot);
         
         if (editorState->isActive) {
             CameraConfig cameraConfig = CameraSystem::calculateCameraConfig(gameState, stageManager, window, deltaTime);
@@ -124,7 +126,7 @@ void GameRenderer::renderFrame(GLFWwindow* window, GameState& gameState, StageMa
         
         uiRenderer->setWindowSize(width, height);
         
-        GameRenderer::renderPlatforms(platformSystem, renderer, gameState, stageManager);
+        GameRenderer::renderPlatforms(platformSystem, renderer, gameState, stageManager, renderSnapshot);
         
         for (const auto& zone : gameState.gravityZones) {
             if (zone.isActive) {
@@ -175,30 +177,36 @@ void GameRenderer::renderFrame(GLFWwindow* window, GameState& gameState, StageMa
             }
         }
         
-        for (const auto& item : gameState.items.items) {
+        for (size_t itemIndex = 0; itemIndex < gameState.items.items.size(); itemIndex++) {
+            const auto& item = gameState.items.items[itemIndex];
             if (!item.isCollected) {
-                glm::vec3 itemPos = item.position + glm::vec3(0, item.bobHeight, 0);
+                float bobHeight = renderSnapshot ? renderSnapshot->itemBobHeights[itemIndex] : item.bobHeight;
+                float rotationAngle = renderSnapshot ? renderSnapshot->itemRotationAngles[itemIndex] : item.rotationAngle;
+                glm::vec3 itemPos = item.position + glm::vec3(0, bobHeight, 0);
                 
                 bool isRedItem = (item.color.r > 0.9f && item.color.g < 0.1f && item.color.b < 0.1f);
                 bool isGreenItem = (item.color.r < 0.1f && item.color.g > 0.9f && item.color.b < 0.1f);
                 bool isBlueItem = (item.color.r < 0.1f && item.color.g < 0.1f && item.color.b > 0.9f);
                 
                 if (isRedItem && itemFirstTexture != 0) {
-                    renderer->renderer3D.renderTexturedRotatedBox(itemPos, item.size, itemFirstTexture, glm::vec3(0, 1, 0), item.rotationAngle);
+                    renderer->renderer3D.renderTexturedRotatedBox(itemPos, item.size, itemFirstTexture, glm::vec3(0, 1, 0), rotationAngle);
                 } else if (isGreenItem && itemSecondTexture != 0) {
-                    renderer->renderer3D.renderTexturedRotatedBox(itemPos, item.size, itemSecondTexture, glm::vec3(0, 1, 0), item.rotationAngle);
+                    renderer->renderer3D.renderTexturedRotatedBox(itemPos, item.size, itemSecondTexture, glm::vec3(0, 1, 0), rotationAngle);
                 } else if (isBlueItem && itemThirdTexture != 0) {
-                    renderer->renderer3D.renderTexturedRotatedBox(itemPos, item.size, itemThirdTexture, glm::vec3(0, 1, 0), item.rotationAngle);
+                    renderer->renderer3D.renderTexturedRotatedBox(itemPos, item.size, itemThirdTexture, glm::vec3(0, 1, 0), rotationAngle);
                 } else {
-                    renderer->renderer3D.renderRotatedBox(itemPos, item.color, item.size, glm::vec3(0, 1, 0), item.rotationAngle);
+                    renderer->renderer3D.renderRotatedBox(itemPos, item.color, item.size, glm::vec3(0, 1, 0), rotationAngle);
                 }
             }
         }
         
         if (!gameState.camera.isFirstPersonView) {
-            GameRenderer::renderPlayer(gameState, renderer);
+            GameRenderer::renderPlayer(gameState, renderer, renderSnapshot);
         }
         
+        GameRenderer::renderGhosts(gameState, renderer, stageManager.getCurrentStage(),
+                                   renderSnapshot ? renderSnapshot->timeAttackTime : gameState.progress.currentTimeAttackTime);
+        
         if (gameState.progress.isTutorialStage && gameState.ui.showTutorialUI) {
             gameStateUIRenderer->renderTutorialStageUI(width, height, gameState.ui.tutorialMessage, gameState.progress.tutorialStep, gameState.progress.tutorialStepCompleted);
         }
@@ -438,6 +446,13 @@ void GameRenderer::renderFrame(GLFWwindow* window, GameState& gameState, StageMa
             uiRenderer->renderText("SPACE: Pause/Resume  A/D: Rewind/FastForward  T: Speed  ESC: Exit", 
                                   instructionsPos, instructionsConfig.color, instructionsConfig.scale);
             
+            // オンラインリプレイの受信待ち
+            if (gameState.replay.isReplayBuffering) {
+                glm::vec2 bufferingPos = pressTPos;
+                bufferingPos.y += 40.0f;
+                uiRenderer->renderText("BUFFERING...", bufferingPos, pressTConfig.color, pressTConfig.scale);
+            }
+            
             uiRenderer->end2DMode();
         }
         
@@ -726,7 +741,8 @@ void GameRenderer::renderFrame(GLFWwindow* window, GameState& gameState, StageMa
         renderer->endFrame();
     }
 void GameRenderer::prepareFrame(GLFWwindow* window, GameState& gameState, StageManager& stageManager,
-                     std::unique_ptr<gfx::OpenGLRenderer>& renderer, int& width, int& height, float deltaTime) {
+                     std::unique_ptr<gfx::OpenGLRenderer>& renderer, int& width, int& height, float deltaTime,
+                     const RenderSnapshot* renderSnapshot) {
         renderer->beginFrameWithBackground(stageManager.getCurrentStage());
         
         if (gameState.progress.selectedSecretStarType == GameProgressState::SecretStarType::SHADOW_STAR && stageManager.getCurrentStage() != 0) {
@@ -734,7 +750,8 @@ void GameRenderer::prepareFrame(GLFWwindow* window, GameState& gameState, StageM
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         }
         
-        auto cameraConfig = CameraSystem::calculateCameraConfig(gameState, stageManager, window, deltaTime);
+        glm::vec3 cameraFollowPosition = renderSnapshot ? renderSnapshot->playerPosition : gameState.player.position;
+        auto cameraConfig = CameraSystem::calculateCameraConfig(gameState, stageManager, window, deltaTime, cameraFollowPosition);
         CameraSystem::applyCameraConfig(renderer.get(), cameraConfig, window);
         
         auto [w, h] = CameraSystem::getWindowSize(window);
@@ -743,13 +760,14 @@ void GameRenderer::prepareFrame(GLFWwindow* window, GameState& gameState, StageM
 void GameRenderer::renderPlatforms(PlatformSystem& platformSystem, 
                         std::unique_ptr<gfx::OpenGLRenderer>& renderer,
                         GameState& gameState,
-                        StageManager& stageManager) {
-        auto positions = platformSystem.getPositions();
+                        StageManager& stageManager,
+                        const RenderSnapshot* renderSnapshot) {
+        auto positions = renderSnapshot ? renderSnapshot->platformPositions : platformSystem.getPositions();
         auto sizes = platformSystem.getSizes();
         auto colors = platformSystem.getColors();
         auto visibility = platformSystem.getVisibility();
         auto isRotating = platformSystem.getIsRotating();
-        auto rotationAngles = platformSystem.getRotationAngles();
+        auto rotationAngles = renderSnapshot ? renderSnapshot->platformRotationAngles : platformSystem.getRotationAngles();
         auto rotationAxes = platformSystem.getRotationAxes();
         auto blinkAlphas = platformSystem.getBlinkAlphas();
         auto platformTypes = platformSystem.getPlatformTypes();
@@ -870,7 +888,8 @@ void GameRenderer::renderPlatforms(PlatformSystem& platformSystem,
         }
     }
 void GameRenderer::renderPlayer(GameState& gameState, 
-                  std::unique_ptr<gfx::OpenGLRenderer>& renderer) {
+                  std::unique_ptr<gfx::OpenGLRenderer>& renderer,
+                  const RenderSnapshot* renderSnapshot) {
     static GLuint playerTexture = 0;
     static GLuint playerFrontTexture = 0;
     
@@ -888,16 +907,36 @@ void GameRenderer::renderPlayer(GameState& gameState,
         }
     }
     
+    glm::vec3 playerPosition = renderSnapshot ? renderSnapshot->playerPosition : gameState.player.position;
+    
     if (playerTexture != 0 && playerFrontTexture != 0) {
         glm::vec3 playerSize = glm::vec3(GameConstants::PLAYER_SCALE);
         
         if (gameState.player.isShowingFrontTexture) {
-            renderer->renderer3D.renderTexturedBox(gameState.player.position, playerSize, playerFrontTexture, playerTexture);
+            renderer->renderer3D.renderTexturedBox(playerPosition, playerSize, playerFrontTexture, playerTexture);
         } else {
-            renderer->renderer3D.renderTexturedBox(gameState.player.position, playerSize, playerTexture);
+            renderer->renderer3D.renderTexturedBox(playerPosition, playerSize, playerTexture);
         }
     } else {
-        renderer->renderer3D.renderCube(gameState.player.position, gameState.player.color, GameConstants::PLAYER_SCALE);
+        renderer->renderer3D.renderCube(playerPosition, gameState.player.color, GameConstants::PLAYER_SCALE);
     }
 }
+
+void GameRenderer::renderGhosts(GameState& gameState,
+                  std::unique_ptr<gfx::OpenGLRenderer>& renderer,
+                  int stageNumber,
+                  float ghostTime) {
+    auto& ghosts = gameState.ghosts;
+    GhostSystem::addPending(ghosts);  // オンラインから取得したゴーストはここで追加する
+    
+    if (!ghosts.isEnabled || ghosts.stageNumber != stageNumber || GhostSystem::count(ghosts) == 0 ||
+        !gameState.progress.isTimeAttackMode || gameState.replay.isReplayMode) {
+        return;
+    }
+    
+    GhostSystem::update(ghosts, ghostTime);
+    renderer->renderer3D.renderCubeBatch(ghosts.positionX.data(), ghosts.positionY.data(), ghosts.positionZ.data(),
+                                         ghosts.colors.data(), GhostSystem::count(ghosts),
+                                         GameConstants::PLAYER_SCALE, GameConstants::RenderConstants::GHOST_ALPHA);
+}
 } // namespace GameLoop
@@ -20,6 +20,7 @@
 #include "../gfx/ui_renderer.h"
 #include "../gfx/game_state_ui_renderer.h"
 #include "../core/utils/input_utils.h"
+#include "render_interpolation.h"
 
 namespace GameLoop {
 
@@ -30,6 +31,7 @@ namespace GameLoop {
  * - フレーム準備（prepareFrame）
  * - プラットフォームの描画（renderPlatforms）
  * - プレイヤーの描画（renderPlayer）
+ * - ゴーストの描画（renderGhosts）
  */
 class GameRenderer {
 public:
@@ -46,6 +48,7 @@ public:
      * @param gameStateUIRenderer ゲーム状態UIレンダラー
      * @param keyStates キー状態マップ
      * @param deltaTime デルタタイム
+     * @param renderSnapshot 補間済みの描画スナップショット（nullptrの場合は現在の状態をそのまま描画）
      */
     static void renderFrame(
         GLFWwindow* window, 
@@ -56,7 +59,8 @@ public:
         std::unique_ptr<gfx::UIRenderer>& uiRenderer,
         std::unique_ptr<gfx::GameStateUIRenderer>& gameStateUIRenderer,
         std::map<int, InputUtils::KeyState>& keyStates,
-        float deltaTime
+        float deltaTime,
+        const RenderSnapshot* renderSnapshot = nullptr
     );
 
     /**
@@ -70,6 +74,7 @@ public:
      * @param width 出力: ウィンドウ幅
      * @param height 出力: ウィンドウ高さ
      * @param deltaTime デルタタイム
+     * @param renderSnapshot 補間済みの描画スナップショット（カメラの追従先に使用、nullptr可）
      */
     static void prepareFrame(
         GLFWwindow* window, 
@@ -78,7 +83,8 @@ public:
         std::unique_ptr<gfx::OpenGLRenderer>& renderer, 
         int& width, 
         int& height, 
-        float deltaTime
+        float deltaTime,
+        const RenderSnapshot* renderSnapshot = nullptr
     );
 
     /**
@@ -89,12 +95,14 @@ public:
      * @param renderer OpenGLレンダラー
      * @param gameState ゲーム状態
      * @param stageManager ステージマネージャー
+     * @param renderSnapshot 補間済みの描画スナップショット（nullptrの場合は現在の位置・回転角度で描画）
      */
     static void renderPlatforms(
         PlatformSystem& platformSystem, 
         std::unique_ptr<gfx::OpenGLRenderer>& renderer,
         GameState& gameState,
-        StageManager& stageManager
+        StageManager& stageManager,
+        const RenderSnapshot* renderSnapshot = nullptr
     );
 
     /**
@@ -104,10 +112,30 @@ public:
      * 
      * @param gameState ゲーム状態
      * @param renderer OpenGLレンダラー
+     * @param renderSnapshot 補間済みの描画スナップショット（nullptrの場合は現在の位置で描画）
      */
     static void renderPlayer(
         GameState& gameState, 
-        std::unique_ptr<gfx::OpenGLRenderer>& renderer
+        std::unique_ptr<gfx::OpenGLRenderer>& renderer,
+        const RenderSnapshot* renderSnapshot = nullptr
+    );
+
+    /**
+     * @brief ゴーストを描画する
+     * @details 読み込みが完了したゴーストを追加し、再生時間に合わせて全ゴーストの位置を補間して、
+     * 1回の描画呼び出しで半透明のキューブとして描画します。
+     * タイムアタック中（リプレイ再生中を除く）で、現在のステージのゴーストがある場合のみ描画します。
+     * 
+     * @param gameState ゲーム状態
+     * @param renderer OpenGLレンダラー
+     * @param stageNumber 現在のステージ番号
+     * @param ghostTime 再生時間（タイムアタックの経過時間）
+     */
+    static void renderGhosts(
+        GameState& gameState,
+        std::unique_ptr<gfx::OpenGLRenderer>& renderer,
+        int stageNumber,
+        float ghostTime
     );
 };
 
@@ -15,6 +15,7 @@
 #include "../game/gravity_system.h"
 #include "../game/switch_system.h"
 #include "../game/cannon_system.h"
+#include "../game/simulation_system.h"
 #include "../game/stage_editor.h"
 #include "../physics/physics_system.h"
 #include "../core/utils/physics_utils.h"
@@ -24,6 +25,11 @@
 #include "../io/audio_manager.h"
 #include "../gfx/minimap_renderer.h"
 #include "../game/replay_manager.h"
+#include "../game/replay_playback.h"
+#include "../game/replay_recorder.h"
+#include "../game/replay_stream_writer.h"
+#include "../game/replay_download.h"
+#include "../game/input_replay_system.h"
 #include "../game/save_manager.h"
 #include "../game/online_leaderboard_manager.h"
 #include "../core/types/platform_types.h"
@@ -43,6 +49,79 @@ struct overloaded : Ts... { using Ts::operator()...; };
 template<typename... Ts>
 overloaded(Ts...) -> overloaded<Ts...>;
 
+namespace {
+    /**
+     * @brief ダウンロード中のオンラインリプレイを受け取る
+     * @details 再生前は最初の数秒分が届いたら再生を始め、再生中は届いたフレームを末尾に追加します。
+     */
+    void updateReplayDownload(GameState& gameState) {
+        if (!gameState.replay.replayDownload) {
+            return;
+        }
+        ReplayDownload& download = *gameState.replay.replayDownload;
+
+        if (gameState.replay.isReplayStreaming) {
+            // 完了・失敗の判定を先に読み、判定後に届いたフレームも取りこぼさないようにする
+            bool done = download.isComplete() || download.hasFailed();
+            std::vector<ReplayFrame> frames;
+            download.takeFrames(frames);
+            ReplayPlayback::append(gameState.replay, std::move(frames));
+            if (done) {
+                if (download.hasFailed()) {
+                    printf("ONLINE: Replay download failed, playing the %zu frames received\n",
+                           gameState.replay.currentReplay.frames.size());
+                }
+                gameState.replay.isReplayStreaming = false;
+                gameState.replay.isReplayBuffering = false;
+                gameState.replay.replayDownload.reset();
+            }
+            return;
+        }
+
+        if (download.hasFailed()) {
+            printf("ONLINE: Failed to load replay\n");
+            gameState.replay.replayDownload.reset();
+            gameState.ui.isLoadingReplay = false;
+            return;
+        }
+
+        bool complete = download.isComplete();
+        if (!complete && !(download.hasHeader() && download.getBufferedTime() >= ReplayDownload::PREBUFFER_SECONDS)) {
+            return;
+        }
+
+        gameState.replay.currentReplay = download.getHeader();
+        download.takeFrames(gameState.replay.currentReplay.frames);
+        if (gameState.replay.currentReplay.frames.empty()) {
+            printf("ONLINE: Failed to load replay - no frames\n");
+            download.cancel();
+            gameState.replay.replayDownload.reset();
+            gameState.ui.isLoadingReplay = false;
+            return;
+        }
+
+        gameState.replay.pendingReplayStage = gameState.replay.currentReplay.stageNumber;
+        gameState.replay.pendingReplayLoad = true;
+        gameState.replay.isOnlineReplay = true;  // オンラインリプレイフラグを設定
+        gameState.replay.isReplayStreaming = !complete;
+        gameState.replay.isReplayBuffering = false;
+        if (complete) {
+            gameState.replay.replayDownload.reset();
+        }
+
+        printf("ONLINE: Replay data prepared for stage %d (Clear time: %.2fs, %zu frames%s)\n",
+               gameState.replay.currentReplay.stageNumber, gameState.replay.currentReplay.clearTime,
+               gameState.replay.currentReplay.frames.size(), complete ? "" : ", still downloading");
+
+        // ランキングUIを閉じる
+        gameState.ui.showLeaderboardUI = false;
+        gameState.ui.leaderboardEntries.clear();
+        gameState.ui.leaderboardTargetStage = 0;
+        gameState.ui.leaderboardSelectedIndex = 0;
+        gameState.ui.isLoadingReplay = false;
+    }
+}
+
 void GameUpdater::updateGameState(
     GLFWwindow* window, 
     GameState& gameState, 
@@ -60,7 +139,7 @@ void GameUpdater::updateGameState(
     StageEditor::processEditorInput(window, gameState, editorState, platformSystem, stageManager, deltaTime);
     
     if (editorState.isActive) {
-        InputSystem::processInput(window, gameState, deltaTime);
+        InputSystem::processInput(window, gameState, platformSystem, deltaTime);
         return;
     }
     
@@ -98,6 +177,8 @@ void GameUpdater::updateGameState(
         return;
     }
     
+    updateReplayDownload(gameState);
+    
     // リプレイ読み込み待ちの処理
     if (gameState.replay.pendingReplayLoad && gameState.replay.pendingReplayStage > 0) {
         printf("ONLINE: Processing pending replay load - stage: %d\n", gameState.replay.pendingReplayStage);
@@ -119,6 +200,7 @@ void GameUpdater::updateGameState(
         gameState.replay.isReplayMode = true;
         gameState.replay.isReplayPaused = false;
         gameState.replay.replayPlaybackTime = 0.0f;
+        ReplayPlayback::prepare(gameState.replay);
         gameState.replay.previousReplayPlaybackTime = 0.0f;  // 前フレームの時間を初期化
         gameState.replay.replayPlaybackSpeed = 1.0f;
         gameState.ui.showStageClearUI = false;
@@ -225,8 +307,24 @@ void GameUpdater::updateGameState(
             }
         }
         
+        // ダウンロード中は受信済みの位置で止め、少し溜まってから再開する
+        if (gameState.replay.isReplayStreaming && !gameState.replay.currentReplay.frames.empty()) {
+            float availableTime = gameState.replay.currentReplay.frames.back().timestamp;
+            if (gameState.replay.isReplayBuffering &&
+                availableTime - gameState.replay.replayPlaybackTime >= ReplayDownload::RESUME_BUFFER_SECONDS) {
+                gameState.replay.isReplayBuffering = false;
+            } else if (!gameState.replay.isReplayBuffering && gameState.replay.replayPlaybackTime >= availableTime) {
+                gameState.replay.isReplayBuffering = true;
+                printf("REPLAY: Buffering at %.2fs\n", availableTime);
+            }
+            if (gameState.replay.isReplayBuffering) {
+                gameState.replay.replayPlaybackTime = std::min(gameState.replay.replayPlaybackTime, availableTime);
+            }
+        }
+        
         if (!gameState.replay.currentReplay.frames.empty()) {
-            if (gameState.replay.replayPlaybackTime >= gameState.replay.currentReplay.frames.back().timestamp) {
+            if (!gameState.replay.isReplayStreaming &&
+                gameState.replay.replayPlaybackTime >= gameState.replay.currentReplay.frames.back().timestamp) {
                 gameState.replay.replayPlaybackTime = gameState.replay.currentReplay.frames.back().timestamp;
                 
                 // リプレイ終了時に、右上に表示されていた値（replayPlaybackTime）をclearTimeに設定
@@ -265,40 +363,32 @@ void GameUpdater::updateGameState(
                     gameState.player.position = firstFrame.playerPosition;
                     gameState.player.velocity = firstFrame.playerVelocity;
                 } else {
-                    // フレーム間を補間
+                    // フレーム間を補間（境界を含む）
                     bool frameFound = false;
-                for (size_t i = 0; i < gameState.replay.currentReplay.frames.size() - 1; i++) {
-                    const auto& frame1 = gameState.replay.currentReplay.frames[i];
-                    const auto& frame2 = gameState.replay.currentReplay.frames[i + 1];
-                    
-                        // フレーム間の補間（境界を含む）
-                    if (gameState.replay.replayPlaybackTime >= frame1.timestamp && 
-                        gameState.replay.replayPlaybackTime <= frame2.timestamp) {
-                            float t = 0.0f;
-                            if (frame2.timestamp > frame1.timestamp) {
-                                t = (gameState.replay.replayPlaybackTime - frame1.timestamp) / 
-                                 (frame2.timestamp - frame1.timestamp);
-                            }
-                        t = std::clamp(t, 0.0f, 1.0f);
+                    size_t segmentIndex = 0;
+                    if (ReplayPlayback::findSegment(gameState.replay, gameState.replay.replayPlaybackTime, segmentIndex)) {
+                        const auto& frame1 = gameState.replay.currentReplay.frames[segmentIndex];
+                        const auto& frame2 = gameState.replay.currentReplay.frames[segmentIndex + 1];
+                        float t = ReplayPlayback::segmentFactor(gameState.replay, segmentIndex, gameState.replay.replayPlaybackTime);
                         
                         gameState.player.position = glm::mix(frame1.playerPosition, frame2.playerPosition, t);
                         gameState.player.velocity = glm::mix(frame1.playerVelocity, frame2.playerVelocity, t);
-                            
-                            // デバッグ: 位置更新を確認（最初の数フレームのみ）
-                            static int debugFrameCount = 0;
-                            if (debugFrameCount < 10) {
-                                debugFrameCount++;
-                                printf("REPLAY: Frame %d - playbackTime: %.2f, frame1: %.2f, frame2: %.2f, t: %.2f, pos: (%.2f, %.2f, %.2f)\n",
-                                       debugFrameCount, gameState.replay.replayPlaybackTime, frame1.timestamp, frame2.timestamp, t,
-                                       gameState.player.position.x, gameState.player.position.y, gameState.player.position.z);
-                            }
                         
-                        if (!frame1.itemCollectedStates.empty() && frame1.itemCollectedStates.size() == gameState.items.items.size() &&
-                            !frame2.itemCollectedStates.empty() && frame2.itemCollectedStates.size() == gameState.items.items.size()) {
+                        // デバッグ: 位置更新を確認（最初の数フレームのみ）
+                        static int debugFrameCount = 0;
+                        if (debugFrameCount < 10) {
+                            debugFrameCount++;
+                            printf("REPLAY: Frame %d - playbackTime: %.2f, frame1: %.2f, frame2: %.2f, t: %.2f, pos: (%.2f, %.2f, %.2f)\n",
+                                   debugFrameCount, gameState.replay.replayPlaybackTime, frame1.timestamp, frame2.timestamp, t,
+                                   gameState.player.position.x, gameState.player.position.y, gameState.player.position.z);
+                        }
+                        
+                        if (frame1.itemCount() != 0 && frame1.itemCount() == gameState.items.items.size() &&
+                            frame2.itemCount() != 0 && frame2.itemCount() == gameState.items.items.size()) {
                             bool useFrame1 = (t < 0.5f);
                             
-                            for (size_t j = 0; j < gameState.items.items.size() && j < frame1.itemCollectedStates.size(); j++) {
-                                bool shouldBeCollected = useFrame1 ? frame1.itemCollectedStates[j] : frame2.itemCollectedStates[j];
+                            for (size_t j = 0; j < gameState.items.items.size() && j < frame1.itemCount(); j++) {
+                                bool shouldBeCollected = useFrame1 ? frame1.isItemCollected(j) : frame2.isItemCollected(j);
                                 
                                 if (gameState.items.items[j].isCollected != shouldBeCollected) {
                                     if (shouldBeCollected) {
@@ -311,10 +401,8 @@ void GameUpdater::updateGameState(
                                 }
                             }
                         }
-                            
-                            frameFound = true;
-                            break;  // フレームが見つかったらループを抜ける
-                        }
+                        
+                        frameFound = true;
                     }
                     
                     // フレームが見つからなかった場合（最後のフレームより後）、最後のフレームの位置を使用
@@ -342,30 +430,20 @@ void GameUpdater::updateGameState(
     
     if (gameState.replay.isRecordingReplay && gameState.progress.isTimeAttackMode) {
         if (!gameState.ui.isCountdownActive && gameState.progress.timeAttackStartTime > 0.0f) {
-            gameState.replay.replayRecordTimer += deltaTime;
+            // 毎フレーム候補として渡し、補間で再現できないフレームだけを記録する
+            size_t recordedFrames = gameState.replay.replayBuffer.size();
+            ReplayRecorder::captureFrame(gameState, gameState.progress.currentTimeAttackTime, gameState.replay.capturedFrame);
+            ReplayRecorder::record(gameState.replay, gameState.replay.capturedFrame);
+            ReplayStreamWriter::pushRecorded(gameState.replay);
             
-            if (gameState.replay.replayRecordTimer >= gameState.replay.REPLAY_RECORD_INTERVAL) {
-                ReplayFrame frame;
-                frame.timestamp = gameState.progress.currentTimeAttackTime;
-                frame.playerPosition = gameState.player.position;
-                frame.playerVelocity = gameState.player.velocity;
-                frame.timeScale = gameState.progress.timeScale;
-                frame.itemCollectedStates.clear();
-                for (const auto& item : gameState.items.items) {
-                    frame.itemCollectedStates.push_back(item.isCollected);
-                }
-                gameState.replay.replayBuffer.push_back(frame);
-                
-                // デバッグ: 最初の数フレームのみログ出力
-                static int debugFrameCount = 0;
-                if (debugFrameCount < 5) {
-                    debugFrameCount++;
-                    printf("REPLAY: Recorded frame %d - timestamp: %.2f, timeScale: %.1f, pos: (%.2f, %.2f, %.2f), buffer size: %zu\n",
-                           debugFrameCount, frame.timestamp, frame.timeScale, frame.playerPosition.x, frame.playerPosition.y, frame.playerPosition.z,
-                           gameState.replay.replayBuffer.size());
-                }
-                
-                gameState.replay.replayRecordTimer = 0.0f;
+            // デバッグ: 最初の数フレームのみログ出力
+            static int debugFrameCount = 0;
+            if (debugFrameCount < 5 && gameState.replay.replayBuffer.size() > recordedFrames) {
+                debugFrameCount++;
+                const ReplayFrame& frame = gameState.replay.replayBuffer.back();
+                printf("REPLAY: Recorded frame %d - timestamp: %.2f, timeScale: %.1f, pos: (%.2f, %.2f, %.2f), buffer size: %zu\n",
+                       debugFrameCount, frame.timestamp, frame.timeScale, frame.playerPosition.x, frame.playerPosition.y, frame.playerPosition.z,
+                       gameState.replay.replayBuffer.size());
             }
         } else {
             // デバッグ: 記録が停止している理由を確認
@@ -441,17 +519,11 @@ void GameUpdater::updateGameState(
             // 現在のフレームのtimeScaleを取得（簡易版、後で正確な値を計算）
             float currentTimeScaleForDelta = 1.0f;
             if (!gameState.replay.currentReplay.frames.empty()) {
-                // 簡易的に最後のフレームのtimeScaleを使用（正確には後で計算される）
-                for (size_t i = 0; i < gameState.replay.currentReplay.frames.size() - 1; i++) {
-                    const auto& frame1 = gameState.replay.currentReplay.frames[i];
-                    const auto& frame2 = gameState.replay.currentReplay.frames[i + 1];
-                    if (gameState.replay.replayPlaybackTime >= frame1.timestamp && 
-                        gameState.replay.replayPlaybackTime <= frame2.timestamp) {
-                        float t = (frame2.timestamp > frame1.timestamp) ? 
-                                 (gameState.replay.replayPlaybackTime - frame1.timestamp) / (frame2.timestamp - frame1.timestamp) : 0.0f;
-                        currentTimeScaleForDelta = (t < 0.5f) ? frame1.timeScale : frame2.timeScale;
-                        break;
-                    }
+                size_t segmentIndex = 0;
+                if (ReplayPlayback::findSegment(gameState.replay, gameState.replay.replayPlaybackTime, segmentIndex)) {
+                    float t = ReplayPlayback::segmentFactor(gameState.replay, segmentIndex, gameState.replay.replayPlaybackTime);
+                    const auto& frames = gameState.replay.currentReplay.frames;
+                    currentTimeScaleForDelta = (t < 0.5f) ? frames[segmentIndex].timeScale : frames[segmentIndex + 1].timeScale;
                 }
                 if (gameState.replay.replayPlaybackTime > gameState.replay.currentReplay.frames.back().timestamp) {
                     currentTimeScaleForDelta = gameState.replay.currentReplay.frames.back().timeScale;
@@ -470,86 +542,26 @@ void GameUpdater::updateGameState(
         float actualGameTime = 0.0f;
         
         if (!gameState.replay.currentReplay.frames.empty()) {
-            // 最初のフレームより前の場合は最初のフレームのtimeScaleを使用
-            if (gameState.replay.replayPlaybackTime < gameState.replay.currentReplay.frames[0].timestamp) {
-                currentTimeScale = gameState.replay.currentReplay.frames[0].timeScale;
-                // 最初のフレームのtimestampが0.0でない場合でも、actualGameTimeは0.0から始まるべき
-                // 通常プレイでは、currentTimeAttackTime = 0.0から始まるため
-                actualGameTime = gameState.replay.replayPlaybackTime * currentTimeScale;
-            }
-            // 最後のフレームより後ろの場合は最後のフレームのtimeScaleを使用
-            else if (gameState.replay.replayPlaybackTime > gameState.replay.currentReplay.frames.back().timestamp) {
-                currentTimeScale = gameState.replay.currentReplay.frames.back().timeScale;
-                // 最後のフレームまでの累積時間を計算
-                actualGameTime = 0.0f;
-                // 最初のフレーム区間（0.0から最初のフレームのtimestampまで）を考慮
-                const auto& firstFrame = gameState.replay.currentReplay.frames[0];
-                if (firstFrame.timestamp > 0.0f) {
-                    actualGameTime += firstFrame.timestamp * firstFrame.timeScale;
-                }
-                // 2番目以降のフレーム区間
-                for (size_t i = 1; i < gameState.replay.currentReplay.frames.size() - 1; i++) {
-                    const auto& frame1 = gameState.replay.currentReplay.frames[i];
-                    const auto& frame2 = gameState.replay.currentReplay.frames[i + 1];
-                    float segmentTime = frame2.timestamp - frame1.timestamp;
-                    actualGameTime += segmentTime * frame1.timeScale;
-                }
-                // 最後のフレームから現在までの時間を追加
-                float lastSegmentTime = gameState.replay.replayPlaybackTime - gameState.replay.currentReplay.frames.back().timestamp;
-                actualGameTime += lastSegmentTime * currentTimeScale;
-            }
-            // フレーム間を補間
-            else {
-                // 現在のフレーム区間を探す
-                for (size_t i = 0; i < gameState.replay.currentReplay.frames.size() - 1; i++) {
-                    const auto& frame1 = gameState.replay.currentReplay.frames[i];
-                    const auto& frame2 = gameState.replay.currentReplay.frames[i + 1];
-                    
-                    if (gameState.replay.replayPlaybackTime >= frame1.timestamp && 
-                        gameState.replay.replayPlaybackTime <= frame2.timestamp) {
-                        // 現在のフレーム区間のtimeScaleを取得
-                        float t = 0.0f;
-                        if (frame2.timestamp > frame1.timestamp) {
-                            t = (gameState.replay.replayPlaybackTime - frame1.timestamp) / 
-                                 (frame2.timestamp - frame1.timestamp);
-                        }
-                        t = std::clamp(t, 0.0f, 1.0f);
-                        if (frame1.timeScale == frame2.timeScale) {
-                            currentTimeScale = frame1.timeScale;
-                        } else {
-                            currentTimeScale = (t < 0.5f) ? frame1.timeScale : frame2.timeScale;
-                        }
-                        
-                        // 現在のフレーム区間までの累積時間を計算
-                        actualGameTime = 0.0f;
-                        // 最初のフレーム区間（0.0から最初のフレームのtimestampまで）を考慮
-                        const auto& firstFrame = gameState.replay.currentReplay.frames[0];
-                        if (firstFrame.timestamp > 0.0f && i == 0) {
-                            // 最初のフレーム区間内の場合
-                            actualGameTime = gameState.replay.replayPlaybackTime * currentTimeScale;
-                        } else {
-                            // 最初のフレーム区間（0.0から最初のフレームのtimestampまで）を考慮
-                            if (firstFrame.timestamp > 0.0f) {
-                                actualGameTime += firstFrame.timestamp * firstFrame.timeScale;
-                            }
-                            // 2番目以降のフレーム区間（i > 0の場合のみ）
-                            if (i > 0) {
-                                for (size_t j = 1; j < i; j++) {
-                                    const auto& f1 = gameState.replay.currentReplay.frames[j];
-                                    const auto& f2 = gameState.replay.currentReplay.frames[j + 1];
-                                    float segmentTime = f2.timestamp - f1.timestamp;
-                                    actualGameTime += segmentTime * f1.timeScale;
-                                }
-                            }
-                            // 現在のフレーム区間内の時間を追加
-                            float currentSegmentTime = gameState.replay.replayPlaybackTime - frame1.timestamp;
-                            actualGameTime += currentSegmentTime * currentTimeScale;
-                        }
-                        
-                        break;
-                    }
+            const auto& frames = gameState.replay.currentReplay.frames;
+            size_t segmentIndex = 0;
+            // 最初のフレームより前は最初のフレーム、最後のフレームより後ろは最後のフレームのtimeScaleを使用
+            if (gameState.replay.replayPlaybackTime < frames[0].timestamp) {
+                currentTimeScale = frames[0].timeScale;
+            } else if (ReplayPlayback::findSegment(gameState.replay, gameState.replay.replayPlaybackTime, segmentIndex)) {
+                // プレイヤーの補間処理と同じく、区間の前半は前のフレーム、後半は次のフレームのtimeScaleを使用
+                const auto& frame1 = frames[segmentIndex];
+                const auto& frame2 = frames[segmentIndex + 1];
+                if (frame1.timeScale == frame2.timeScale) {
+                    currentTimeScale = frame1.timeScale;
+                } else {
+                    float t = ReplayPlayback::segmentFactor(gameState.replay, segmentIndex, gameState.replay.replayPlaybackTime);
+                    currentTimeScale = (t < 0.5f) ? frame1.timeScale : frame2.timeScale;
                 }
+            } else {
+                currentTimeScale = frames.back().timeScale;
             }
+            // 各フレーム区間のtimeScaleを考慮した累積時間（読み込み時に計算済み）に、現在の区間内の経過分を足す
+            actualGameTime = ReplayPlayback::scaledGameTime(gameState.replay, gameState.replay.replayPlaybackTime, currentTimeScale);
         }
         
         // gameState.progress.timeScaleを更新してUIに反映
@@ -568,6 +580,8 @@ void GameUpdater::updateGameState(
         effectiveDeltaTimeForOtherSystems = effectiveDeltaTime * currentTimeScale;
     } else {
         platformSystem.update(effectiveDeltaTime, gameState.player.position, -1.0f, -1.0f);
+        // ステージ内の時間はティックごとに進める（SimulationSystem::stepと同じ。gameTimeは実時間）
+        gameState.progress.simulationTime += deltaTime;
     }
     GravitySystem::updateGravityZones(gameState, effectiveDeltaTime);
     SwitchSystem::updateSwitches(gameState, effectiveDeltaTimeForOtherSystems);
@@ -577,8 +591,20 @@ void GameUpdater::updateGameState(
         state.update(glfwGetKey(window, key) == GLFW_PRESS);
     }
     
+    gameState.replay.tickInput = TickInput();
     GameLoop::InputHandler::handleInputProcessing(window, gameState, stageManager, platformSystem, keyStates, resetStageStartTime, scaledDeltaTime, audioManager);
     
+    // タイムアタックの経過時間を進めたティックごとに、適用した入力を記録する（ゴールするティックを含む）
+    if (gameState.replay.isRecordingInputs && gameState.progress.isTimeAttackMode &&
+        !gameState.ui.isCountdownActive && gameState.progress.timeAttackStartTime > 0.0f && !gameState.progress.isStageCompleted) {
+        gameState.replay.tickInput.timeScaleLevel = static_cast<uint8_t>(std::clamp(gameState.progress.timeScaleLevel, 0, 2));
+        if (!InputReplaySystem::record(gameState.replay.inputRecording, gameState.replay.tickInput, deltaTime)) {
+            gameState.replay.isRecordingInputs = false;
+            gameState.replay.inputRecording.inputs.clear();
+            printf("REPLAY: Input recording stopped (simulation is not running at a fixed tick)\n");
+        }
+    }
+    
     if (!gameState.replay.isReplayMode && !gameState.progress.isGameOver) {
         GameUpdater::updatePhysicsAndCollisions(window, gameState, stageManager, platformSystem, deltaTime, scaledDeltaTime, audioManager);
     } else {
@@ -590,6 +616,7 @@ void GameUpdater::updateGameState(
     }
     
     if (!gameState.replay.isReplayMode || !gameState.replay.isReplayPaused) {
+        SimulationSystem::updateTriggers(gameState, platformSystem);
         GameUpdater::updateItems(gameState, scaledDeltaTime, audioManager);
     }
     handleStageSelectionArea(window, gameState, stageManager, platformSystem, resetStageStartTime, keyStates, deltaTime);
@@ -604,386 +631,158 @@ void GameUpdater::updatePhysicsAndCollisions(
     float scaledDeltaTime, 
     io::AudioManager& audioManager
 ) {
-    if (gameState.progress.isGameOver) {
-        return;
-    }
-    
-    glm::vec3 gravityDirection = glm::vec3(0, -1, 0);
-    bool inGravityZone = PhysicsSystem::isPlayerInGravityZone(gameState, gameState.player.position, gravityDirection);
-    
-    float gravityStrength = PhysicsUtils::calculateGravityStrength(GameConstants::BASE_GRAVITY, deltaTime, gameState.progress.timeScale, gravityDirection, gameState);
-    glm::vec3 gravityForce = gravityDirection * gravityStrength;
-
-    gameState.player.velocity += gravityForce;
-    
-    float airResistance = (gameState.progress.timeScale > 1.0f) ? GameConstants::AIR_RESISTANCE_FAST : GameConstants::AIR_RESISTANCE_NORMAL;
-    gameState.player.velocity *= airResistance;
+    SimulationEvents events;
+    events.onPlaySFX = [&](const std::string& sfxName) {
+        if (gameState.audioEnabled) {
+            audioManager.playSFX(sfxName);
+        }
+    };
+    events.onGoalReached = [&]() {
+        handleGoalReached(gameState, stageManager, audioManager);
+    };
     
-    gameState.player.position.y += gameState.player.velocity.y * scaledDeltaTime;
+    SimulationSystem::updatePhysics(gameState, platformSystem, stageManager.getCurrentStage(), deltaTime, scaledDeltaTime, events);
+}
 
-    glm::vec3 playerSize = GameConstants::PLAYER_SIZE;
-    
-    SwitchSystem::checkSwitchCollision(gameState, gameState.player.position, playerSize);
-    CannonSystem::checkCannonCollision(gameState, gameState.player.position, playerSize);
-    
-    auto collisionResult = platformSystem.checkCollisionWithIndex(gameState.player.position, playerSize);
-    PlatformVariant* currentPlatform = collisionResult.first;
-    int currentPlatformIndex = collisionResult.second;
-    
-    static bool wasOnPlatform = false;
-    bool isOnPlatform = (currentPlatform != nullptr);
-    
-    if (currentPlatform != nullptr) {
-        if (gameState.progress.isEasyMode) {
-            std::visit([&](const auto& platform) {
-                gameState.player.lastPlatformPosition = platform.position;
-                gameState.player.lastPlatformIndex = currentPlatformIndex;
-                gameState.player.isTrackingPlatform = true;
-                
-                std::string platformType = "Unknown";
-                if constexpr (std::is_same_v<decltype(platform), const StaticPlatform&>) {
-                    platformType = "Static";
-                } else if constexpr (std::is_same_v<decltype(platform), const MovingPlatform&>) {
-                    platformType = "Moving";
-                } else if constexpr (std::is_same_v<decltype(platform), const RotatingPlatform&>) {
-                    platformType = "Rotating";
-                } else if constexpr (std::is_same_v<decltype(platform), const PatrollingPlatform&>) {
-                    platformType = "Patrolling";
-                } else if constexpr (std::is_same_v<decltype(platform), const TeleportPlatform&>) {
-                    platformType = "Teleport";
-                } else if constexpr (std::is_same_v<decltype(platform), const JumpPad&>) {
-                    platformType = "JumpPad";
-                } else if constexpr (std::is_same_v<decltype(platform), const CycleDisappearingPlatform&>) {
-                    platformType = "CycleDisappearing";
-                }
-            }, *currentPlatform);
-        }
+void GameUpdater::handleGoalReached(
+    GameState& gameState, 
+    StageManager& stageManager, 
+    io::AudioManager& audioManager
+) {
+    if (gameState.audioEnabled) {
+        audioManager.stopBGM();
+        gameState.bgmPlaying = false;
+        gameState.currentBGM = "";
         
-        std::visit(overloaded{
-            [&](const StaticPlatform& platform) {
-                if (!PhysicsSystem::checkPlatformCollisionHorizontal(gameState, gameState.player.position, playerSize)) {
-                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                }
-                if (platform.color.r > 0.9f && platform.color.g > 0.9f && platform.color.b < 0.1f) {
-                    if (!gameState.progress.gameWon && gameState.items.collectedItems >= gameState.items.requiredItems) {
-                        if (gameState.audioEnabled) {
-                            audioManager.stopBGM();
-                            gameState.bgmPlaying = false;
-                            gameState.currentBGM = "";
-                            
-                            audioManager.playSFX("clear");
-                        }
-                        
-                        gameState.progress.gameWon = true;
-                        gameState.progress.isStageCompleted = true;
-                        gameState.progress.isGoalReached = true;
-                        
-                        // リプレイモードでない場合、かつリプレイのクリアタイムが設定されていない場合のみclearTimeを更新
-                        if (!gameState.replay.isReplayMode && 
-                            (gameState.replay.currentReplay.frames.empty() || gameState.replay.currentReplay.clearTime <= 0.0f)) {
-                            gameState.progress.clearTime = gameState.progress.gameTime;
-                        }
-                        
-                        int currentStage = stageManager.getCurrentStage();
-                        
-                        if (gameState.progress.isTimeAttackMode) {
-                            float clearTime = gameState.progress.currentTimeAttackTime;
-                            
-                            if (gameState.replay.isRecordingReplay) {
-                                ReplayFrame lastFrame;
-                                lastFrame.timestamp = clearTime;
-                                lastFrame.playerPosition = gameState.player.position;
-                                lastFrame.playerVelocity = gameState.player.velocity;
-                                lastFrame.timeScale = gameState.progress.timeScale;
-                                gameState.replay.replayBuffer.push_back(lastFrame);
-                                
-                                gameState.replay.isRecordingReplay = false;
-                                printf("REPLAY: Recording stopped (%zu frames)\n", gameState.replay.replayBuffer.size());
-                            }
-                            
-                            gameState.progress.isNewRecord = false;
-                            bool shouldSaveReplay = false;
-                            if (gameState.progress.timeAttackRecords.find(currentStage) == gameState.progress.timeAttackRecords.end() ||
-                                clearTime < gameState.progress.timeAttackRecords[currentStage]) {
-                                gameState.progress.timeAttackRecords[currentStage] = clearTime;
-                                gameState.progress.isNewRecord = true;
-                                shouldSaveReplay = true;
-                                printf("TIME ATTACK: New record for stage %d: %.2fs\n", currentStage, clearTime);
-                                
-                            } else {
-                                printf("TIME ATTACK: Stage %d cleared in %.2fs (Best: %.2fs)\n", 
-                                       currentStage, clearTime, gameState.progress.timeAttackRecords[currentStage]);
-                            }
-                            
-                            // 新記録の場合はローカルにリプレイを保存
-                            if (shouldSaveReplay && !gameState.replay.replayBuffer.empty()) {
-                                ReplayData replayData;
-                                replayData.stageNumber = currentStage;
-                                replayData.clearTime = clearTime;
-                                replayData.frames = gameState.replay.replayBuffer;
-                                replayData.frameRate = gameState.replay.REPLAY_RECORD_INTERVAL;
-                                
-                                auto now = std::time(nullptr);
-                                std::stringstream ss;
-                                ss << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
-                                replayData.recordedDate = ss.str();
-                                
-                                ReplayManager::saveReplay(replayData, currentStage);
-                            }
-                            
-                            // オンラインランキングには常にリプレイを送信（リプレイバッファがある場合）
-                            if (!gameState.replay.replayBuffer.empty()) {
-                                // 別スレッドで使用するため、動的に確保
-                                ReplayData* replayData = new ReplayData();
-                                replayData->stageNumber = currentStage;
-                                replayData->clearTime = clearTime;
-                                replayData->frames = gameState.replay.replayBuffer;  // コピーを作成
-                                replayData->frameRate = gameState.replay.REPLAY_RECORD_INTERVAL;
-                                
-                                auto now = std::time(nullptr);
-                                std::stringstream ss;
-                                ss << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
-                                replayData->recordedDate = ss.str();
-                                
-                                // オンラインランキングにリプレイも送信
-                                printf("ONLINE: Preparing to submit record with replay - stage: %d, time: %.2fs, frames: %zu\n",
-                                       currentStage, clearTime, replayData->frames.size());
-                                if (replayData->frames.empty()) {
-                                    printf("ONLINE: ERROR - Replay data frames are empty! replayBuffer size: %zu\n", 
-                                           gameState.replay.replayBuffer.size());
-                                    delete replayData;  // エラー時は削除
-                                } else {
-                                    printf("ONLINE: First frame timestamp: %.2f, last frame timestamp: %.2f\n",
-                                           replayData->frames[0].timestamp,
-                                           replayData->frames.back().timestamp);
-                                    OnlineLeaderboardManager::submitTime(currentStage, clearTime, 
-                                        [currentStage, clearTime, replayData](bool success) {
-                                            if (success) {
-                                                printf("ONLINE: Record with replay submitted successfully for stage %d: %.2fs\n", currentStage, clearTime);
-                                            } else {
-                                                printf("ONLINE: Failed to submit record with replay for stage %d\n", currentStage);
-                                            }
-                                            delete replayData;  // コールバック後に削除
-                                        }, replayData);
-                                }
-                            } else {
-                                // リプレイがない場合のみ通常の送信
-                                printf("ONLINE: No replay buffer - replayBuffer.empty(): %s\n",
-                                       gameState.replay.replayBuffer.empty() ? "true" : "false");
-                                OnlineLeaderboardManager::submitTime(currentStage, clearTime, [currentStage, clearTime](bool success) {
-                                    if (success) {
-                                        printf("ONLINE: Record submitted successfully for stage %d: %.2fs\n", currentStage, clearTime);
-                                    } else {
-                                        printf("ONLINE: Failed to submit record for stage %d\n", currentStage);
-                                    }
-                                });
-                            }
-                            
-                            gameState.progress.earnedStars = gameState.progress.isNewRecord ? 3 : 0;
-                        } else {
-                            float remainingTime = gameState.progress.timeLimit - gameState.progress.clearTime;
-                            float limitTime = gameState.progress.timeLimit;
-                            
-                            if(limitTime >= GameConstants::LONG_TIME_THRESHOLD){
-                                if (remainingTime >= GameConstants::STAR_3_TIME_LONG) {
-                                    gameState.progress.earnedStars = 3;
-                                } else if (remainingTime >= GameConstants::STAR_2_TIME_LONG) {
-                                    gameState.progress.earnedStars = 2;
-                                } else {
-                                    gameState.progress.earnedStars = 1;
-                                }
-                            }else{
-                                if (remainingTime >= GameConstants::STAR_3_TIME_SHORT) {
-                                    gameState.progress.earnedStars = 3;
-                                } else if (remainingTime >= GameConstants::STAR_2_TIME_SHORT) {
-                                    gameState.progress.earnedStars = 2;
-                                } else {
-                                    gameState.progress.earnedStars = 1;
-                                }
-                            }
-                            
-                            int oldStars = (gameState.progress.stageStars.count(currentStage) > 0) ? gameState.progress.stageStars[currentStage] : 0;
-                            int starDifference = gameState.progress.earnedStars - oldStars;
-                            
-                            if (starDifference > 0) {
-                                gameState.progress.stageStars[currentStage] = gameState.progress.earnedStars;
-                                gameState.progress.totalStars += starDifference;
-                                SaveManager::saveGameData(gameState);  // チュートリアルクリア時も確実に保存
-                            }
-                        }
-                        
-                        if (gameState.progress.selectedSecretStarType != GameProgressState::SecretStarType::NONE && currentStage > 0) {
-                            gameState.progress.secretStarCleared[currentStage].insert(gameState.progress.selectedSecretStarType);
-                            SaveManager::saveGameData(gameState);
-                        }
-                        
-                        if (currentStage == 5) {
-                            gameState.ui.isEndingSequence = true;
-                            gameState.ui.showStaffRoll = true;
-                            gameState.ui.staffRollTimer = 0.0f;
-                        } else {
-                            gameState.ui.showStageClearUI = true;
-                        }
-                    }
-                }
-            },
-            [&](const MovingPlatform& platform) {
-                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                const_cast<MovingPlatform&>(platform).hasPlayerOnBoard = true;
-                glm::vec3 platformMovement = platform.position - platform.previousPosition;
-                gameState.player.position.x += platformMovement.x;
-                gameState.player.position.z += platformMovement.z;
-            },
-            [&](const RotatingPlatform& platform) {
-                glm::vec3 halfSize = platform.size * 0.5f;
-                glm::vec3 platformMin = platform.position - halfSize;
-                glm::vec3 platformMax = platform.position + halfSize;
-                bool onPlatform = (gameState.player.position.x >= platformMin.x && gameState.player.position.x <= platformMax.x &&
-                                   gameState.player.position.z >= platformMin.z && gameState.player.position.z <= platformMax.z);
-                if (onPlatform) {
-                    glm::vec3 localPlayerPos = gameState.player.position - platform.position;
-                    if (glm::length(platform.rotationAxis - glm::vec3(0, 1, 0)) < 0.1f) {
-                        float angle = glm::radians(platform.rotationSpeed * gameState.progress.gameTime);
-                        float cosAngle = cos(angle);
-                        float sinAngle = sin(angle);
-                        float newX = localPlayerPos.x * cosAngle - localPlayerPos.z * sinAngle;
-                        float newZ = localPlayerPos.x * sinAngle + localPlayerPos.z * cosAngle;
-                        gameState.player.position = platform.position + glm::vec3(newX, localPlayerPos.y, newZ);
-                    } else if (glm::length(platform.rotationAxis - glm::vec3(1, 0, 0)) < 0.1f) {
-                        float angle = glm::radians(platform.rotationSpeed * gameState.progress.gameTime);
-                        float cosAngle = cos(angle);
-                        float sinAngle = sin(angle);
-                        float newY = localPlayerPos.y * cosAngle - localPlayerPos.z * sinAngle;
-                        float newZ = localPlayerPos.y * sinAngle + localPlayerPos.z * cosAngle;
-                        gameState.player.position = platform.position + glm::vec3(localPlayerPos.x, newY, newZ);
-                    }
-                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                } else {
-                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                }
-            },
-            [&](const PatrollingPlatform& platform) {
-                glm::vec3 halfSize = platform.size * 0.5f;
-                glm::vec3 platformMin = platform.position - halfSize;
-                glm::vec3 platformMax = platform.position + halfSize;
-                glm::vec3 extendedHalfSize = halfSize * 1.5f;
-                glm::vec3 extendedMin = platform.position - extendedHalfSize;
-                glm::vec3 extendedMax = platform.position + extendedHalfSize;
-                bool onPlatform = (gameState.player.position.x >= platformMin.x && gameState.player.position.x <= platformMax.x &&
-                                  gameState.player.position.z >= platformMin.z && gameState.player.position.z <= platformMax.z);
-                bool inExtendedRange = (gameState.player.position.x >= extendedMin.x && gameState.player.position.x <= extendedMax.x &&
-                                       gameState.player.position.z >= extendedMin.z && gameState.player.position.z <= extendedMax.z);
-                if (onPlatform || inExtendedRange) {
-                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                    glm::vec3 platformMovement = platform.position - platform.previousPosition;
-                    gameState.player.position.x += platformMovement.x;
-                    gameState.player.position.z += platformMovement.z;
-                    if (!onPlatform && inExtendedRange) {
-                        glm::vec3 directionToCenter = platform.position - gameState.player.position;
-                        directionToCenter.y = 0;
-                        float distanceToCenter = glm::length(directionToCenter);
-                        if (distanceToCenter > 0.1f) {
-                            glm::vec3 normalizedDirection = glm::normalize(directionToCenter);
-                            gameState.player.position += normalizedDirection * 0.5f * deltaTime;
-                        }
-                    }
-                } else {
-                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                }
-            },
-            [&](const TeleportPlatform& platform) {
-                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                if (!platform.hasTeleported && platform.cooldownTimer <= 0.0f) {
-                    gameState.player.position = platform.teleportDestination;
-                    const_cast<TeleportPlatform&>(platform).hasTeleported = true;
-                    const_cast<TeleportPlatform&>(platform).cooldownTimer = 2.0f;
-                }
-            },
-            [&](const JumpPad& platform) {
-                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                gameState.player.velocity.y = platform.jumpPower;
-            },
-            [&](const CycleDisappearingPlatform& platform) {
-                if (platform.isCurrentlyVisible) {
-                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-                }
-            },
-            [&](const DisappearingPlatform& platform) {
-                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-            },
-            [&](const FlyingPlatform& platform) {
-                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
-            }
-        }, *currentPlatform);
-    } else {
-        platformSystem.resetMovingPlatformFlags();
-    }
-    
-    if (isOnPlatform && !wasOnPlatform && gameState.audioEnabled) {
-        audioManager.playSFX("on_ground");
+        audioManager.playSFX("clear");
     }
     
-    // 地面に着地した時、バーストジャンプの空中効果をリセット
-    if (isOnPlatform && gameState.skills.isInBurstJumpAir) {
-        gameState.skills.isInBurstJumpAir = false;
-    }
-    
-    wasOnPlatform = isOnPlatform;
+    int currentStage = stageManager.getCurrentStage();
     
-    if (gameState.player.position.y < 0 && !gameState.progress.isGameOver) {
-        if (gameState.audioEnabled) {
-            audioManager.playSFX("on_ground");  // damageSEとしてon_groundを使用
-        }
+    if (gameState.progress.isTimeAttackMode) {
+        float clearTime = gameState.progress.currentTimeAttackTime;
         
-        if (gameState.progress.isEasyMode) {
-            if (gameState.player.isTrackingPlatform && gameState.player.lastPlatformIndex >= 0) {
-                const auto& platforms = platformSystem.getPlatforms();
-                if (gameState.player.lastPlatformIndex < platforms.size()) {
-                    std::visit([&](const auto& platform) {
-                        glm::vec3 currentPlatformPos = platform.position;
-                        gameState.player.position = currentPlatformPos + glm::vec3(0, 2.0f, 0);
-                    }, platforms[gameState.player.lastPlatformIndex]);
-                } else {
-                    gameState.player.position = gameState.player.lastPlatformPosition + glm::vec3(0, 2.0f, 0);
-                }
+        if (gameState.replay.isRecordingReplay) {
+            ReplayRecorder::finish(gameState.replay, ReplayRecorder::captureFrame(gameState, clearTime));
+            ReplayStreamWriter::pushRecorded(gameState.replay);
+            printf("REPLAY: Recording stopped (%zu frames)\n", gameState.replay.replayBuffer.size());
+            if (gameState.replay.isRecordingInputs) {
+                gameState.replay.isRecordingInputs = false;
+                gameState.replay.inputRecording.clearTime = clearTime;
+                printf("REPLAY: Recorded %zu input ticks @ %dHz\n",
+                       gameState.replay.inputRecording.inputs.size(), gameState.replay.inputRecording.tickRate);
             } else {
-                gameState.player.position = gameState.player.lastPlatformPosition + glm::vec3(0, 2.0f, 0);
+                gameState.replay.inputRecording.inputs.clear();
             }
-            gameState.player.velocity = glm::vec3(0, 0, 0);
-        } else if (stageManager.getCurrentStage() == 0) {
-            gameState.player.position = glm::vec3(8, 2.0f, 0);
-            gameState.player.velocity = glm::vec3(0, 0, 0);
-        } else if (stageManager.getCurrentStage() == 6) {
-            gameState.player.position = gameState.progress.tutorialStartPosition;
-            gameState.player.velocity = glm::vec3(0, 0, 0);
-            printf("TUTORIAL: Respawned at start position (%.1f, %.1f, %.1f)\n", 
-                   gameState.progress.tutorialStartPosition.x, gameState.progress.tutorialStartPosition.y, gameState.progress.tutorialStartPosition.z);
+        }
+        
+        gameState.progress.isNewRecord = false;
+        bool shouldSaveReplay = false;
+        if (gameState.progress.timeAttackRecords.find(currentStage) == gameState.progress.timeAttackRecords.end() ||
+            clearTime < gameState.progress.timeAttackRecords[currentStage]) {
+            gameState.progress.timeAttackRecords[currentStage] = clearTime;
+            gameState.progress.isNewRecord = true;
+            shouldSaveReplay = true;
+            printf("TIME ATTACK: New record for stage %d: %.2fs\n", currentStage, clearTime);
+            
         } else {
-            gameState.progress.lives--;
+            printf("TIME ATTACK: Stage %d cleared in %.2fs (Best: %.2fs)\n", 
+                   currentStage, clearTime, gameState.progress.timeAttackRecords[currentStage]);
+        }
+        
+        // 新記録の場合はローカルにリプレイを保存（書き込みスレッドで書き出し済みのファイルを確定する）
+        // 新記録でない場合は書き出し途中のファイルを破棄する。どちらの場合もリプレイライブラリには追加する
+        if (!gameState.replay.replayBuffer.empty()) {
+            ReplayData replayData;
+            replayData.stageNumber = currentStage;
+            replayData.clearTime = clearTime;
+            replayData.frames = gameState.replay.replayBuffer;
+            replayData.frameRate = gameState.replay.maxRecordInterval;
+            replayData.inputs = gameState.replay.inputRecording;
             
-            if (gameState.audioEnabled) {
-                audioManager.playSFX("damage");
-            }
+            auto now = std::time(nullptr);
+            std::stringstream ss;
+            ss << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
+            replayData.recordedDate = ss.str();
             
-            if (gameState.progress.lives <= 0) {
-                gameState.progress.isGameOver = true;
-                gameState.progress.gameOverTimer = 0.0f;
-                if (gameState.player.lastCheckpointItemId != -1) {
-                    gameState.player.position = gameState.player.lastCheckpoint;
-                } else {
-                    gameState.player.position = glm::vec3(0, 6.0f, -25.0f);
-                }
-                gameState.player.velocity = glm::vec3(0, 0, 0);
+            ReplayStreamWriter::finish(std::move(replayData), shouldSaveReplay, OnlineLeaderboardManager::getPlayerName());
+        } else {
+            ReplayStreamWriter::finish(ReplayData(), false);
+        }
+        
+        // オンラインランキングには常にリプレイを送信（リプレイバッファがある場合）
+        // 記録は送信キューに渡すだけで、エンコード・保存・送信（再送を含む）は別スレッドで行う
+        ReplayData onlineReplayData;
+        if (!gameState.replay.replayBuffer.empty()) {
+            onlineReplayData.stageNumber = currentStage;
+            onlineReplayData.clearTime = clearTime;
+            onlineReplayData.frames = gameState.replay.replayBuffer;  // コピーを作成
+            onlineReplayData.frameRate = gameState.replay.maxRecordInterval;
+            onlineReplayData.inputs = gameState.replay.inputRecording;
+            
+            auto now = std::time(nullptr);
+            std::stringstream ss;
+            ss << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
+            onlineReplayData.recordedDate = ss.str();
+            
+            printf("ONLINE: Preparing to submit record with replay - stage: %d, time: %.2fs, frames: %zu\n",
+                   currentStage, clearTime, onlineReplayData.frames.size());
+        } else {
+            printf("ONLINE: No replay buffer - submitting record without replay\n");
+        }
+        OnlineLeaderboardManager::submitTime(currentStage, clearTime, [currentStage, clearTime](bool success) {
+            if (success) {
+                printf("ONLINE: Record submitted successfully for stage %d: %.2fs\n", currentStage, clearTime);
             } else {
-                if (gameState.player.lastCheckpointItemId != -1) {
-                    gameState.player.position = gameState.player.lastCheckpoint;
-                } else {
-                    gameState.player.position = glm::vec3(0, 6.0f, -25.0f);
-                }
-                gameState.player.velocity = glm::vec3(0, 0, 0);
+                printf("ONLINE: Record for stage %d was not submitted: %.2fs\n", currentStage, clearTime);
+            }
+        }, std::move(onlineReplayData));
+        
+        gameState.progress.earnedStars = gameState.progress.isNewRecord ? 3 : 0;
+    } else {
+        float remainingTime = gameState.progress.timeLimit - gameState.progress.clearTime;
+        float limitTime = gameState.progress.timeLimit;
+        
+        if(limitTime >= GameConstants::LONG_TIME_THRESHOLD){
+            if (remainingTime >= GameConstants::STAR_3_TIME_LONG) {
+                gameState.progress.earnedStars = 3;
+            } else if (remainingTime >= GameConstants::STAR_2_TIME_LONG) {
+                gameState.progress.earnedStars = 2;
+            } else {
+                gameState.progress.earnedStars = 1;
             }
+        }else{
+            if (remainingTime >= GameConstants::STAR_3_TIME_SHORT) {
+                gameState.progress.earnedStars = 3;
+            } else if (remainingTime >= GameConstants::STAR_2_TIME_SHORT) {
+                gameState.progress.earnedStars = 2;
+            } else {
+                gameState.progress.earnedStars = 1;
+            }
+        }
+        
+        int oldStars = (gameState.progress.stageStars.count(currentStage) > 0) ? gameState.progress.stageStars[currentStage] : 0;
+        int starDifference = gameState.progress.earnedStars - oldStars;
+        
+        if (starDifference > 0) {
+            gameState.progress.stageStars[currentStage] = gameState.progress.earnedStars;
+            gameState.progress.totalStars += starDifference;
+            SaveManager::saveGameData(gameState);  // チュートリアルクリア時も確実に保存
         }
     }
+    
+    if (gameState.progress.selectedSecretStarType != GameProgressState::SecretStarType::NONE && currentStage > 0) {
+        gameState.progress.secretStarCleared[currentStage].insert(gameState.progress.selectedSecretStarType);
+        SaveManager::saveGameData(gameState);
+    }
+    
+    if (currentStage == 5) {
+        gameState.ui.isEndingSequence = true;
+        gameState.ui.showStaffRoll = true;
+        gameState.ui.staffRollTimer = 0.0f;
+    } else {
+        gameState.ui.showStageClearUI = true;
+    }
 }
 
 void GameUpdater::updateItems(
@@ -991,34 +790,14 @@ void GameUpdater::updateItems(
     float scaledDeltaTime, 
     io::AudioManager& audioManager
 ) {
-    for (auto& item : gameState.items.items) {
-        if (!item.isCollected) {
-            item.rotationAngle += scaledDeltaTime * 90.0f;
-            if (item.rotationAngle >= 360.0f) {
-                item.rotationAngle -= 360.0f;
-            }
-            
-            item.bobTimer += scaledDeltaTime;
-            item.bobHeight = sin(item.bobTimer * 2.0f) * 0.2f;
-            
-            float distance = glm::length(gameState.player.position - item.position);
-            if (distance < 1.5f) { // 収集範囲
-                if (gameState.audioEnabled) {
-                    audioManager.playSFX("item");
-                }
-                
-                item.isCollected = true;
-                gameState.items.collectedItems++;
-                
-                if (gameState.progress.isTutorialStage) {
-                    gameState.items.earnedItems++;
-                }
-                
-                gameState.player.lastCheckpoint = item.position;
-                gameState.player.lastCheckpointItemId = item.itemId;
-            }
+    SimulationEvents events;
+    events.onPlaySFX = [&](const std::string& sfxName) {
+        if (gameState.audioEnabled) {
+            audioManager.playSFX(sfxName);
         }
-    }
+    };
+    
+    SimulationSystem::updateItems(gameState, scaledDeltaTime, events);
 }
 
 } // namespace GameLoop
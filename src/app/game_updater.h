@@ -61,6 +61,7 @@ public:
      * @brief 物理演算と衝突判定を更新する
      * @details 重力、速度、位置、プラットフォーム衝突、落下判定などを処理します。
      * ゲームオーバー時は物理演算をスキップします。
+     * 処理本体はSimulationSystem::updatePhysicsで、ここでは効果音とクリア処理を接続します。
      * 
      * @param window GLFWウィンドウ
      * @param gameState ゲーム状態
@@ -93,6 +94,22 @@ public:
         float scaledDeltaTime, 
         io::AudioManager& audioManager
     );
+
+private:
+    /**
+     * @brief ゴール到達時のクリア処理
+     * @details BGM停止、タイムアタック記録とリプレイの保存・送信、星の計算、クリアUIの表示を行います。
+     * SimulationSystemのゴール到達イベントから呼び出されます。
+     * 
+     * @param gameState ゲーム状態
+     * @param stageManager ステージマネージャー
+     * @param audioManager オーディオマネージャー
+     */
+    static void handleGoalReached(
+        GameState& gameState, 
+        StageManager& stageManager, 
+        io::AudioManager& audioManager
+    );
 };
 
 } // namespace GameLoop
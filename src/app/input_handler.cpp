@@ -6,6 +6,8 @@
 #include "../core/constants/game_constants.h"
 #include "../io/input_system.h"
 #include "../game/replay_manager.h"
+#include "../game/replay_playback.h"
+#include "../game/replay_download.h"
 #include "../game/save_manager.h"
 #include "tutorial_manager.h"
 #include <GLFW/glfw3.h>
@@ -135,6 +137,12 @@ void InputHandler::handleInputProcessing(GLFWwindow* window, GameState& gameStat
                 gameState.replay.isReplayMode = false;
                 gameState.replay.isReplayPaused = false;
                 gameState.replay.replayPlaybackTime = 0.0f;
+                if (gameState.replay.replayDownload) {
+                    gameState.replay.replayDownload->cancel();
+                    gameState.replay.replayDownload.reset();
+                }
+                gameState.replay.isReplayStreaming = false;
+                gameState.replay.isReplayBuffering = false;
                 printf("REPLAY: Stopped\n");
             }
             return;  // リプレイモード中は他の入力処理をスキップ
@@ -211,6 +219,11 @@ void InputHandler::handleInputProcessing(GLFWwindow* window, GameState& gameStat
                 if (gameState.ui.showLeaderboardUI) {
                     gameState.ui.showLeaderboardUI = false;
                     gameState.ui.leaderboardEntries.clear();
+                    if (gameState.replay.replayDownload && !gameState.replay.isReplayStreaming) {
+                        gameState.replay.replayDownload->cancel();
+                        gameState.replay.replayDownload.reset();
+                        gameState.ui.isLoadingReplay = false;
+                    }
                     continue;
                 }
                 
@@ -573,6 +586,7 @@ void InputHandler::handleInputProcessing(GLFWwindow* window, GameState& gameStat
                         gameState.replay.isReplayMode = true;
                         gameState.replay.isReplayPaused = false;
                         gameState.replay.replayPlaybackTime = 0.0f;
+                        ReplayPlayback::prepare(gameState.replay);
                         gameState.replay.previousReplayPlaybackTime = 0.0f;  // 前フレームの時間を初期化
                         gameState.replay.replayPlaybackSpeed = 1.0f;  // 初期速度は1.0x
                         // isOnlineReplayフラグは維持
@@ -603,6 +617,7 @@ void InputHandler::handleInputProcessing(GLFWwindow* window, GameState& gameStat
                             gameState.replay.isReplayMode = true;
                             gameState.replay.isReplayPaused = false;
                             gameState.replay.replayPlaybackTime = 0.0f;
+                            ReplayPlayback::prepare(gameState.replay);
                             gameState.replay.previousReplayPlaybackTime = 0.0f;  // 前フレームの時間を初期化
                             gameState.replay.replayPlaybackSpeed = 1.0f;  // 初期速度は1.0x
                             gameState.replay.isOnlineReplay = false;  // ローカルリプレイの場合はフラグをリセット
@@ -751,7 +766,7 @@ void InputHandler::handleInputProcessing(GLFWwindow* window, GameState& gameStat
         
         if (tutorialInputEnabled && !isUIBlockingMovement) {
             glm::vec3 gravityDirection = glm::vec3(0, -1, 0);
-            InputSystem::processInput(window, gameState, scaledDeltaTime);
+            InputSystem::processInput(window, gameState, platformSystem, scaledDeltaTime);
             InputSystem::processJumpAndFloat(window, gameState, scaledDeltaTime, gravityDirection, platformSystem, audioManager);
         }
         
@@ -13,6 +13,8 @@
 #include <thread>
 #include <memory>
 #include <map>
+#include <cstring>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include "../gfx/opengl_renderer.h"
 #include "../game/game_state.h"
@@ -28,6 +30,8 @@
 #include "../core/utils/input_utils.h"
 #include "../core/utils/ui_config_manager.h"
 #include "../game/online_leaderboard_manager.h"
+#include "../game/replay_stream_writer.h"
+#include "../game/replay_library.h"
 #include "game_loop.h"
 #include "tutorial_manager.h"
 #include "../core/constants/debug_config.h"
@@ -102,36 +106,50 @@ int main(int argc, char* const argv[]) {
     int initialStage = 6;  // デフォルトはチュートリアルステージ
     bool debugEnding = false;  // デバッグ用エンドロール表示フラグ
     
-    if (argc > 1) {
-        if (strcmp(argv[1], "-e") == 0 || strcmp(argv[1], "--ending") == 0) {
+    GameLoop::LoopSettings loopSettings;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--ending") == 0) {
             debugEnding = true;
-        } else if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             printf("Usage: %s [stage_number] [options]\n", argv[0]);
             printf("  stage_number: 0-5 (default: 6 for tutorial)\n");
             printf("  options:\n");
             printf("    -e, --ending: Show ending sequence (debug mode)\n");
+            printf("    --tick-rate <hz>: Simulation tick rate (default: %d)\n", GameConstants::SIMULATION_TICK_RATE);
+            printf("    --fps-limit <fps>: Render frame rate limit, 0 = vsync only (default: %d)\n", GameConstants::RENDER_FPS_LIMIT);
+            printf("    --variable-timestep: Step the simulation once per rendered frame\n");
             printf("    -h, --help: Show this help message\n");
             printf("Examples:\n");
             printf("  %s          # Start tutorial stage\n", argv[0]);
             printf("  %s 5        # Start stage 5\n", argv[0]);
             printf("  %s -e       # Show ending sequence\n", argv[0]);
             printf("  %s 5 -e     # Start stage 5 and show ending\n", argv[0]);
+            printf("  %s --tick-rate 240 --fps-limit 60\n", argv[0]);
             return 0;
+        } else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            int tickRate = std::atoi(argv[++i]);
+            if (tickRate > 0) {
+                loopSettings.simulationTickRate = tickRate;
+            } else {
+                printf("Invalid tick rate: %d. Using default %d Hz\n", tickRate, loopSettings.simulationTickRate);
+            }
+        } else if (strcmp(argv[i], "--fps-limit") == 0 && i + 1 < argc) {
+            loopSettings.renderFpsLimit = std::max(std::atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--variable-timestep") == 0) {
+            loopSettings.useFixedTimestep = false;
         } else {
-            int requestedStage = std::atoi(argv[1]);
+            int requestedStage = std::atoi(argv[i]);
             if (requestedStage >= 0 && requestedStage <= 5) {  // ステージ0-5を許可
                 initialStage = requestedStage;
             } else {
                 printf("Invalid stage number: %d. Using default stage %d\n", requestedStage, initialStage);
             }
         }
-        
-        if (argc > 2) {
-            if (strcmp(argv[2], "-e") == 0 || strcmp(argv[2], "--ending") == 0) {
-                debugEnding = true;
-            }
-        }
     }
+    
+    // 描画は垂直同期に合わせ、フレーム間の待機はゲームループ側のフレームレート上限で行う
+    glfwSwapInterval(1);
     glfwSetWindowUserPointer(window, &gameState);
     
     glfwSetCursorPosCallback(window, InputSystem::mouse_callback);
@@ -149,6 +167,7 @@ int main(int argc, char* const argv[]) {
     
     // ランキング設定ファイルを読み込む
     OnlineLeaderboardManager::loadConfigFromFile();
+    OnlineLeaderboardManager::resumeSubmissions();
     
     if (debugEnding) {
         gameState.ui.isEndingSequence = true;
@@ -172,11 +191,17 @@ int main(int argc, char* const argv[]) {
     
     auto resetStageStartTime = [&startTime, &gameState]() {
         startTime = std::chrono::high_resolution_clock::now();
+        gameState.progress.simulationTime = 0.0f;
         gameState.progress.timeLimitApplied = false; // カウントダウン時の時間設定フラグをリセット
         DEBUG_PRINTF("DEBUG: timeLimitApplied reset to false\n");
     };
     
-    GameLoop::run(window, gameState, stageManager, platformSystem, renderer, uiRenderer, gameStateUIRenderer, keyStates, resetStageStartTime, startTime, audioManager);
+    GameLoop::run(window, gameState, stageManager, platformSystem, renderer, uiRenderer, gameStateUIRenderer, keyStates, resetStageStartTime, startTime, audioManager, loopSettings);
+    
+    // 保存中のリプレイを書き終えてから終了する
+    OnlineLeaderboardManager::shutdown();
+    ReplayStreamWriter::shutdown();
+    ReplayLibrary::flush();
     
     renderer->cleanup();
     glfwDestroyWindow(window);
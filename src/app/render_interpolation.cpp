@@ -0,0 +1,100 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "render_interpolation.h"
+#include <cmath>
+#include <utility>
+#include "../core/constants/rendering_constants.h"
+
+namespace GameLoop {
+
+void RenderInterpolator::capture(const GameState& gameState, const PlatformSystem& platformSystem) {
+    // 配列の確保済み領域を再利用するため、コピーではなく入れ替えで前ステップに移す
+    std::swap(previous, current);
+
+    const auto& platforms = platformSystem.getPlatforms();
+    current.playerPosition = gameState.player.position;
+    current.timeAttackTime = gameState.progress.currentTimeAttackTime;
+    current.platformPositions.clear();
+    current.platformRotationAngles.clear();
+    for (const auto& platform : platforms) {
+        std::visit([this](const auto& p) {
+            current.platformPositions.push_back(p.position);
+            if constexpr (std::is_same_v<std::decay_t<decltype(p)>, RotatingPlatform>) {
+                current.platformRotationAngles.push_back(p.rotationAngle);
+            } else {
+                current.platformRotationAngles.push_back(0.0f);
+            }
+        }, platform);
+    }
+
+    current.itemBobHeights.clear();
+    current.itemRotationAngles.clear();
+    for (const auto& item : gameState.items.items) {
+        current.itemBobHeights.push_back(item.bobHeight);
+        current.itemRotationAngles.push_back(item.rotationAngle);
+    }
+
+    if (!hasSnapshot) {
+        previous = current;
+        hasSnapshot = true;
+    }
+}
+
+void RenderInterpolator::reset() {
+    hasSnapshot = false;
+}
+
+const RenderSnapshot* RenderInterpolator::interpolate(float alpha, const GameState& gameState, const PlatformSystem& platformSystem) {
+    if (!hasSnapshot ||
+        current.platformPositions.size() != platformSystem.getPlatforms().size() ||
+        current.itemBobHeights.size() != gameState.items.items.size()) {
+        return nullptr;
+    }
+
+    blended.playerPosition = lerpPosition(previous.playerPosition, current.playerPosition, alpha);
+    // リトライで時間が巻き戻った場合は補間しない
+    blended.timeAttackTime = current.timeAttackTime < previous.timeAttackTime ? current.timeAttackTime :
+        previous.timeAttackTime + (current.timeAttackTime - previous.timeAttackTime) * alpha;
+
+    blended.platformPositions = current.platformPositions;
+    blended.platformRotationAngles = current.platformRotationAngles;
+    if (previous.platformPositions.size() == current.platformPositions.size()) {
+        for (size_t i = 0; i < current.platformPositions.size(); i++) {
+            blended.platformPositions[i] = lerpPosition(previous.platformPositions[i], current.platformPositions[i], alpha);
+            blended.platformRotationAngles[i] = lerpAngle(previous.platformRotationAngles[i], current.platformRotationAngles[i], alpha);
+        }
+    }
+
+    blended.itemBobHeights = current.itemBobHeights;
+    blended.itemRotationAngles = current.itemRotationAngles;
+    if (previous.itemBobHeights.size() == current.itemBobHeights.size()) {
+        for (size_t i = 0; i < current.itemBobHeights.size(); i++) {
+            blended.itemBobHeights[i] = previous.itemBobHeights[i] + (current.itemBobHeights[i] - previous.itemBobHeights[i]) * alpha;
+            blended.itemRotationAngles[i] = lerpAngle(previous.itemRotationAngles[i], current.itemRotationAngles[i], alpha);
+        }
+    }
+
+    return &blended;
+}
+
+glm::vec3 RenderInterpolator::lerpPosition(const glm::vec3& previous, const glm::vec3& current, float alpha) {
+    if (glm::length(current - previous) >= GameConstants::RENDER_INTERPOLATION_SNAP_DISTANCE) {
+        return current;
+    }
+    return glm::mix(previous, current, alpha);
+}
+
+float RenderInterpolator::lerpAngle(float previous, float current, float alpha) {
+    // 360度を跨いだ場合は近い方向に補間する
+    float delta = current - previous;
+    if (delta > 180.0f) {
+        delta -= 360.0f;
+    } else if (delta < -180.0f) {
+        delta += 360.0f;
+    }
+    return previous + delta * alpha;
+}
+
+} // namespace GameLoop
@@ -0,0 +1,82 @@
+/**
+ * @file render_interpolation.h
+ * @brief 描画補間
+ * @details 固定タイムステップのシミュレーション結果を、前ステップと現ステップの間で補間して描画するための
+ * スナップショットを管理します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "../game/game_state.h"
+#include "../game/platform_system.h"
+
+namespace GameLoop {
+
+/**
+ * @brief 描画用スナップショット
+ * @details 1ステップ分の描画に必要な動的な状態のみを保持します。
+ * 配列のインデックスはPlatformSystem::getPlatforms()およびgameState.items.itemsと対応します。
+ */
+struct RenderSnapshot {
+    glm::vec3 playerPosition = glm::vec3(0.0f);
+    float timeAttackTime = 0.0f;                // タイムアタックの経過時間（ゴーストの再生時間）
+    std::vector<glm::vec3> platformPositions;
+    std::vector<float> platformRotationAngles;  // 回転角度（単位: 度、回転プラットフォーム以外は0）
+    std::vector<float> itemBobHeights;
+    std::vector<float> itemRotationAngles;      // 回転角度（単位: 度）
+};
+
+/**
+ * @brief 描画補間
+ * @details 前ステップ（N-1）と現ステップ（N）のスナップショットを二重に保持し、
+ * アキュムレータの進行度で補間したスナップショットを生成します。
+ * シミュレーションのティックレートを下げても描画は滑らかになります。
+ */
+class RenderInterpolator {
+public:
+    /**
+     * @brief シミュレーション1ステップ後の状態を記録する
+     * @details 現ステップのスナップショットを前ステップに移し、新しい状態を現ステップとして記録します。
+     * リセット直後の最初の記録では前ステップも同じ状態にします。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム
+     */
+    void capture(const GameState& gameState, const PlatformSystem& platformSystem);
+
+    /**
+     * @brief 記録したスナップショットを破棄する
+     * @details ステージ遷移や画面遷移などで状態が不連続になる場合に呼び出します。
+     * 次にcaptureされるまでinterpolateはnullptrを返します。
+     */
+    void reset();
+
+    /**
+     * @brief 補間したスナップショットを取得する
+     * @details 要素数が一致しない配列や、1ステップでRENDER_INTERPOLATION_SNAP_DISTANCE以上
+     * 移動した位置は補間せずに現ステップの値を使用します。
+     * 記録後に状態の要素数が変わった場合（ステージの読み込み等）はnullptrを返します。
+     *
+     * @param alpha 補間係数（0.0: 前ステップ、1.0: 現ステップ）
+     * @param gameState ゲーム状態（要素数の検証用）
+     * @param platformSystem プラットフォームシステム（要素数の検証用）
+     * @return 補間したスナップショット（補間できない場合はnullptr）
+     */
+    const RenderSnapshot* interpolate(float alpha, const GameState& gameState, const PlatformSystem& platformSystem);
+
+private:
+    static glm::vec3 lerpPosition(const glm::vec3& previous, const glm::vec3& current, float alpha);
+    static float lerpAngle(float previous, float current, float alpha);
+
+    RenderSnapshot previous;
+    RenderSnapshot current;
+    RenderSnapshot blended;
+    bool hasSnapshot = false;
+};
+
+} // namespace GameLoop
@@ -12,6 +12,7 @@ namespace GameConstants {
     constexpr float BASE_GRAVITY = 12.0f;
     constexpr float AIR_RESISTANCE_NORMAL = 0.98f;
     constexpr float AIR_RESISTANCE_FAST = 0.99f;
+    constexpr float AIR_RESISTANCE_REFERENCE_RATE = 60.0f;  // 空気抵抗係数の基準レート（1/60秒あたりの減衰率）
     
     // プレイヤー設定
     constexpr glm::vec3 PLAYER_SIZE = glm::vec3(1.0f, 1.0f, 1.0f);
@@ -27,6 +28,13 @@ namespace GameConstants {
         // プレイヤー設定
         constexpr float PLAYER_COLLISION_MARGIN = 0.1f;
         constexpr float PLATFORM_SURFACE_TOLERANCE = 0.1f;
+        
+        // ブロードフェーズ（AABBツリー）設定
+        constexpr float BROADPHASE_FAT_MARGIN = 1.0f;  // 動的ツリーの境界ボックスを太らせる量（単位: ワールド座標）
+        constexpr int BROADPHASE_LINEAR_SCAN_MAX_PLATFORMS = 256;  // この数以下ならツリーを使わず全件をSIMDで判定する
+        
+        // 連続衝突判定（掃引AABB）設定
+        constexpr float CONTINUOUS_COLLISION_SKIN = 0.01f;  // すり抜け時に接触位置から足場へ食い込ませる量（単位: ワールド座標）
     }
     
     // 物理計算設定
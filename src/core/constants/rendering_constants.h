@@ -17,6 +17,9 @@ namespace GameConstants {
     constexpr glm::vec3 STAGE_SELECT_CAMERA_OFFSET = glm::vec3(0, 15, -15);
     constexpr glm::vec3 NORMAL_STAGE_CAMERA_OFFSET = glm::vec3(0, 2, -8);
     
+    // 描画補間設定（固定タイムステップ時）
+    constexpr float RENDER_INTERPOLATION_SNAP_DISTANCE = 5.0f;  // 1ステップでこれ以上移動した場合は補間せずに瞬間移動させる（リスポーン、テレポート等）
+    
     // レンダリング設定
     namespace RenderConstants {
         // 背景色
@@ -157,6 +160,7 @@ namespace GameConstants {
         constexpr float LIGHTING_DARKNESS_MULTIPLIER = 0.6f;
         constexpr float LIGHTING_MEDIUM_MULTIPLIER = 0.9f;
         constexpr float EDGE_ALPHA_MULTIPLIER = 0.3f;
+        constexpr float GHOST_ALPHA = 0.35f;  // ゴーストの不透明度
         
         // フォント設定
         constexpr int FONT_WIDTH = 8;
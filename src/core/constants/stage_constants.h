@@ -63,6 +63,10 @@ namespace GameConstants {
         constexpr glm::vec3 ITEM_SIZE = glm::vec3(0.5f, 0.5f, 0.5f);
         constexpr float ITEM_BOB_HEIGHT = 1.0f;
         constexpr float ITEM_ROTATION_SPEED = 2.0f;
+        constexpr float ITEM_COLLECT_RADIUS = 1.5f;  // プレイヤー中心からの収集範囲
+        
+        // トリガー設定
+        constexpr float TRIGGER_UNBOUNDED_HALF_HEIGHT = 1.0e4f;  // 高さを問わない判定範囲のY方向の半サイズ
         
         // プラットフォーム設定
         constexpr glm::vec3 DEFAULT_PLATFORM_SIZE = glm::vec3(3.0f, 1.0f, 3.0f);
@@ -16,5 +16,10 @@ namespace GameConstants {
     // フレームレート設定
     constexpr float MAX_DELTA_TIME = 0.1f;  // 最大100ms（10FPS相当）
     constexpr int TARGET_FPS = 60;
-    constexpr int FRAME_DELAY_MS = 16;  // ~60 FPS
+    constexpr int FRAME_DELAY_MS = 16;  // ~60 FPS（可変タイムステップ時のみ使用）
+    
+    // 固定タイムステップ設定
+    constexpr int SIMULATION_TICK_RATE = 60;           // シミュレーションのティックレート（Hz）
+    constexpr int MAX_SIMULATION_STEPS_PER_FRAME = 8;  // 1フレームあたりの最大ステップ数（処理落ち時の暴走防止）
+    constexpr int RENDER_FPS_LIMIT = 0;                // 描画フレームレート上限（0の場合は垂直同期のみ）
 }
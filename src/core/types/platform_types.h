@@ -12,6 +12,7 @@
 #include <vector>
 #include <variant>
 #include <glm/glm.hpp>
+#include "../../physics/oriented_box.h"
 
 // 基底Platform構造体
 struct BasePlatform {
@@ -51,10 +52,12 @@ struct RotatingPlatform : public BasePlatform {
     glm::vec3 rotationAxis;
     float rotationSpeed;
     float rotationAngle = 0.0f;
+    OrientedBox orientedBox;  // 衝突判定用（rotationAngle・位置・サイズの変更時にPlatformSystemが更新する）
     
     RotatingPlatform(const glm::vec3& pos, const glm::vec3& siz, const glm::vec3& col,
                      const glm::vec3& axis, float speed)
-        : BasePlatform(pos, siz, col), rotationAxis(axis), rotationSpeed(speed) {}
+        : BasePlatform(pos, siz, col), rotationAxis(axis), rotationSpeed(speed),
+          orientedBox(OrientedBox::fromRotation(pos, siz, axis, 0.0f)) {}
 };
 
 // 巡回足場
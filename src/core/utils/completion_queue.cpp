@@ -0,0 +1,77 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "completion_queue.h"
+#include <atomic>
+#include <chrono>
+
+namespace {
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::function<void()> task;
+    };
+
+    /**
+     * @brief キューの状態
+     * @details 生産者はheadに繋ぎ、消費者はtailから取り出します。tailは常に実行済み（または番兵）のノードを指します。
+     */
+    struct QueueState {
+        Node stub;
+        std::atomic<Node*> head{&stub};
+        Node* tail = &stub;  // メインスレッドだけが使う
+
+        ~QueueState() {
+            // 実行されなかった処理を破棄する
+            Node* node = tail;
+            while (node) {
+                Node* next = node->next.load(std::memory_order_acquire);
+                if (node != &stub) {
+                    delete node;
+                }
+                node = next;
+            }
+        }
+    };
+
+    QueueState queue;
+}
+
+void CompletionQueue::post(std::function<void()> task) {
+    Node* node = new Node();
+    node->task = std::move(task);
+    // headを新しいノードに付け替えてから、前のノードから繋ぐ（繋ぐまでの間、消費者からは末尾が見えないだけ）
+    Node* previous = queue.head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+size_t CompletionQueue::drain(float budgetSeconds) {
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::duration<float>(budgetSeconds);
+
+    size_t executed = 0;
+    while (true) {
+        Node* next = queue.tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            break;
+        }
+
+        Node* done = queue.tail;
+        queue.tail = next;
+        if (done != &queue.stub) {
+            delete done;
+        }
+
+        std::function<void()> task = std::move(next->task);
+        next->task = nullptr;
+        if (task) {
+            task();
+        }
+        executed++;
+
+        if (std::chrono::steady_clock::now() - start >= budget) {
+            break;
+        }
+    }
+    return executed;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file completion_queue.h
+ * @brief メインスレッドの完了キュー
+ * @details 他のスレッドで終わった処理の結果を、メインスレッドで反映するためのキューです。
+ */
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief メインスレッドの完了キュー
+ * @details 通信スレッドなどからpost()した処理を、メインループがフレームごとにdrain()して実行します。
+ * 結果をGameStateに書き込む処理は全てメインスレッドで実行されるため、GameStateにロックは要りません。
+ *
+ * キューはロックを使わない複数生産者・単一消費者（MPSC）の連結リストです。
+ * post()はどのスレッドからも呼び出せますが、drain()はメインスレッドだけが呼び出します。
+ */
+class CompletionQueue {
+public:
+    /**
+     * @brief メインスレッドで実行する処理を追加する
+     * @param task 処理
+     */
+    static void post(std::function<void()> task);
+
+    /**
+     * @brief 追加された処理を実行する
+     * @details 追加された順に実行し、budgetSeconds を超えたら残りは次のフレームに回します（少なくとも1件は実行します）。
+     * @param budgetSeconds 実行に使う時間の目安（秒）
+     * @return 実行した件数
+     */
+    static size_t drain(float budgetSeconds);
+};
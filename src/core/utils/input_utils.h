@@ -17,14 +17,28 @@ namespace InputUtils {
     struct KeyState {
         bool isPressed = false;
         bool wasPressed = false;
+        bool latchedPress = false;  /**< @brief latch()で検出した、まだupdate()に反映していない押下 */
         
         /**
          * @brief キー状態を更新する
+         * @details latch()で保持した押下があれば、既に離されていても押された状態として扱います。
          * @param currentlyPressed 現在の押下状態
          */
         void update(bool currentlyPressed) {
             wasPressed = isPressed;
-            isPressed = currentlyPressed;
+            isPressed = currentlyPressed || latchedPress;
+            latchedPress = false;
+        }
+        
+        /**
+         * @brief 押下を次のupdate()まで保持する
+         * @details 固定ティックでは描画フレームごとに呼び出し、ティックが進まないフレームの押下を取りこぼさないようにします。
+         * @param currentlyPressed 現在の押下状態
+         */
+        void latch(bool currentlyPressed) {
+            if (currentlyPressed && !isPressed) {
+                latchedPress = true;
+            }
         }
         
         /**
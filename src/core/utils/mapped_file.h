@@ -0,0 +1,53 @@
+/**
+ * @file mapped_file.h
+ * @brief メモリマップドファイル
+ * @details ファイルを読み取り専用でメモリにマップします。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 読み取り専用のメモリマップドファイル
+ * @details ファイル全体を読み込まずに、必要な部分だけをOSがページ単位で読み込みます。
+ * マップ中はファイルを置き換え・削除できない環境（Windows）があるため、書き換える前にclose()してください。
+ * コピーはできません（ムーブは可能）。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief ファイルをマップする
+     * @details 既にマップしている場合は閉じてからマップします。空のファイルは開けたものとして扱います（data()はnullptr）。
+     * @param path ファイルのパス
+     * @return 成功時true
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief マップを解除する
+     */
+    void close();
+
+    bool isOpen() const { return opened; }
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    bool opened = false;
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -6,7 +6,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include "../constants/game_constants.h"
+#include "../constants/physics_constants.h"
 
 struct GameState;
 
@@ -0,0 +1,105 @@
+/**
+ * @file time_utils.h
+ * @brief 時間ユーティリティ
+ * @details 固定タイムステップのアキュムレータを提供します。
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief 時間ユーティリティ
+ * @details 固定タイムステップのアキュムレータを提供します。
+ */
+namespace TimeUtils {
+    /**
+     * @brief 固定タイムステップのアキュムレータ
+     * @details 描画フレームの経過時間を蓄積し、固定間隔のシミュレーションステップ数に変換します。
+     * 1フレームあたりのステップ数には上限があり、処理落ち時に更新が追いつかなくなる
+     * 悪循環（spiral of death）を防ぐため、上限を超えた分の時間は破棄します。
+     */
+    class FixedTimestep {
+    public:
+        /**
+         * @brief コンストラクタ
+         * @param tickRate 1秒あたりのステップ数（Hz）
+         * @param maxStepsPerFrame 1フレームあたりの最大ステップ数
+         */
+        explicit FixedTimestep(int tickRate = 60, int maxStepsPerFrame = 8) {
+            setTickRate(tickRate);
+            setMaxStepsPerFrame(maxStepsPerFrame);
+        }
+
+        /**
+         * @brief ティックレートを設定する
+         * @param tickRate 1秒あたりのステップ数（Hz、1以上）
+         */
+        void setTickRate(int tickRate) {
+            tickDeltaTime = 1.0f / static_cast<float>(std::max(tickRate, 1));
+            accumulator = std::min(accumulator, tickDeltaTime);
+        }
+
+        /**
+         * @brief 1フレームあたりの最大ステップ数を設定する
+         * @param maxSteps 最大ステップ数（1以上）
+         */
+        void setMaxStepsPerFrame(int maxSteps) {
+            maxStepsPerFrame = std::max(maxSteps, 1);
+        }
+
+        /**
+         * @brief フレームの経過時間を蓄積し、実行すべきステップ数を返す
+         * @details 返したステップ数分の時間はアキュムレータから差し引かれます。
+         * 上限を超えた場合は残りの蓄積時間を1ステップ未満に切り詰めます。
+         *
+         * @param frameDeltaTime 前フレームからの経過時間（秒）
+         * @return このフレームで実行するステップ数
+         */
+        int advance(float frameDeltaTime) {
+            accumulator += std::max(frameDeltaTime, 0.0f);
+
+            int steps = static_cast<int>(std::floor(accumulator / tickDeltaTime));
+            if (steps > maxStepsPerFrame) {
+                droppedSteps += steps - maxStepsPerFrame;
+                steps = maxStepsPerFrame;
+                accumulator = std::fmod(accumulator, tickDeltaTime);
+            } else {
+                accumulator -= static_cast<float>(steps) * tickDeltaTime;
+            }
+            return steps;
+        }
+
+        /**
+         * @brief 蓄積時間をリセットする
+         * @details ステージ遷移やポーズ明けなど、シミュレーションを止めていた後に呼び出します。
+         */
+        void reset() {
+            accumulator = 0.0f;
+        }
+
+        /**
+         * @brief 1ステップの時間を取得する
+         * @return 1ステップの時間（秒）
+         */
+        float getTickDeltaTime() const { return tickDeltaTime; }
+
+        /**
+         * @brief 次のステップまでの進行度を取得する
+         * @return 0.0〜1.0（前ステップと現ステップの補間係数）
+         */
+        float getAlpha() const { return std::clamp(accumulator / tickDeltaTime, 0.0f, 1.0f); }
+
+        /**
+         * @brief 上限により破棄されたステップ数の累計を取得する
+         * @return 破棄されたステップ数
+         */
+        long long getDroppedSteps() const { return droppedSteps; }
+
+    private:
+        float tickDeltaTime = 1.0f / 60.0f;
+        float accumulator = 0.0f;
+        int maxStepsPerFrame = 8;
+        long long droppedSteps = 0;
+    };
+}
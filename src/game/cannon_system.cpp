@@ -14,32 +14,26 @@ void CannonSystem::updateCannons(GameState& gameState, float deltaTime) {
     }
 }
 
-void CannonSystem::checkCannonCollision(GameState& gameState, const glm::vec3& playerPosition, const glm::vec3& playerSize) {
-    for (auto& cannon : gameState.cannons) {
-        if (!cannon.isActive || cannon.cooldownTimer > 0.0f) {
+void CannonSystem::checkCannonCollision(GameState& gameState) {
+    for (const auto& event : gameState.triggers.events) {
+        if (event.type != TriggerType::Cannon) continue;
+        if (event.targetIndex >= static_cast<int>(gameState.cannons.size())) continue;
+        
+        auto& cannon = gameState.cannons[event.targetIndex];
+        if (event.phase == TriggerPhase::Exit) {
+            cannon.hasPlayerInside = false;
             continue;
         }
         
-        glm::vec3 cannonMin = cannon.position - cannon.size * 0.5f;
-        glm::vec3 cannonMax = cannon.position + cannon.size * 0.5f;
-        glm::vec3 playerMin = playerPosition - playerSize * 0.5f;
-        glm::vec3 playerMax = playerPosition + playerSize * 0.5f;
-        
-        if (playerMax.x > cannonMin.x && playerMin.x < cannonMax.x &&
-            playerMax.y > cannonMin.y && playerMin.y < cannonMax.y &&
-            playerMax.z > cannonMin.z && playerMin.z < cannonMax.z) {
-            
-            if (!cannon.hasPlayerInside) {
-                cannon.hasPlayerInside = true;
-                
-                gameState.player.position = cannon.position;
-                gameState.player.velocity = cannon.launchDirection;
-                
-                cannon.cooldownTimer = cannon.cooldownTime;
-            }
-        } else {
-            cannon.hasPlayerInside = false;
+        if (!cannon.isActive || cannon.cooldownTimer > 0.0f || cannon.hasPlayerInside) {
+            continue;
         }
+        
+        cannon.hasPlayerInside = true;
+        
+        gameState.player.position = cannon.position;
+        gameState.player.velocity = cannon.launchDirection;
+        
+        cannon.cooldownTimer = cannon.cooldownTime;
     }
 }
-
@@ -24,11 +24,10 @@ public:
     
     /**
      * @brief 大砲との衝突判定
-     * @details プレイヤーと大砲の衝突を判定します。
+     * @details 直前のTriggerSystem::update()の結果から、プレイヤーが入った大砲で発射します。
+     * 発射後は一度大砲から出るまで再発射しません。
      * 
      * @param gameState ゲーム状態
-     * @param playerPosition プレイヤー位置
-     * @param playerSize プレイヤーサイズ
      */
-    static void checkCannonCollision(GameState& gameState, const glm::vec3& playerPosition, const glm::vec3& playerSize);
+    static void checkCannonCollision(GameState& gameState);
 };
@@ -17,6 +17,7 @@
  */
 struct GameProgressState {
     float gameTime = 0.0f;
+    float simulationTime = 0.0f;  /**< @brief ステージ開始からのシミュレーション時間（ティックごとに進める。gameTimeは実時間で、再シミュレーションでは再現できない） */
     int currentStage = 0;
     
     float timeLimit = 20.0f;
@@ -5,10 +5,10 @@
 #include "game_state.h"
 
 void initializeGameState(GameState& gameState) {    
-    gameState.platforms.clear();
     gameState.gravityZones.clear();
     gameState.switches.clear();
     gameState.cannons.clear(); 
+    gameState.triggers = TriggerState();
     gameState.progress.isGoalReached = false;
     gameState.progress.clearTime = 0.0f;
 
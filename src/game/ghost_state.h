@@ -0,0 +1,59 @@
+/**
+ * @file ghost_state.h
+ * @brief ゴーストの状態を管理する構造体
+ * @details タイムアタック中にプレイヤーと同時に再生する複数のリプレイ（ゴースト）のデータを保持します。
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * @brief ゴーストの種類
+ */
+enum class GhostSource : uint8_t {
+    LocalBest,  // ローカルの自己ベスト
+    Online,     // オンラインランキングの上位
+    Friend      // オンラインランキングのフレンド（leaderboard_config.jsonのfriends）
+};
+
+/**
+ * @brief ゴーストの状態
+ * @details 配列はすべてSoA（要素ごとに別の配列）で、ゴーストごとの配列はゴースト番号、
+ * フレームの配列は全ゴーストのフレームを連結したものをインデックスにします。
+ * ゴーストiのフレームはframeBegin[i]からframeEnd[i]の手前までです。
+ * 位置はGhostSystem::updateで再生時間に合わせて補間します。
+ */
+struct GhostState {
+    static constexpr size_t MAX_GHOSTS = 128;
+
+    bool isEnabled = true;
+    int stageNumber = 0;  /**< @brief 読み込んだゴーストのステージ番号（0: 未読み込み） */
+
+    // ゴーストごと
+    std::vector<GhostSource> sources;
+    std::vector<std::string> names;
+    std::vector<float> clearTimes;
+    std::vector<glm::vec3> colors;
+    std::vector<uint32_t> frameBegin;
+    std::vector<uint32_t> frameEnd;
+    std::vector<uint32_t> cursors;  /**< @brief 前回参照したフレーム区間の先頭（連結後のインデックス） */
+
+    // 全ゴーストのフレーム
+    std::vector<float> frameTimes;
+    std::vector<float> frameX;
+    std::vector<float> frameY;
+    std::vector<float> frameZ;
+
+    // 補間に使う区間の両端と補間係数（GhostSystem::updateの作業用）
+    std::vector<float> fromX, fromY, fromZ;
+    std::vector<float> toX, toY, toZ;
+    std::vector<float> factors;
+
+    // 補間した位置
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+};
@@ -0,0 +1,206 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "ghost_system.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace {
+    struct PendingGhost {
+        int stageNumber;
+        ReplayData replayData;
+        GhostSource source;
+        std::string name;
+    };
+
+    std::mutex pendingMutex;
+    std::vector<PendingGhost> pendingGhosts;
+
+    void appendGhost(GhostState& ghosts, GhostSource source, const std::string& name, float clearTime, glm::vec3 color) {
+        ghosts.sources.push_back(source);
+        ghosts.names.push_back(name);
+        ghosts.clearTimes.push_back(clearTime);
+        ghosts.colors.push_back(color);
+        ghosts.frameBegin.push_back(static_cast<uint32_t>(ghosts.frameTimes.size()));
+        ghosts.cursors.push_back(static_cast<uint32_t>(ghosts.frameTimes.size()));
+    }
+
+    // update()は時刻で二分探索するため、時刻が戻るフレームや有限でない時刻を含むリプレイは追加しない
+    bool hasOrderedFrames(const ReplayData& replayData) {
+        float previous = -INFINITY;
+        for (const auto& frame : replayData.frames) {
+            if (!std::isfinite(frame.timestamp) || frame.timestamp < previous) {
+                return false;
+            }
+            previous = frame.timestamp;
+        }
+        return true;
+    }
+
+    void finishGhost(GhostState& ghosts) {
+        ghosts.frameEnd.push_back(static_cast<uint32_t>(ghosts.frameTimes.size()));
+
+        size_t count = ghosts.sources.size();
+        for (auto* values : {&ghosts.fromX, &ghosts.fromY, &ghosts.fromZ, &ghosts.toX, &ghosts.toY, &ghosts.toZ,
+                             &ghosts.factors, &ghosts.positionX, &ghosts.positionY, &ghosts.positionZ}) {
+            values->resize(count, 0.0f);
+        }
+    }
+}
+
+void GhostSystem::clear(GhostState& ghosts, int stageNumber) {
+    bool isEnabled = ghosts.isEnabled;
+    ghosts = GhostState();
+    ghosts.isEnabled = isEnabled;
+    ghosts.stageNumber = stageNumber;
+}
+
+int GhostSystem::add(GhostState& ghosts, const ReplayData& replayData, GhostSource source, const std::string& name) {
+    if (replayData.frames.empty() || replayData.stageNumber != ghosts.stageNumber ||
+        ghosts.sources.size() >= GhostState::MAX_GHOSTS || !hasOrderedFrames(replayData)) {
+        return -1;
+    }
+
+    int index = static_cast<int>(ghosts.sources.size());
+    appendGhost(ghosts, source, name, replayData.clearTime, getColor(source));
+
+    size_t frameCount = ghosts.frameTimes.size() + replayData.frames.size();
+    ghosts.frameTimes.reserve(frameCount);
+    ghosts.frameX.reserve(frameCount);
+    ghosts.frameY.reserve(frameCount);
+    ghosts.frameZ.reserve(frameCount);
+    for (const auto& frame : replayData.frames) {
+        ghosts.frameTimes.push_back(frame.timestamp);
+        ghosts.frameX.push_back(frame.playerPosition.x);
+        ghosts.frameY.push_back(frame.playerPosition.y);
+        ghosts.frameZ.push_back(frame.playerPosition.z);
+    }
+
+    finishGhost(ghosts);
+    return index;
+}
+
+void GhostSystem::removeSource(GhostState& ghosts, GhostSource source) {
+    GhostState kept;
+    kept.isEnabled = ghosts.isEnabled;
+    kept.stageNumber = ghosts.stageNumber;
+
+    for (size_t i = 0; i < ghosts.sources.size(); i++) {
+        if (ghosts.sources[i] == source) {
+            continue;
+        }
+        appendGhost(kept, ghosts.sources[i], ghosts.names[i], ghosts.clearTimes[i], ghosts.colors[i]);
+        kept.frameTimes.insert(kept.frameTimes.end(), ghosts.frameTimes.begin() + ghosts.frameBegin[i], ghosts.frameTimes.begin() + ghosts.frameEnd[i]);
+        kept.frameX.insert(kept.frameX.end(), ghosts.frameX.begin() + ghosts.frameBegin[i], ghosts.frameX.begin() + ghosts.frameEnd[i]);
+        kept.frameY.insert(kept.frameY.end(), ghosts.frameY.begin() + ghosts.frameBegin[i], ghosts.frameY.begin() + ghosts.frameEnd[i]);
+        kept.frameZ.insert(kept.frameZ.end(), ghosts.frameZ.begin() + ghosts.frameBegin[i], ghosts.frameZ.begin() + ghosts.frameEnd[i]);
+        finishGhost(kept);
+    }
+
+    ghosts = std::move(kept);
+}
+
+void GhostSystem::update(GhostState& ghosts, float time) {
+    const size_t count = ghosts.sources.size();
+    const float* times = ghosts.frameTimes.data();
+
+    // 区間の検索（ゴーストごとにフレーム数・時刻が異なるため、ここだけはゴーストごとに分岐する）
+    for (size_t i = 0; i < count; i++) {
+        uint32_t begin = ghosts.frameBegin[i];
+        uint32_t last = ghosts.frameEnd[i] - 1;
+        uint32_t from = begin;
+        uint32_t to = begin;
+        float factor = 0.0f;
+
+        if (time >= times[last]) {
+            from = last;
+            to = last;
+        } else if (time > times[begin]) {
+            uint32_t cursor = std::clamp(ghosts.cursors[i], begin, last - 1);
+            if (times[cursor] > time || times[cursor + 1] < time) {
+                if (cursor + 2 <= last && times[cursor + 1] <= time && time <= times[cursor + 2]) {
+                    cursor++;
+                } else {
+                    cursor = static_cast<uint32_t>(std::upper_bound(times + begin, times + last + 1, time) - times) - 1;
+                    cursor = std::clamp(cursor, begin, last - 1);
+                }
+            }
+            ghosts.cursors[i] = cursor;
+
+            from = cursor;
+            to = cursor + 1;
+            float span = times[to] - times[from];
+            factor = span > 0.0f ? (time - times[from]) / span : 0.0f;
+        }
+
+        ghosts.fromX[i] = ghosts.frameX[from];
+        ghosts.fromY[i] = ghosts.frameY[from];
+        ghosts.fromZ[i] = ghosts.frameZ[from];
+        ghosts.toX[i] = ghosts.frameX[to];
+        ghosts.toY[i] = ghosts.frameY[to];
+        ghosts.toZ[i] = ghosts.frameZ[to];
+        ghosts.factors[i] = factor;
+    }
+
+    // 補間（連続した配列だけを読み書きするため、コンパイラがSIMD命令にまとめられる）
+    const float* fromX = ghosts.fromX.data();
+    const float* fromY = ghosts.fromY.data();
+    const float* fromZ = ghosts.fromZ.data();
+    const float* toX = ghosts.toX.data();
+    const float* toY = ghosts.toY.data();
+    const float* toZ = ghosts.toZ.data();
+    const float* factors = ghosts.factors.data();
+    float* positionX = ghosts.positionX.data();
+    float* positionY = ghosts.positionY.data();
+    float* positionZ = ghosts.positionZ.data();
+    for (size_t i = 0; i < count; i++) {
+        positionX[i] = fromX[i] + (toX[i] - fromX[i]) * factors[i];
+        positionY[i] = fromY[i] + (toY[i] - fromY[i]) * factors[i];
+        positionZ[i] = fromZ[i] + (toZ[i] - fromZ[i]) * factors[i];
+    }
+}
+
+size_t GhostSystem::count(const GhostState& ghosts) {
+    return ghosts.sources.size();
+}
+
+glm::vec3 GhostSystem::getColor(GhostSource source) {
+    switch (source) {
+        case GhostSource::LocalBest:
+            return glm::vec3(1.0f, 1.0f, 1.0f);
+        case GhostSource::Online:
+            return glm::vec3(0.4f, 0.7f, 1.0f);
+        case GhostSource::Friend:
+            return glm::vec3(0.4f, 1.0f, 0.5f);
+    }
+    return glm::vec3(1.0f);
+}
+
+void GhostSystem::enqueue(int stageNumber, const ReplayData& replayData, GhostSource source, const std::string& name) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pendingGhosts.push_back({stageNumber, replayData, source, name});
+    // 旧形式（JSON）のリプレイはステージ番号を持たないことがあるため、取得元のステージ番号を使う
+    pendingGhosts.back().replayData.stageNumber = stageNumber;
+}
+
+size_t GhostSystem::addPending(GhostState& ghosts) {
+    std::vector<PendingGhost> ready;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (pendingGhosts.empty()) {
+            return 0;
+        }
+        ready.swap(pendingGhosts);
+    }
+
+    size_t added = 0;
+    for (const auto& pending : ready) {
+        if (pending.stageNumber == ghosts.stageNumber &&
+            add(ghosts, pending.replayData, pending.source, pending.name) >= 0) {
+            added++;
+        }
+    }
+    return added;
+}
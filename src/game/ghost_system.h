@@ -0,0 +1,91 @@
+/**
+ * @file ghost_system.h
+ * @brief ゴーストシステム
+ * @details 複数のリプレイをゴーストとして読み込み、再生時間に合わせた位置をまとめて補間します。
+ */
+#pragma once
+
+#include <string>
+#include "ghost_state.h"
+#include "replay_state.h"
+
+/**
+ * @brief ゴーストシステム
+ * @details 通常のリプレイ再生（ReplayState::currentReplay）と異なり、プレイヤーは動かさず、
+ * 位置だけを再生します。ゴーストごとにカーソルを持ち、区間の検索はReplayPlaybackと同じく
+ * 前回の区間から進め、見つからない場合は二分探索します。補間は全ゴーストを1回のループで行います。
+ * オンラインからの読み込みは別スレッドで完了するため、enqueue()で受け取り、
+ * メインスレッドでaddPending()を呼び出して追加します。
+ */
+class GhostSystem {
+public:
+    /**
+     * @brief ゴーストを全て削除する
+     * @param ghosts ゴーストの状態
+     * @param stageNumber これから読み込むゴーストのステージ番号
+     */
+    static void clear(GhostState& ghosts, int stageNumber);
+
+    /**
+     * @brief リプレイをゴーストとして追加する
+     * @details フレームがない場合、ステージ番号が異なる場合、MAX_GHOSTSに達している場合、
+     * フレームの時刻が戻っている場合は追加しません。
+     *
+     * @param ghosts ゴーストの状態
+     * @param replayData リプレイデータ（フレームは時刻順）
+     * @param source ゴーストの種類
+     * @param name 表示名
+     * @return 追加したゴーストの番号（追加しなかった場合は-1）
+     */
+    static int add(GhostState& ghosts, const ReplayData& replayData, GhostSource source, const std::string& name);
+
+    /**
+     * @brief 指定した種類のゴーストを削除する
+     * @details 自己ベストの更新時など、一部のゴーストだけを読み込み直すときに使います。
+     *
+     * @param ghosts ゴーストの状態
+     * @param source 削除するゴーストの種類
+     */
+    static void removeSource(GhostState& ghosts, GhostSource source);
+
+    /**
+     * @brief 再生時間に合わせて全ゴーストの位置を補間する
+     * @details 最初のフレームより前は最初のフレーム、最後のフレームより後は最後のフレーム（ゴール地点）の位置になります。
+     *
+     * @param ghosts ゴーストの状態（カーソルと位置を更新する）
+     * @param time 再生時間（タイムアタックの経過時間）
+     */
+    static void update(GhostState& ghosts, float time);
+
+    /**
+     * @brief ゴーストの数を取得する
+     * @param ghosts ゴーストの状態
+     * @return ゴーストの数
+     */
+    static size_t count(const GhostState& ghosts);
+
+    /**
+     * @brief ゴーストの種類ごとの色を取得する
+     * @param source ゴーストの種類
+     * @return 色
+     */
+    static glm::vec3 getColor(GhostSource source);
+
+    /**
+     * @brief 追加待ちのゴーストを登録する（スレッドセーフ）
+     * @param stageNumber ステージ番号
+     * @param replayData リプレイデータ
+     * @param source ゴーストの種類
+     * @param name 表示名
+     */
+    static void enqueue(int stageNumber, const ReplayData& replayData, GhostSource source, const std::string& name);
+
+    /**
+     * @brief 追加待ちのゴーストを追加する
+     * @details ghosts.stageNumberと異なるステージのものは破棄します。メインスレッドから呼び出してください。
+     *
+     * @param ghosts ゴーストの状態
+     * @return 追加したゴーストの数
+     */
+    static size_t addPending(GhostState& ghosts);
+};
@@ -0,0 +1,361 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "http_worker.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr long CONNECT_TIMEOUT_SECONDS = 3;
+    // timeoutSecondsが0の場合、10秒間で100バイト未満しか受信できなければ打ち切る
+    constexpr long LOW_SPEED_LIMIT = 100;
+    constexpr long LOW_SPEED_TIME = 10;
+    constexpr int POLL_TIMEOUT_MS = 1000;
+
+    /**
+     * @brief 処理中のリクエスト
+     */
+    struct Transfer {
+        HttpRequest request;
+        HttpResponse response;
+        CURL* easy = nullptr;
+        curl_slist* headers = nullptr;
+        bool superseded = false;  // WorkerState::mutexで保護
+        bool aborted = false;     // onDataがfalseを返した
+
+        ~Transfer() {
+            if (headers) {
+                curl_slist_free_all(headers);
+            }
+            if (easy) {
+                curl_easy_cleanup(easy);
+            }
+        }
+    };
+
+    struct WorkerState {
+        std::mutex mutex;
+        std::deque<HttpRequest> queue;                    // 開始待ち
+        std::vector<std::pair<HttpRequest, HttpResponse>> unstarted;  // 開始せずに終わった（通信スレッドで完了を通知する）
+        std::vector<std::unique_ptr<Transfer>> active;    // 処理中
+        CURLM* multi = nullptr;
+        std::thread thread;
+        bool stopping = false;
+
+        ~WorkerState() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+                if (multi) {
+                    curl_multi_wakeup(multi);
+                }
+            }
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    };
+
+    WorkerState worker;
+
+    size_t writeCallback(char* data, size_t size, size_t nmemb, void* userdata) {
+        Transfer* transfer = static_cast<Transfer*>(userdata);
+        size_t totalSize = size * nmemb;
+        if (transfer->request.onData) {
+            if (!transfer->request.onData(data, totalSize)) {
+                transfer->aborted = true;
+                return 0;  // 受信を中断する
+            }
+            return totalSize;
+        }
+        transfer->response.body.append(data, totalSize);
+        return totalSize;
+    }
+
+    size_t headerCallback(char* data, size_t size, size_t nmemb, void* userdata) {
+        Transfer* transfer = static_cast<Transfer*>(userdata);
+        size_t totalSize = size * nmemb;
+        std::string line(data, totalSize);
+        constexpr const char* ETAG_HEADER = "etag:";
+        constexpr size_t ETAG_HEADER_LENGTH = 5;
+        if (line.size() > ETAG_HEADER_LENGTH &&
+            std::equal(line.begin(), line.begin() + ETAG_HEADER_LENGTH, ETAG_HEADER,
+                       [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; })) {
+            size_t begin = line.find_first_not_of(" \t", ETAG_HEADER_LENGTH);
+            size_t end = line.find_last_not_of(" \t\r\n");
+            transfer->response.etag = (begin == std::string::npos || end < begin) ? "" : line.substr(begin, end - begin + 1);
+        }
+        return totalSize;
+    }
+
+    /**
+     * @brief リクエストの通信を開始する（呼び出し側でロックを取っていること）
+     */
+    void startTransfer(HttpRequest&& request) {
+        auto transfer = std::make_unique<Transfer>();
+        transfer->request = std::move(request);
+        transfer->easy = curl_easy_init();
+        if (!transfer->easy) {
+            std::cerr << "Failed to initialize CURL" << std::endl;
+            worker.unstarted.emplace_back(std::move(transfer->request), HttpResponse());
+            return;
+        }
+
+        CURL* easy = transfer->easy;
+        const HttpRequest& req = transfer->request;
+        curl_easy_setopt(easy, CURLOPT_URL, req.url.c_str());
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeCallback);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, headerCallback);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT_SECONDS);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        if (req.timeoutSeconds > 0) {
+            curl_easy_setopt(easy, CURLOPT_TIMEOUT, req.timeoutSeconds);
+        } else {
+            curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, LOW_SPEED_LIMIT);
+            curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME, LOW_SPEED_TIME);
+        }
+        if (req.method == HttpRequest::Method::Post) {
+            transfer->headers = curl_slist_append(transfer->headers, "Content-Type: application/json");
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, req.body.c_str());
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(req.body.size()));
+        }
+        for (const auto& header : req.headers) {
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        }
+        if (transfer->headers) {
+            curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+        }
+
+        curl_multi_add_handle(worker.multi, easy);
+        worker.active.push_back(std::move(transfer));
+    }
+
+    std::unique_ptr<Transfer> takeTransfer(CURL* easy) {
+        auto it = std::find_if(worker.active.begin(), worker.active.end(),
+                               [easy](const std::unique_ptr<Transfer>& transfer) { return transfer->easy == easy; });
+        if (it == worker.active.end()) {
+            return nullptr;
+        }
+        std::unique_ptr<Transfer> transfer = std::move(*it);
+        worker.active.erase(it);
+        return transfer;
+    }
+
+    void complete(Transfer& transfer, CURLcode result) {
+        curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &transfer.response.httpCode);
+        transfer.response.success = result == CURLE_OK &&
+                                    (transfer.response.httpCode == 200 || transfer.response.httpCode == 304);
+        if (!transfer.response.success && !transfer.aborted) {
+            std::cerr << "HTTP " << (transfer.request.method == HttpRequest::Method::Post ? "POST" : "GET")
+                      << " failed: " << curl_easy_strerror(result) << " (HTTP " << transfer.response.httpCode << ")" << std::endl;
+        }
+        if (transfer.request.onComplete) {
+            transfer.request.onComplete(transfer.response);
+        }
+    }
+
+    void workerLoop() {
+        CURLM* multi = worker.multi;
+        while (true) {
+            std::vector<std::pair<HttpRequest, HttpResponse>> unstarted;
+            std::vector<std::unique_ptr<Transfer>> superseded;
+            std::vector<HttpRequest> building;
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                if (worker.stopping) {
+                    break;
+                }
+                for (auto it = worker.active.begin(); it != worker.active.end();) {
+                    if ((*it)->superseded) {
+                        superseded.push_back(std::move(*it));
+                        it = worker.active.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                while (!worker.queue.empty() &&
+                       worker.active.size() + building.size() < static_cast<size_t>(HttpWorker::MAX_CONNECTIONS)) {
+                    HttpRequest request = std::move(worker.queue.front());
+                    worker.queue.pop_front();
+                    if (request.makeBody) {
+                        building.push_back(std::move(request));
+                    } else {
+                        startTransfer(std::move(request));
+                    }
+                }
+                unstarted.swap(worker.unstarted);
+            }
+
+            // 本文の作成（リプレイのエンコードなど）はロックを外して行う
+            if (!building.empty()) {
+                for (auto& request : building) {
+                    request.body = request.makeBody();
+                    request.makeBody = nullptr;
+                }
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                for (auto& request : building) {
+                    startTransfer(std::move(request));
+                }
+            }
+
+            // コールバックはロックを外して呼ぶ（コールバックから次のリクエストを追加できるように）
+            for (auto& transfer : superseded) {
+                curl_multi_remove_handle(multi, transfer->easy);
+                transfer->response.superseded = true;
+                if (transfer->request.onComplete) {
+                    transfer->request.onComplete(transfer->response);
+                }
+            }
+            for (auto& [request, response] : unstarted) {
+                if (request.onComplete) {
+                    request.onComplete(response);
+                }
+            }
+
+            int running = 0;
+            curl_multi_perform(multi, &running);
+
+            std::vector<std::pair<CURL*, CURLcode>> done;
+            int remaining = 0;
+            while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+                if (message->msg == CURLMSG_DONE) {
+                    done.emplace_back(message->easy_handle, message->data.result);
+                }
+            }
+            for (const auto& [easy, result] : done) {
+                curl_multi_remove_handle(multi, easy);
+                std::unique_ptr<Transfer> transfer;
+                {
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    transfer = takeTransfer(easy);
+                }
+                if (transfer) {
+                    complete(*transfer, result);
+                }
+            }
+
+            // 通信があるか、submit()・shutdown()で起こされるまで待つ
+            curl_multi_poll(multi, nullptr, 0, POLL_TIMEOUT_MS, nullptr);
+        }
+
+        // 終了時は処理中のリクエストを中断する（コールバックは呼ばない）
+        std::vector<std::unique_ptr<Transfer>> remaining;
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            remaining.swap(worker.active);
+            worker.queue.clear();
+            worker.unstarted.clear();
+        }
+        for (auto& transfer : remaining) {
+            curl_multi_remove_handle(multi, transfer->easy);
+        }
+        remaining.clear();
+    }
+
+    /**
+     * @brief 同じキーの古いリクエストを置き換え済みにする（呼び出し側でロックを取っていること）
+     * @details 開始前なら取り除き、処理中なら通信スレッドで中断します。
+     */
+    void supersede(const std::string& supersedeKey) {
+        for (auto it = worker.queue.begin(); it != worker.queue.end();) {
+            if (it->supersedeKey == supersedeKey) {
+                HttpResponse response;
+                response.superseded = true;
+                worker.unstarted.emplace_back(std::move(*it), response);
+                it = worker.queue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto& transfer : worker.active) {
+            if (transfer->request.supersedeKey == supersedeKey) {
+                transfer->superseded = true;
+            }
+        }
+    }
+
+    /**
+     * @brief 通信スレッドを起動する（呼び出し側でロックを取っていること）
+     */
+    bool ensureStarted() {
+        if (worker.thread.joinable()) {
+            return true;
+        }
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        worker.multi = curl_multi_init();
+        if (!worker.multi) {
+            std::cerr << "Failed to initialize CURL multi handle" << std::endl;
+            return false;
+        }
+        // 同じサーバーへの接続はMAX_CONNECTIONS本までにし、終わった接続はKeep-Aliveのまま次のリクエストで使う
+        curl_multi_setopt(worker.multi, CURLMOPT_MAX_HOST_CONNECTIONS, HttpWorker::MAX_CONNECTIONS);
+        curl_multi_setopt(worker.multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, HttpWorker::MAX_CONNECTIONS);
+        curl_multi_setopt(worker.multi, CURLMOPT_MAXCONNECTS, HttpWorker::MAX_CONNECTIONS);
+        worker.thread = std::thread(workerLoop);
+        return true;
+    }
+}
+
+bool HttpWorker::submit(HttpRequest request) {
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.stopping && ensureStarted()) {
+            if (!request.supersedeKey.empty()) {
+                supersede(request.supersedeKey);
+            }
+
+            if (worker.queue.size() < MAX_QUEUED_REQUESTS) {
+                worker.queue.push_back(std::move(request));
+                curl_multi_wakeup(worker.multi);
+                return true;
+            }
+            std::cerr << "HTTP request queue is full, dropping request: " << request.url << std::endl;
+        }
+    }
+
+    HttpResponse response;
+    if (request.onComplete) {
+        request.onComplete(response);
+    }
+    return false;
+}
+
+void HttpWorker::cancel(const std::string& supersedeKey) {
+    if (supersedeKey.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.stopping || !worker.thread.joinable()) {
+        return;
+    }
+    supersede(supersedeKey);
+    curl_multi_wakeup(worker.multi);
+}
+
+void HttpWorker::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.stopping = true;
+        if (worker.multi) {
+            curl_multi_wakeup(worker.multi);
+        }
+    }
+    if (worker.thread.joinable()) {
+        worker.thread.join();
+    }
+    if (worker.multi) {
+        curl_multi_cleanup(worker.multi);
+        worker.multi = nullptr;
+    }
+}
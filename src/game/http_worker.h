@@ -0,0 +1,108 @@
+/**
+ * @file http_worker.h
+ * @brief HTTP通信スレッド
+ * @details 1つのスレッドとcurl_multiで全てのHTTPリクエストを処理し、接続を使い回します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief HTTPレスポンス
+ */
+struct HttpResponse {
+    bool success = false;      /**< @brief 通信に成功し、HTTP 200（If-None-Matchを送った場合は304も）が返った場合true */
+    long httpCode = 0;         /**< @brief HTTPステータスコード（通信できなかった場合は0） */
+    std::string etag;          /**< @brief レスポンスのETagヘッダー（ない場合は空） */
+    bool superseded = false;   /**< @brief 同じキーの新しいリクエストに置き換えられた場合true */
+    std::string body;          /**< @brief レスポンスの本文（onDataを指定した場合は空） */
+};
+
+/**
+ * @brief HTTPリクエスト
+ */
+struct HttpRequest {
+    enum class Method {
+        Get,
+        Post
+    };
+
+    Method method = Method::Get;
+    std::string url;
+    std::string body;          /**< @brief POSTの本文（JSON） */
+    std::vector<std::string> headers;  /**< @brief 追加のリクエストヘッダー（"Name: value"） */
+
+    /**
+     * @brief 本文を作る関数（任意）
+     * @details 指定した場合は通信スレッドで開始の直前に呼び、戻り値をbodyにします（リプレイのエンコードをメインスレッドで行わないため）。
+     */
+    std::function<std::string()> makeBody;
+
+    /**
+     * @brief 置き換えのキー
+     * @details 空でない場合、同じキーのまだ終わっていないリクエストを取り消します（ランキングのステージ切り替えなど）。
+     */
+    std::string supersedeKey;
+
+    /**
+     * @brief 全体の時間制限（秒）
+     * @details 0の場合は全体の時間で打ち切らず、一定時間ほとんど受信できないときに中断します（大きなリプレイ用）。
+     */
+    long timeoutSeconds = 5;
+
+    /**
+     * @brief 受信したデータを受け取る関数（任意）
+     * @details 指定した場合はレスポンスを溜めずに受信した順に渡します。falseを返すと通信を中断します。
+     */
+    std::function<bool(const char*, size_t)> onData;
+
+    /**
+     * @brief 完了時に呼ばれる関数
+     * @details 成功・失敗・置き換えのいずれの場合も1回だけ、通信スレッドから呼ばれます。
+     */
+    std::function<void(const HttpResponse&)> onComplete;
+};
+
+/**
+ * @brief HTTP通信スレッド
+ * @details リクエストは上限付きのキューに入れ、1つの通信スレッドがcurl_multiで最大MAX_CONNECTIONS件まで同時に処理します。
+ * 接続はcurl_multiの接続キャッシュでKeep-Aliveのまま使い回すため、リクエストごとにスレッドやTCP接続を作りません。
+ *
+ * 通信スレッドは最初のリクエストで起動し、shutdown()で終了します。
+ */
+class HttpWorker {
+public:
+    static constexpr size_t MAX_QUEUED_REQUESTS = 32;  /**< @brief 開始待ちにできるリクエストの最大数 */
+    static constexpr long MAX_CONNECTIONS = 4;         /**< @brief 同時に処理するリクエスト（接続）の最大数 */
+
+    /**
+     * @brief リクエストを追加する
+     * @details キューが一杯の場合は、その場でonCompleteを失敗として呼び出します。
+     * 通信スレッド（onCompleteの中など）からも呼び出せます。
+     *
+     * @param request リクエスト
+     * @return キューに追加した場合true
+     */
+    static bool submit(HttpRequest request);
+
+    /**
+     * @brief 同じキーのまだ終わっていないリクエストを取り消す
+     * @details 取り消したリクエストのonCompleteは、supersededをtrueにして通信スレッドから呼ばれます。
+     * 新しいリクエストを送らずにキーの結果を捨てたい場合（キャッシュから表示した場合など）に呼び出します。
+     *
+     * @param supersedeKey 置き換えのキー
+     */
+    static void cancel(const std::string& supersedeKey);
+
+    /**
+     * @brief 通信スレッドを終了する
+     * @details 処理中・開始待ちのリクエストは中断し、onCompleteは呼び出しません。アプリケーションの終了時に呼び出します。
+     */
+    static void shutdown();
+};
@@ -0,0 +1,42 @@
+/**
+ * @file input_replay.h
+ * @brief 入力リプレイのデータ構造
+ * @details 固定ティックごとの入力だけを保持するリプレイです。
+ * 位置を記録するReplayDataと異なり、再シミュレーションで走行そのものを再現できます。
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 1ティック分の入力
+ * @details 移動方向はカメラの向きを適用した後のワールド座標系の向きを量子化したものです。
+ * カメラやキー配置に依存せず、同じ入力から同じ結果を得られます。
+ */
+struct TickInput {
+    static constexpr uint8_t BUTTON_JUMP = 1 << 0;  // このティックでジャンプボタンが押された（押し始めのみ）
+
+    uint8_t buttons = 0;
+    int8_t moveX = 0;            // 移動方向X（-127〜127、移動しない場合はX・Zとも0）
+    int8_t moveZ = 0;            // 移動方向Z（-127〜127）
+    uint8_t timeScaleLevel = 0;  // GameProgressState::timeScaleLevel（0: 1倍、1: 2倍、2: 3倍）
+
+    bool operator==(const TickInput& other) const = default;
+};
+
+/**
+ * @brief 入力リプレイ
+ * @details タイムアタック開始（カウントダウン終了）から1ティックにつき1つの入力を持ちます。
+ * ステージハッシュが一致するステージを読み込み直後の状態から、同じティックレートで
+ * SimulationSystem::stepに入力を与えると、記録時と同じ走行になります。
+ */
+struct InputReplay {
+    int stageNumber = 0;
+    uint64_t stageHash = 0;   // InputReplaySystem::hashStage()の値
+    uint32_t rngSeed = 0;     // シミュレーションの乱数の種（現在のシミュレーションは乱数を使わないため0）
+    int tickRate = 0;         // 1秒あたりのティック数
+    float clearTime = 0.0f;   // 記録時のクリアタイム（未クリアの場合は0）
+    bool isEasyMode = false;
+    std::vector<TickInput> inputs;
+};
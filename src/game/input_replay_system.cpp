@@ -0,0 +1,214 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "input_replay_system.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <variant>
+
+namespace {
+    constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+    constexpr float MOVE_SCALE = 127.0f;
+
+    void hashBytes(uint64_t& hash, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+    }
+
+    void hashInt(uint64_t& hash, int64_t value) {
+        hashBytes(hash, &value, sizeof(value));
+    }
+
+    void hashFloat(uint64_t& hash, float value) {
+        // -0.0と0.0を同じ値として扱う
+        if (value == 0.0f) value = 0.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        hashBytes(hash, &bits, sizeof(bits));
+    }
+
+    void hashVec3(uint64_t& hash, const glm::vec3& value) {
+        hashFloat(hash, value.x);
+        hashFloat(hash, value.y);
+        hashFloat(hash, value.z);
+    }
+
+    /**
+     * @brief 足場の動き方・タイミングの設定を含める
+     * @details 位置が同じでも速度や周期が変わると走行が変わるため、種類ごとの設定値を含めます（実行中に変わる状態は含めない）。
+     */
+    template <typename Platform>
+    void hashPlatformMotion(uint64_t& hash, const Platform& platform) {
+        if constexpr (std::is_same_v<Platform, MovingPlatform>) {
+            hashVec3(hash, platform.moveTargetPosition);
+            hashFloat(hash, platform.moveSpeed);
+            hashVec3(hash, platform.originalPosition);
+            hashInt(hash, platform.returnToOriginal ? 1 : 0);
+        } else if constexpr (std::is_same_v<Platform, RotatingPlatform>) {
+            hashVec3(hash, platform.rotationAxis);
+            hashFloat(hash, platform.rotationSpeed);
+        } else if constexpr (std::is_same_v<Platform, PatrollingPlatform>) {
+            hashInt(hash, static_cast<int64_t>(platform.patrolPoints.size()));
+            for (const auto& point : platform.patrolPoints) {
+                hashVec3(hash, point);
+            }
+            hashFloat(hash, platform.patrolSpeed);
+        } else if constexpr (std::is_same_v<Platform, TeleportPlatform>) {
+            hashVec3(hash, platform.teleportDestination);
+            hashFloat(hash, platform.cooldown);
+        } else if constexpr (std::is_same_v<Platform, JumpPad>) {
+            hashFloat(hash, platform.jumpPower);
+        } else if constexpr (std::is_same_v<Platform, CycleDisappearingPlatform>) {
+            hashFloat(hash, platform.cycleTime);
+            hashFloat(hash, platform.visibleTime);
+            hashFloat(hash, platform.blinkTime);
+        } else if constexpr (std::is_same_v<Platform, FlyingPlatform>) {
+            hashVec3(hash, platform.spawnPosition);
+            hashVec3(hash, platform.targetPosition);
+            hashFloat(hash, platform.flySpeed);
+            hashFloat(hash, platform.detectionRange);
+        }
+    }
+}
+
+uint64_t InputReplaySystem::hashStage(const GameState& gameState, const PlatformSystem& platformSystem) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    const auto& platforms = platformSystem.getPlatforms();
+    hashInt(hash, static_cast<int64_t>(platforms.size()));
+    for (const auto& platform : platforms) {
+        hashInt(hash, static_cast<int64_t>(platform.index()));
+        std::visit([&hash](const auto& p) {
+            hashVec3(hash, p.position);
+            hashVec3(hash, p.size);
+            hashVec3(hash, p.color);  // ゴールは色で判定しているため色も含める
+            hashPlatformMotion(hash, p);
+        }, platform);
+    }
+
+    hashInt(hash, static_cast<int64_t>(gameState.items.items.size()));
+    for (const auto& item : gameState.items.items) {
+        hashVec3(hash, item.position);
+    }
+    hashInt(hash, gameState.items.requiredItems);
+
+    hashInt(hash, static_cast<int64_t>(gameState.gravityZones.size()));
+    for (const auto& zone : gameState.gravityZones) {
+        hashVec3(hash, zone.position);
+        hashFloat(hash, zone.radius);
+    }
+
+    hashInt(hash, static_cast<int64_t>(gameState.switches.size()));
+    for (const auto& switchObj : gameState.switches) {
+        hashVec3(hash, switchObj.position);
+        hashVec3(hash, switchObj.size);
+    }
+
+    hashInt(hash, static_cast<int64_t>(gameState.cannons.size()));
+    for (const auto& cannon : gameState.cannons) {
+        hashVec3(hash, cannon.position);
+        hashVec3(hash, cannon.size);
+    }
+
+    hashVec3(hash, gameState.player.position);
+    return hash;
+}
+
+void InputReplaySystem::setMoveDirection(TickInput& input, const glm::vec3& moveDirection) {
+    float length = std::sqrt(moveDirection.x * moveDirection.x + moveDirection.z * moveDirection.z);
+    if (!(length > 0.0f)) {
+        input.moveX = 0;
+        input.moveZ = 0;
+        return;
+    }
+
+    input.moveX = static_cast<int8_t>(std::lround(std::clamp(moveDirection.x / length, -1.0f, 1.0f) * MOVE_SCALE));
+    input.moveZ = static_cast<int8_t>(std::lround(std::clamp(moveDirection.z / length, -1.0f, 1.0f) * MOVE_SCALE));
+}
+
+glm::vec3 InputReplaySystem::getMoveDirection(const TickInput& input) {
+    if (input.moveX == 0 && input.moveZ == 0) {
+        return glm::vec3(0.0f);
+    }
+    return glm::normalize(glm::vec3(static_cast<float>(input.moveX), 0.0f, static_cast<float>(input.moveZ)));
+}
+
+void InputReplaySystem::begin(InputReplay& replay, const GameState& gameState, const PlatformSystem& platformSystem, int stageNumber) {
+    replay.stageNumber = stageNumber;
+    replay.stageHash = hashStage(gameState, platformSystem);
+    replay.rngSeed = 0;
+    replay.tickRate = 0;
+    replay.clearTime = 0.0f;
+    replay.isEasyMode = gameState.progress.isEasyMode;
+    replay.inputs.clear();
+}
+
+bool InputReplaySystem::record(InputReplay& replay, const TickInput& input, float deltaTime) {
+    if (!(deltaTime > 0.0f)) {
+        return false;
+    }
+
+    if (replay.tickRate <= 0) {
+        replay.tickRate = static_cast<int>(std::lround(1.0f / deltaTime));
+    }
+    // 固定ティックでなければ再シミュレーションで同じデルタタイムを再現できない
+    if (replay.tickRate <= 0 || std::abs(deltaTime * static_cast<float>(replay.tickRate) - 1.0f) > 1e-3f) {
+        return false;
+    }
+
+    replay.inputs.push_back(input);
+    return true;
+}
+
+InputReplaySystem::SimulationResult InputReplaySystem::simulate(const InputReplay& replay, GameState& gameState,
+                                                                PlatformSystem& platformSystem, const SimulationEvents& events) {
+    SimulationResult result;
+    result.stageHashMatched = (hashStage(gameState, platformSystem) == replay.stageHash);
+    result.requiredItems = gameState.items.requiredItems;
+    result.finalPosition = gameState.player.position;
+    if (!result.stageHashMatched || replay.tickRate <= 0) {
+        return result;
+    }
+
+    gameState.progress.isTimeAttackMode = true;
+    gameState.progress.currentTimeAttackTime = 0.0f;
+    // ステージ内の時間は読み込み直後（0）から、ティックごとに進める
+    gameState.progress.gameTime = 0.0f;
+    gameState.progress.simulationTime = 0.0f;
+    gameState.progress.isEasyMode = replay.isEasyMode;
+    // 開始時点のtimeScale（Ready画面で選んだ速度）は最初のティックの入力と同じ
+    gameState.progress.timeScaleLevel = replay.inputs.empty() ? 0 : std::min<int>(replay.inputs.front().timeScaleLevel, 2);
+    gameState.progress.timeScale = 1.0f + static_cast<float>(gameState.progress.timeScaleLevel);
+
+    bool goalReached = false;
+    SimulationEvents tickEvents = events;
+    tickEvents.onGoalReached = [&goalReached, &events]() {
+        goalReached = true;
+        if (events.onGoalReached) {
+            events.onGoalReached();
+        }
+    };
+
+    const float tickDeltaTime = 1.0f / static_cast<float>(replay.tickRate);
+    for (const TickInput& input : replay.inputs) {
+        SimulationSystem::step(gameState, platformSystem, replay.stageNumber, tickDeltaTime, input, tickEvents);
+        result.ticks++;
+        if (goalReached) {
+            break;
+        }
+    }
+
+    result.goalReached = goalReached;
+    result.clearTime = gameState.progress.currentTimeAttackTime;
+    result.collectedItems = gameState.items.collectedItems;
+    result.requiredItems = gameState.items.requiredItems;
+    result.finalPosition = gameState.player.position;
+    return result;
+}
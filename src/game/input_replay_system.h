@@ -0,0 +1,101 @@
+/**
+ * @file input_replay_system.h
+ * @brief 入力リプレイシステム
+ * @details 固定ティックの入力列の記録と、それを使った再シミュレーションを提供します。
+ */
+#pragma once
+
+#include "game_state.h"
+#include "platform_system.h"
+#include "input_replay.h"
+#include "simulation_system.h"
+
+/**
+ * @brief 入力リプレイシステム
+ * @details 位置ではなく入力を記録し、ステージを読み込み直した状態から同じ入力で
+ * シミュレーションし直すことで走行を再現します。クリアタイムやアイテム収集が
+ * 入力から実際に得られるものかを確かめる（不正な記録の検出）ためにも使います。
+ * ウィンドウ・描画・音声には依存しません。
+ */
+class InputReplaySystem {
+public:
+    /**
+     * @brief 再シミュレーションの結果
+     */
+    struct SimulationResult {
+        bool stageHashMatched = false;  // 読み込んだステージのハッシュが記録と一致した
+        bool goalReached = false;
+        size_t ticks = 0;               // 実行したティック数（ゴールした場合はゴールしたティックまで）
+        float clearTime = 0.0f;         // ゴール時のタイムアタックの経過時間（未到達の場合は最後のティックの時点）
+        int collectedItems = 0;
+        int requiredItems = 0;
+        glm::vec3 finalPosition = glm::vec3(0.0f);
+    };
+
+    /**
+     * @brief ステージの内容からハッシュを計算する
+     * @details プラットフォームの種類・位置・大きさ、アイテム、重力反転エリア、スイッチ、大砲の配置とプレイヤーの初期位置から
+     * FNV-1aで計算します。記録時と再シミュレーション時で同じステージかを確かめるために使います。
+     * ステージを読み込んだ直後（シミュレーションを進める前）に呼び出してください。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム
+     * @return ハッシュ値
+     */
+    static uint64_t hashStage(const GameState& gameState, const PlatformSystem& platformSystem);
+
+    /**
+     * @brief 移動方向を入力に設定する
+     * @details 水平方向（X・Z）を正規化して-127〜127に量子化します。長さが0なら移動なしになります。
+     *
+     * @param input 入力
+     * @param moveDirection ワールド座標系の移動方向
+     */
+    static void setMoveDirection(TickInput& input, const glm::vec3& moveDirection);
+
+    /**
+     * @brief 入力から移動方向を取得する
+     * @param input 入力
+     * @return 正規化された移動方向（移動なしの場合は0ベクトル）
+     */
+    static glm::vec3 getMoveDirection(const TickInput& input);
+
+    /**
+     * @brief 入力の記録を開始する
+     * @details ステージ番号、ステージハッシュ、モードを記録し、入力列を空にします。
+     * ティックレートは最初のrecord()で決まります。
+     *
+     * @param replay 記録先の入力リプレイ
+     * @param gameState ゲーム状態（タイムアタック開始時点）
+     * @param platformSystem プラットフォームシステム
+     * @param stageNumber ステージ番号
+     */
+    static void begin(InputReplay& replay, const GameState& gameState, const PlatformSystem& platformSystem, int stageNumber);
+
+    /**
+     * @brief 1ティック分の入力を記録する
+     * @details デルタタイムが最初のティックと異なる場合（可変タイムステップで実行している場合など）は、
+     * 再シミュレーションで再現できないためfalseを返します。
+     *
+     * @param replay 記録先の入力リプレイ
+     * @param input 1ティック分の入力
+     * @param deltaTime このティックのデルタタイム
+     * @return 記録できた場合true
+     */
+    static bool record(InputReplay& replay, const TickInput& input, float deltaTime);
+
+    /**
+     * @brief 入力リプレイを再シミュレーションする
+     * @details replay.stageNumberのステージを読み込み済みのgameStateとplatformSystemに対して、
+     * タイムアタックとして入力を1ティックずつ与えます。ゴールした時点で終了します。
+     * ステージハッシュが一致しない場合はシミュレーションせずに返します。
+     *
+     * @param replay 入力リプレイ
+     * @param gameState ゲーム状態（ステージ読み込み直後）
+     * @param platformSystem プラットフォームシステム（ステージ読み込み直後）
+     * @param events シミュレーションイベント
+     * @return 再シミュレーションの結果
+     */
+    static SimulationResult simulate(const InputReplay& replay, GameState& gameState, PlatformSystem& platformSystem,
+                                     const SimulationEvents& events = SimulationEvents());
+};
@@ -0,0 +1,172 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "leaderboard_cache.h"
+#include "online_leaderboard_manager.h"
+#include <nlohmann/json.hpp>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace {
+    constexpr int CACHE_FORMAT_VERSION = 1;
+    constexpr const char* CACHE_FILE_NAME = "leaderboard_cache.json";
+
+    struct CachedBoard {
+        std::vector<LeaderboardEntry> entries;
+        std::string etag;
+        int64_t fetchedAt = 0;  // 取得・再検証した時刻（UNIX時間、秒）
+    };
+
+    std::map<int, CachedBoard> boards;
+    bool loaded = false;
+    bool dirty = false;  // ファイルに保存していない変更があるか（flush()でまとめて保存する）
+
+    int64_t now() {
+        return static_cast<int64_t>(std::time(nullptr));
+    }
+
+    std::string getCacheFilePath() {
+        std::error_code error;
+        if (!std::filesystem::is_directory("assets/save", error) && std::filesystem::is_directory("../assets/save", error)) {
+            return std::string("../assets/save/") + CACHE_FILE_NAME;
+        }
+        return std::string("assets/save/") + CACHE_FILE_NAME;
+    }
+
+    void load() {
+        loaded = true;
+        std::ifstream file(getCacheFilePath());
+        if (!file.is_open()) {
+            return;
+        }
+
+        try {
+            nlohmann::json json;
+            file >> json;
+            if (json.value("version", 0) != CACHE_FORMAT_VERSION || !json.contains("stages") || !json["stages"].is_object()) {
+                return;
+            }
+            for (auto& [key, value] : json["stages"].items()) {
+                CachedBoard board;
+                board.etag = value.value("etag", "");
+                board.fetchedAt = value.value("fetchedAt", static_cast<int64_t>(0));
+                for (const auto& record : value.value("records", nlohmann::json::array())) {
+                    LeaderboardEntry entry;
+                    entry.id = record.value("id", 0);
+                    entry.stageNumber = std::stoi(key);
+                    entry.playerName = record.value("playerName", "");
+                    entry.time = record.value("time", 0.0f);
+                    entry.timestamp = record.value("timestamp", "");
+                    entry.hasReplay = record.value("hasReplay", false);
+                    board.entries.push_back(entry);
+                }
+                boards[std::stoi(key)] = std::move(board);
+            }
+            printf("ONLINE: Loaded leaderboard cache (%zu stages)\n", boards.size());
+        } catch (const std::exception& e) {
+            std::cerr << "Leaderboard cache: Failed to parse JSON: " << e.what() << std::endl;
+            boards.clear();
+        }
+    }
+
+    void save() {
+        nlohmann::json stages = nlohmann::json::object();
+        for (const auto& [stageNumber, board] : boards) {
+            nlohmann::json records = nlohmann::json::array();
+            for (const auto& entry : board.entries) {
+                records.push_back({
+                    {"id", entry.id},
+                    {"playerName", entry.playerName},
+                    {"time", entry.time},
+                    {"timestamp", entry.timestamp},
+                    {"hasReplay", entry.hasReplay}
+                });
+            }
+            stages[std::to_string(stageNumber)] = {
+                {"etag", board.etag},
+                {"fetchedAt", board.fetchedAt},
+                {"records", records}
+            };
+        }
+        nlohmann::json json;
+        json["version"] = CACHE_FORMAT_VERSION;
+        json["stages"] = stages;
+
+        // 書き込み途中で終了しても壊れないよう、一時ファイルに書いてから置き換える
+        std::string path = getCacheFilePath();
+        std::string tempPath = path + ".tmp";
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "Leaderboard cache: Failed to open for writing: " << tempPath << std::endl;
+                return;
+            }
+            file << json.dump();
+            if (!file) {
+                return;
+            }
+        }
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            std::cerr << "Leaderboard cache: Failed to replace " << path << ": " << error.message() << std::endl;
+        }
+    }
+
+    CachedBoard* find(int stageNumber) {
+        if (!loaded) {
+            load();
+        }
+        auto it = boards.find(stageNumber);
+        return it == boards.end() ? nullptr : &it->second;
+    }
+}
+
+bool LeaderboardCache::get(int stageNumber, std::vector<LeaderboardEntry>& entries, std::string& etag, bool& isFresh) {
+    const CachedBoard* board = find(stageNumber);
+    if (!board) {
+        return false;
+    }
+    entries = board->entries;
+    etag = board->etag;
+    int64_t age = now() - board->fetchedAt;
+    isFresh = age >= 0 && age < FRESH_SECONDS;
+    return true;
+}
+
+void LeaderboardCache::store(int stageNumber, const std::vector<LeaderboardEntry>& entries, const std::string& etag) {
+    find(stageNumber);
+    CachedBoard& board = boards[stageNumber];
+    board.entries = entries;
+    board.etag = etag;
+    board.fetchedAt = now();
+    dirty = true;
+}
+
+void LeaderboardCache::touch(int stageNumber) {
+    CachedBoard* board = find(stageNumber);
+    if (board) {
+        board->fetchedAt = now();
+        dirty = true;
+    }
+}
+
+void LeaderboardCache::invalidate(int stageNumber) {
+    CachedBoard* board = find(stageNumber);
+    if (board) {
+        board->fetchedAt = 0;
+        dirty = true;
+    }
+}
+
+void LeaderboardCache::flush() {
+    if (dirty) {
+        dirty = false;
+        save();
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * @file leaderboard_cache.h
+ * @brief ランキングのキャッシュ
+ * @details ステージ別ランキングをメモリとファイルに保存し、ETagで再検証します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct LeaderboardEntry;
+
+/**
+ * @brief ランキングのキャッシュ
+ * @details 取得したステージ別ランキングを解析済みのエントリのままメモリに保持し、
+ * assets/save/leaderboard_cache.jsonにも保存して次回の起動時に使います。
+ *
+ * 取得からFRESH_SECONDS以内のランキングは通信せずにそのまま使い、それより古いランキングは表示に使いつつ
+ * （stale-while-revalidate）、保存したETagをIf-None-Matchに付けて再検証します。
+ *
+ * 変更はメモリだけに反映し、ファイルにはflush()でまとめて保存します（1回のCompletionQueue::drain()で
+ * 複数のランキングが届いても書き込みは1回になります）。
+ *
+ * メインスレッドだけから呼び出します（通信スレッドの結果はCompletionQueueでメインスレッドに渡してから保存します）。
+ */
+class LeaderboardCache {
+public:
+    static constexpr int64_t FRESH_SECONDS = 30;  /**< @brief 再検証せずに使う期間（秒） */
+
+    /**
+     * @brief キャッシュしたランキングを取得する
+     * @param stageNumber ステージ番号
+     * @param entries 出力: エントリ
+     * @param etag 出力: ETag（ない場合は空）
+     * @param isFresh 出力: FRESH_SECONDS以内に取得・再検証したものならtrue
+     * @return キャッシュがあればtrue
+     */
+    static bool get(int stageNumber, std::vector<LeaderboardEntry>& entries, std::string& etag, bool& isFresh);
+
+    /**
+     * @brief 取得したランキングを保存する
+     * @param stageNumber ステージ番号
+     * @param entries エントリ
+     * @param etag ETag（ない場合は空）
+     */
+    static void store(int stageNumber, const std::vector<LeaderboardEntry>& entries, const std::string& etag);
+
+    /**
+     * @brief 再検証で変わっていなかった（304）ランキングを新しいものとして扱う
+     * @param stageNumber ステージ番号
+     */
+    static void touch(int stageNumber);
+
+    /**
+     * @brief ランキングを古いものとして扱う
+     * @details 記録を送信した後など、次の取得で必ず再検証させたい場合に呼び出します（表示には引き続き使います）。
+     * @param stageNumber ステージ番号
+     */
+    static void invalidate(int stageNumber);
+
+    /**
+     * @brief 保存していない変更があればファイルに保存する
+     * @details CompletionQueue::drain()の後と終了時に呼び出します。
+     */
+    static void flush();
+};
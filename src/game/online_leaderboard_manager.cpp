@@ -1,7 +1,11 @@
 #include "online_leaderboard_manager.h"
-#include <curl/curl.h>
+#include "replay_codec.h"
+#include "http_worker.h"
+#include "leaderboard_cache.h"
+#include "submission_queue.h"
+#include "../core/utils/completion_queue.h"
 #include <nlohmann/json.hpp>
-#include <thread>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -10,13 +14,7 @@
 std::string OnlineLeaderboardManager::baseUrl = "http://localhost:3000";
 std::string OnlineLeaderboardManager::playerName = "Player";
 bool OnlineLeaderboardManager::onlineEnabled = true;
-
-// libcurl用のコールバック関数
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* data) {
-    size_t totalSize = size * nmemb;
-    data->append((char*)contents, totalSize);
-    return totalSize;
-}
+std::vector<std::string> OnlineLeaderboardManager::friendNames;
 
 void OnlineLeaderboardManager::setBaseUrl(const std::string& url) {
     baseUrl = url;
@@ -36,6 +34,10 @@ bool OnlineLeaderboardManager::isOnlineEnabled() {
     return onlineEnabled;
 }
 
+bool OnlineLeaderboardManager::isFriend(const std::string& name) {
+    return std::find(friendNames.begin(), friendNames.end(), name) != friendNames.end();
+}
+
 bool OnlineLeaderboardManager::loadConfigFromFile() {
     // まずassets/config/leaderboard_config.jsonを試す（buildフォルダから実行される場合）
     std::string configPath = "../assets/config/leaderboard_config.json";
@@ -73,6 +75,16 @@ bool OnlineLeaderboardManager::loadConfigFromFile() {
             printf("Leaderboard Config: Online enabled: %s\n", onlineEnabled ? "true" : "false");
         }
         
+        if (jsonData.contains("friends") && jsonData["friends"].is_array()) {
+            friendNames.clear();
+            for (const auto& name : jsonData["friends"]) {
+                if (name.is_string()) {
+                    friendNames.push_back(name.get<std::string>());
+                }
+            }
+            printf("Leaderboard Config: %zu friends\n", friendNames.size());
+        }
+        
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Leaderboard Config: Failed to parse JSON: " << e.what() << std::endl;
@@ -81,68 +93,6 @@ bool OnlineLeaderboardManager::loadConfigFromFile() {
     }
 }
 
-bool OnlineLeaderboardManager::httpGet(const std::string& url, std::string& response) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        return false;
-    }
-    
-    response.clear();
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L); // 5秒タイムアウト
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 3L); // 3秒接続タイムアウト
-    
-    CURLcode res = curl_easy_perform(curl);
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK || httpCode != 200) {
-        std::cerr << "HTTP GET failed: " << curl_easy_strerror(res) << " (HTTP " << httpCode << ")" << std::endl;
-        return false;
-    }
-    
-    return true;
-}
-
-bool OnlineLeaderboardManager::httpPost(const std::string& url, const std::string& jsonData, std::string& response) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        return false;
-    }
-    
-    response.clear();
-    
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonData.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 3L);
-    
-    CURLcode res = curl_easy_perform(curl);
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK || httpCode != 200) {
-        std::cerr << "HTTP POST failed: " << curl_easy_strerror(res) << " (HTTP " << httpCode << ")" << std::endl;
-        return false;
-    }
-    
-    return true;
-}
-
 bool OnlineLeaderboardManager::parseLeaderboardJson(const std::string& jsonStr, std::vector<LeaderboardEntry>& entries) {
     try {
         auto json = nlohmann::json::parse(jsonStr);
@@ -151,10 +101,12 @@ bool OnlineLeaderboardManager::parseLeaderboardJson(const std::string& jsonStr,
             return false;
         }
         
+        int stageNumber = json.value("stageNumber", 0);
         entries.clear();
         for (const auto& record : json["records"]) {
             LeaderboardEntry entry;
             entry.id = record.value("id", 0);
+            entry.stageNumber = stageNumber;
             entry.playerName = record.value("playerName", "");
             entry.time = record.value("time", 0.0f);
             entry.timestamp = record.value("timestamp", "");
@@ -176,6 +128,47 @@ bool OnlineLeaderboardManager::parseLeaderboardJson(const std::string& jsonStr,
     }
 }
 
+bool OnlineLeaderboardManager::parseLeaderboardsJson(const std::string& jsonStr, std::vector<LeaderboardEntry>& entries,
+                                                     std::map<int, std::string>& etags) {
+    try {
+        auto json = nlohmann::json::parse(jsonStr);
+        
+        if (!json.contains("boards") || !json["boards"].is_array()) {
+            return false;
+        }
+        
+        size_t total = 0;
+        for (const auto& board : json["boards"]) {
+            total += board.contains("records") && board["records"].is_array() ? board["records"].size() : 0;
+        }
+        
+        entries.clear();
+        entries.reserve(total);
+        etags.clear();
+        for (const auto& board : json["boards"]) {
+            int stageNumber = board.value("stageNumber", 0);
+            if (stageNumber <= 0 || !board.contains("records") || !board["records"].is_array()) {
+                continue;
+            }
+            etags[stageNumber] = board.value("etag", "");
+            for (const auto& record : board["records"]) {
+                LeaderboardEntry& entry = entries.emplace_back();
+                entry.id = record.value("id", 0);
+                entry.stageNumber = stageNumber;
+                entry.playerName = record.value("playerName", "");
+                entry.time = record.value("time", 0.0f);
+                entry.timestamp = record.value("timestamp", "");
+                entry.hasReplay = record.value("hasReplay", false);
+            }
+        }
+        
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 bool OnlineLeaderboardManager::parseGlobalTopJson(const std::string& jsonStr, std::map<int, LeaderboardEntry>& topRecords) {
     try {
         auto json = nlohmann::json::parse(jsonStr);
@@ -202,7 +195,8 @@ bool OnlineLeaderboardManager::parseGlobalTopJson(const std::string& jsonStr, st
 }
 
 void OnlineLeaderboardManager::fetchLeaderboard(int stageNumber, 
-                                                 std::function<void(const std::vector<LeaderboardEntry>&)> callback) {
+                                                 std::function<void(const std::vector<LeaderboardEntry>&)> callback,
+                                                 const std::string& supersedeKey) {
     if (!onlineEnabled) {
         if (callback) {
             callback(std::vector<LeaderboardEntry>());
@@ -210,25 +204,124 @@ void OnlineLeaderboardManager::fetchLeaderboard(int stageNumber,
         return;
     }
     
-    // 別スレッドで非同期実行
-    std::thread([stageNumber, callback]() {
-        std::string url = baseUrl + "/api/leaderboard/" + std::to_string(stageNumber);
-        std::string response;
+    // キャッシュがあればすぐに表示し、新しければ通信しない
+    std::vector<LeaderboardEntry> cachedEntries;
+    std::string etag;
+    bool isFresh = false;
+    bool hasCache = LeaderboardCache::get(stageNumber, cachedEntries, etag, isFresh);
+    if (hasCache && callback) {
+        CompletionQueue::post([callback, cachedEntries]() {
+            callback(cachedEntries);
+        });
+    }
+    if (hasCache && isFresh) {
+        // 通信しない場合も、同じキーの古いリクエスト（前のステージなど）の結果は捨てる
+        HttpWorker::cancel(supersedeKey);
+        return;
+    }
+    
+    // 古いキャッシュは表示したまま、ETagで再検証する
+    HttpRequest request;
+    request.url = baseUrl + "/api/leaderboard/" + std::to_string(stageNumber);
+    request.supersedeKey = supersedeKey;
+    if (hasCache && !etag.empty()) {
+        request.headers.push_back("If-None-Match: " + etag);
+    }
+    request.onComplete = [stageNumber, callback, hasCache](const HttpResponse& response) {
+        if (response.superseded) {
+            return;  // 新しいリクエストに置き換えられた
+        }
+        
+        if (response.success && response.httpCode == 304) {
+            // 変わっていない（表示済みのキャッシュをそのまま使う）
+            CompletionQueue::post([stageNumber]() {
+                LeaderboardCache::touch(stageNumber);
+            });
+            return;
+        }
         
         std::vector<LeaderboardEntry> entries;
-        if (httpGet(url, response)) {
-            parseLeaderboardJson(response, entries);
+        bool parsed = response.success && parseLeaderboardJson(response.body, entries);
+        if (!parsed && hasCache) {
+            return;  // 失敗した場合は表示済みのキャッシュを使い続ける
         }
         
-        if (callback) {
-            callback(entries);
+        CompletionQueue::post([stageNumber, callback, parsed, etag = response.etag, entries = std::move(entries)]() {
+            if (parsed) {
+                LeaderboardCache::store(stageNumber, entries, etag);
+            }
+            if (callback) {
+                callback(entries);
+            }
+        });
+    };
+    HttpWorker::submit(std::move(request));
+}
+
+void OnlineLeaderboardManager::fetchLeaderboards(const std::vector<int>& stageNumbers,
+                                                  std::function<void(const std::vector<LeaderboardEntry>&)> callback) {
+    // キャッシュが新しいステージは通信しない
+    std::string staleStages;
+    for (int stageNumber : stageNumbers) {
+        std::vector<LeaderboardEntry> cachedEntries;
+        std::string etag;
+        bool isFresh = false;
+        if (!LeaderboardCache::get(stageNumber, cachedEntries, etag, isFresh) || !isFresh) {
+            staleStages += (staleStages.empty() ? "" : ",") + std::to_string(stageNumber);
+        }
+    }
+    
+    // 取得したステージはキャッシュに保存し、全ステージ分をキャッシュから集めて渡す
+    auto deliver = [stageNumbers, callback]() {
+        if (!callback) {
+            return;
+        }
+        std::vector<LeaderboardEntry> entries;
+        for (int stageNumber : stageNumbers) {
+            std::vector<LeaderboardEntry> cachedEntries;
+            std::string etag;
+            bool isFresh = false;
+            if (LeaderboardCache::get(stageNumber, cachedEntries, etag, isFresh)) {
+                entries.insert(entries.end(), cachedEntries.begin(), cachedEntries.end());
+            }
+        }
+        callback(entries);
+    };
+    
+    if (staleStages.empty() || !onlineEnabled) {
+        CompletionQueue::post(deliver);
+        return;
+    }
+    
+    HttpRequest request;
+    request.url = baseUrl + "/api/leaderboards?stages=" + staleStages;
+    request.onComplete = [deliver](const HttpResponse& response) {
+        std::vector<LeaderboardEntry> entries;
+        std::map<int, std::string> etags;
+        if (!response.success || !parseLeaderboardsJson(response.body, entries, etags)) {
+            printf("ONLINE: Failed to fetch leaderboards in one request\n");
+            etags.clear();
         }
-    }).detach();
+        
+        CompletionQueue::post([deliver, entries = std::move(entries), etags = std::move(etags)]() {
+            // 1つの配列をステージごとに分けて保存する（ステージの順に並んでいる）
+            for (const auto& [stageNumber, etag] : etags) {
+                auto begin = std::find_if(entries.begin(), entries.end(),
+                                     [stageNumber](const LeaderboardEntry& entry) { return entry.stageNumber == stageNumber; });
+                auto end = std::find_if(begin, entries.end(),
+                                        [stageNumber](const LeaderboardEntry& entry) { return entry.stageNumber != stageNumber; });
+                LeaderboardCache::store(stageNumber, std::vector<LeaderboardEntry>(begin, end), etag);
+            }
+            printf("ONLINE: Fetched %zu leaderboards (%zu entries) in one request\n", etags.size(), entries.size());
+            deliver();
+        });
+    };
+    HttpWorker::submit(std::move(request));
 }
 
 void OnlineLeaderboardManager::submitTime(int stageNumber, float time, 
                                           std::function<void(bool)> callback,
-                                          const ReplayData* replayData) {
+                                          ReplayData replayData) {
     if (!onlineEnabled) {
         if (callback) {
             callback(false);
@@ -236,96 +329,45 @@ void OnlineLeaderboardManager::submitTime(int stageNumber, float time,
         return;
     }
     
-    // 別スレッドで非同期実行
-    std::thread([stageNumber, time, callback, replayData]() {
-        std::string url = baseUrl + "/api/leaderboard";
-        
-        // プレイヤー名を処理（空または非ASCII文字のみの場合は"UNKNOWN"に変換、大文字に変換）
-        std::string processedPlayerName = playerName;
-        printf("ONLINE: Submitting time - original playerName: [%s] (length: %zu)\n", 
-               playerName.c_str(), playerName.length());
-        if (processedPlayerName.empty()) {
-            processedPlayerName = "UNKNOWN";
-        } else {
-            // ASCII文字のみを抽出し、大文字に変換
-            std::string asciiName;
-            for (char c : processedPlayerName) {
-                if (c >= 32 && c <= 126) { // ASCII文字範囲
-                    // 小文字を大文字に変換
-                    if (c >= 'a' && c <= 'z') {
-                        asciiName += (c - 'a' + 'A');
-                    } else {
-                        asciiName += c;
-                    }
+    // プレイヤー名を処理（空または非ASCII文字のみの場合は"UNKNOWN"に変換、大文字に変換）
+    std::string processedPlayerName = playerName;
+    printf("ONLINE: Submitting time - original playerName: [%s] (length: %zu)\n", 
+           playerName.c_str(), playerName.length());
+    if (processedPlayerName.empty()) {
+        processedPlayerName = "UNKNOWN";
+    } else {
+        // ASCII文字のみを抽出し、大文字に変換
+        std::string asciiName;
+        for (char c : processedPlayerName) {
+            if (c >= 32 && c <= 126) { // ASCII文字範囲
+                // 小文字を大文字に変換
+                if (c >= 'a' && c <= 'z') {
+                    asciiName += (c - 'a' + 'A');
+                } else {
+                    asciiName += c;
                 }
             }
-            
-            if (asciiName.empty()) {
-                // ASCII文字が1つもない場合は"UNKNOWN"に変換
-                processedPlayerName = "UNKNOWN";
-            } else {
-                processedPlayerName = asciiName;
-            }
         }
         
-        nlohmann::json jsonData;
-        jsonData["stageNumber"] = stageNumber;
-        jsonData["time"] = time;
-        jsonData["playerName"] = processedPlayerName;
-        
-        // リプレイデータがあれば追加
-        if (replayData != nullptr) {
-            printf("ONLINE: Processing replay data - stage: %d, clearTime: %.2f, frames: %zu\n",
-                   replayData->stageNumber, replayData->clearTime, replayData->frames.size());
-            nlohmann::json replayJson;
-            replayJson["stageNumber"] = replayData->stageNumber;
-            replayJson["clearTime"] = replayData->clearTime;
-            replayJson["recordedDate"] = replayData->recordedDate;
-            replayJson["frameRate"] = replayData->frameRate;
-            
-            nlohmann::json framesArray = nlohmann::json::array();
-            for (const auto& frame : replayData->frames) {
-                nlohmann::json frameJson;
-                frameJson["timestamp"] = frame.timestamp;
-                frameJson["playerPosition"] = {frame.playerPosition.x, frame.playerPosition.y, frame.playerPosition.z};
-                frameJson["playerVelocity"] = {frame.playerVelocity.x, frame.playerVelocity.y, frame.playerVelocity.z};
-                frameJson["timeScale"] = frame.timeScale;
-                if (!frame.itemCollectedStates.empty()) {
-                    frameJson["itemCollectedStates"] = frame.itemCollectedStates;
-                }
-                framesArray.push_back(frameJson);
-            }
-            replayJson["frames"] = framesArray;
-            jsonData["replayData"] = replayJson;
-            
-            printf("ONLINE: Submitting time with replay data (%zu frames, JSON size will be large)\n", replayData->frames.size());
-            printf("ONLINE: Replay JSON frames array size: %zu\n", framesArray.size());
+        if (asciiName.empty()) {
+            // ASCII文字が1つもない場合は"UNKNOWN"に変換
+            processedPlayerName = "UNKNOWN";
         } else {
-            printf("ONLINE: No replay data provided (replayData is nullptr)\n");
-        }
-        
-        printf("ONLINE: Submitting time - processed playerName: [%s] (length: %zu)\n", 
-               processedPlayerName.c_str(), processedPlayerName.length());
-        
-        std::string jsonStr = jsonData.dump();
-        printf("ONLINE: JSON payload size: %zu bytes\n", jsonStr.length());
-        std::string response;
-        
-        bool success = httpPost(url, jsonStr, response);
-        
-        if (success) {
-            try {
-                auto json = nlohmann::json::parse(response);
-                success = json.value("success", false);
-            } catch (...) {
-                success = false;
-            }
+            processedPlayerName = asciiName;
         }
-        
-        if (callback) {
-            callback(success);
-        }
-    }).detach();
+    }
+    printf("ONLINE: Submitting time - processed playerName: [%s] (length: %zu)\n", 
+           processedPlayerName.c_str(), processedPlayerName.length());
+    
+    // ファイルへの保存と送信は送信キューのスレッドで行う（クリア画面で通信を待たない）
+    SubmissionQueue::start(baseUrl + "/api/leaderboard");
+    SubmissionQueue::enqueue(stageNumber, time, processedPlayerName, std::move(replayData), std::move(callback));
+}
+
+void OnlineLeaderboardManager::resumeSubmissions() {
+    if (onlineEnabled) {
+        SubmissionQueue::start(baseUrl + "/api/leaderboard");
+    }
 }
 
 void OnlineLeaderboardManager::fetchReplay(int leaderboardId,
@@ -337,102 +379,56 @@ void OnlineLeaderboardManager::fetchReplay(int leaderboardId,
         return;
     }
     
-    // 別スレッドで非同期実行
-    std::thread([leaderboardId, callback]() {
-        std::string url = baseUrl + "/api/replay/" + std::to_string(leaderboardId);
-        std::string response;
+    auto download = std::make_shared<ReplayDownload>();
+    HttpRequest request;
+    request.url = baseUrl + "/api/replay/" + std::to_string(leaderboardId);
+    request.timeoutSeconds = 0;
+    request.onData = [download](const char* data, size_t size) {
+        return download->append(data, size);
+    };
+    request.onComplete = [leaderboardId, callback, download](const HttpResponse& response) {
+        download->finish(response.success);
         
-        ReplayData* replayData = nullptr;
-        if (httpGet(url, response)) {
-            try {
-                printf("ONLINE: Received response for replay ID %d, length: %zu\n", leaderboardId, response.length());
-                auto json = nlohmann::json::parse(response);
-                printf("ONLINE: Parsed JSON - success: %s, has replayData: %s\n",
-                       json.value("success", false) ? "true" : "false",
-                       json.contains("replayData") ? "true" : "false");
-                
-                if (json.value("success", false) && json.contains("replayData")) {
-                    replayData = new ReplayData();
-                    const auto& replayJson = json["replayData"];
-                    
-                    printf("ONLINE: Replay JSON keys: ");
-                    for (auto it = replayJson.begin(); it != replayJson.end(); ++it) {
-                        printf("%s ", it.key().c_str());
-                    }
-                    printf("\n");
-                    
-                    replayData->stageNumber = replayJson.value("stageNumber", 0);
-                    replayData->clearTime = replayJson.value("clearTime", 0.0f);
-                    replayData->recordedDate = replayJson.value("recordedDate", "");
-                    replayData->frameRate = replayJson.value("frameRate", 0.1f);
-                    
-                    printf("ONLINE: Replay metadata - stage: %d, clearTime: %.2f, frameRate: %.2f\n",
-                           replayData->stageNumber, replayData->clearTime, replayData->frameRate);
-                    printf("ONLINE: Checking for frames - has frames key: %s, is array: %s\n",
-                           replayJson.contains("frames") ? "true" : "false",
-                           (replayJson.contains("frames") && replayJson["frames"].is_array()) ? "true" : "false");
-                    
-                    if (replayJson.contains("frames") && replayJson["frames"].is_array()) {
-                        printf("ONLINE: Frames array size: %zu\n", replayJson["frames"].size());
-                        for (const auto& frameJson : replayJson["frames"]) {
-                            ReplayFrame frame;
-                            frame.timestamp = frameJson.value("timestamp", 0.0f);
-                            
-                            if (frameJson.contains("playerPosition") && frameJson["playerPosition"].is_array() && frameJson["playerPosition"].size() == 3) {
-                                frame.playerPosition.x = frameJson["playerPosition"][0];
-                                frame.playerPosition.y = frameJson["playerPosition"][1];
-                                frame.playerPosition.z = frameJson["playerPosition"][2];
-                            }
-                            
-                            if (frameJson.contains("playerVelocity") && frameJson["playerVelocity"].is_array() && frameJson["playerVelocity"].size() == 3) {
-                                frame.playerVelocity.x = frameJson["playerVelocity"][0];
-                                frame.playerVelocity.y = frameJson["playerVelocity"][1];
-                                frame.playerVelocity.z = frameJson["playerVelocity"][2];
-                            }
-                            
-                            // timeScaleは後方互換性のため、存在しない場合は1.0fをデフォルト値とする
-                            frame.timeScale = frameJson.contains("timeScale") ? frameJson["timeScale"].get<float>() : 1.0f;
-                            
-                            if (frameJson.contains("itemCollectedStates") && frameJson["itemCollectedStates"].is_array()) {
-                                for (const auto& state : frameJson["itemCollectedStates"]) {
-                                    frame.itemCollectedStates.push_back(state.get<bool>());
-                                }
-                            }
-                            
-                            replayData->frames.push_back(frame);
-                        }
-                        printf("ONLINE: Processed %zu frames from JSON\n", replayData->frames.size());
-                    } else {
-                        printf("ONLINE: WARNING - No frames array found in replay JSON\n");
-                    }
-                    
-                    printf("ONLINE: Loaded replay data for leaderboard ID %d (%zu frames)\n", 
-                           leaderboardId, replayData->frames.size());
-                    if (!replayData->frames.empty()) {
-                        printf("ONLINE: First frame - timestamp: %.2f, position: (%.2f, %.2f, %.2f), velocity: (%.2f, %.2f, %.2f)\n",
-                               replayData->frames[0].timestamp,
-                               replayData->frames[0].playerPosition.x,
-                               replayData->frames[0].playerPosition.y,
-                               replayData->frames[0].playerPosition.z,
-                               replayData->frames[0].playerVelocity.x,
-                               replayData->frames[0].playerVelocity.y,
-                               replayData->frames[0].playerVelocity.z);
-                    }
-                }
-            } catch (const std::exception& e) {
-                std::cerr << "Failed to parse replay JSON: " << e.what() << std::endl;
-            }
+        std::shared_ptr<ReplayData> replayData;
+        if (download->isComplete()) {
+            replayData = std::make_shared<ReplayData>(download->getHeader());
+            download->takeFrames(replayData->frames);
+            printf("ONLINE: Loaded replay data for leaderboard ID %d (%zu frames, %zu bytes)\n",
+                   leaderboardId, replayData->frames.size(), download->getReceivedBytes());
+        } else {
+            printf("ONLINE: Failed to load replay data for leaderboard ID %d\n", leaderboardId);
         }
         
+        // コールバックの後に解放する（コールバックでコピーを作成する想定）
         if (callback) {
-            callback(replayData);
+            CompletionQueue::post([callback, replayData]() {
+                callback(replayData.get());
+            });
         }
-        
-        // メモリを解放（コールバックでコピーを作成する想定）
-        if (replayData) {
-            delete replayData;
-        }
-    }).detach();
+    };
+    HttpWorker::submit(std::move(request));
+}
+
+void OnlineLeaderboardManager::fetchReplayStream(int leaderboardId, std::shared_ptr<ReplayDownload> download) {
+    if (!onlineEnabled) {
+        download->finish(false);
+        return;
+    }
+    
+    // 大きなリプレイを遅い回線で受信できるよう、全体の時間ではなく受信速度で打ち切る
+    HttpRequest request;
+    request.url = baseUrl + "/api/replay/" + std::to_string(leaderboardId);
+    request.timeoutSeconds = 0;
+    request.onData = [download](const char* data, size_t size) {
+        return download->append(data, size);
+    };
+    request.onComplete = [leaderboardId, download](const HttpResponse& response) {
+        download->finish(response.success);
+        printf("ONLINE: Replay stream for leaderboard ID %d finished: %s (%zu bytes)\n", leaderboardId,
+               download->isComplete() ? "complete" : (download->isCancelled() ? "cancelled" : "failed"),
+               download->getReceivedBytes());
+    };
+    HttpWorker::submit(std::move(request));
 }
 
 void OnlineLeaderboardManager::fetchGlobalTopRecords(
@@ -444,19 +440,25 @@ void OnlineLeaderboardManager::fetchGlobalTopRecords(
         return;
     }
     
-    // 別スレッドで非同期実行
-    std::thread([callback]() {
-        std::string url = baseUrl + "/api/leaderboard/global/top";
-        std::string response;
-        
+    HttpRequest request;
+    request.url = baseUrl + "/api/leaderboard/global/top";
+    request.onComplete = [callback](const HttpResponse& response) {
         std::map<int, LeaderboardEntry> topRecords;
-        if (httpGet(url, response)) {
-            parseGlobalTopJson(response, topRecords);
+        if (response.success) {
+            parseGlobalTopJson(response.body, topRecords);
         }
         
         if (callback) {
-            callback(topRecords);
+            CompletionQueue::post([callback, topRecords = std::move(topRecords)]() {
+                callback(topRecords);
+            });
         }
-    }).detach();
+    };
+    HttpWorker::submit(std::move(request));
 }
 
+void OnlineLeaderboardManager::shutdown() {
+    SubmissionQueue::shutdown();
+    HttpWorker::shutdown();
+    LeaderboardCache::flush();
+}
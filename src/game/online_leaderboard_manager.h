@@ -13,7 +13,9 @@
 #include <vector>
 #include <map>
 #include <functional>
+#include <memory>
 #include "replay_state.h"
+#include "replay_download.h"
 
 /**
  * @brief ランキングエントリ
@@ -21,6 +23,7 @@
  */
 struct LeaderboardEntry {
     int id = 0;  /**< @brief ランキングエントリID（リプレイ取得用） */
+    int stageNumber = 0;  /**< @brief ステージ番号 */
     std::string playerName;  /**< @brief プレイヤー名 */
     float time;  /**< @brief クリアタイム（秒） */
     std::string timestamp;  /**< @brief 記録日時 */
@@ -30,7 +33,8 @@ struct LeaderboardEntry {
 /**
  * @brief オンラインランキングマネージャー
  * @details オンラインランキングAPIとの通信を管理します。
- * タイムアタック記録の送信とランキングデータの取得を非同期で行います。
+ * タイムアタック記録の送信とランキングデータの取得を非同期で行います。通信とレスポンスの解析はHttpWorkerのスレッドで行い、
+ * コールバックはメインスレッドでCompletionQueue::drain()から呼ばれます（コールバックからGameStateを直接変更できます）。
  */
 class OnlineLeaderboardManager {
 public:
@@ -59,25 +63,52 @@ public:
     /**
      * @brief ステージ別ランキングを取得する
      * @details 非同期でAPIからランキングデータを取得します。
+     * LeaderboardCacheにキャッシュがある場合は、まずキャッシュしたエントリでコールバックを呼びます。
+     * キャッシュが古い場合はETagで再検証し、変わっていた場合だけもう一度コールバックを呼びます
+     * （変わっていない場合や、キャッシュがあって通信に失敗した場合は呼びません）。
+     * supersedeKeyを指定した場合、同じキーでまだ終わっていない取得は取り消し、そのコールバックは呼び出しません
+     * （ランキングUIでステージを素早く切り替えた場合など）。
      * 
      * @param stageNumber ステージ番号（1-5）
      * @param callback 取得完了時のコールバック関数（成功時: entries, 失敗時: 空配列）
+     * @param supersedeKey 置き換えのキー（空の場合は置き換えない）
      */
     static void fetchLeaderboard(int stageNumber, 
-                                 std::function<void(const std::vector<LeaderboardEntry>&)> callback);
+                                 std::function<void(const std::vector<LeaderboardEntry>&)> callback,
+                                 const std::string& supersedeKey = "");
+    
+    /**
+     * @brief 複数のステージ別ランキングをまとめて取得する
+     * @details 新しいキャッシュがないステージのランキングだけを1回の通信でまとめて取得し、LeaderboardCacheに保存します。
+     * ステージ選択フィールドに入ったときに呼び出しておくと、以降のfetchLeaderboardはキャッシュから返ります。
+     * 
+     * @param stageNumbers ステージ番号
+     * @param callback 取得完了時のコールバック関数（任意）。全ステージのエントリをステージの順、順位の順に並べた
+     * 1つの配列で渡します（各エントリのstageNumberでステージを区別する。取得できなかったステージは古いキャッシュか、なければ含まない）
+     */
+    static void fetchLeaderboards(const std::vector<int>& stageNumbers,
+                                  std::function<void(const std::vector<LeaderboardEntry>&)> callback = nullptr);
     
     /**
      * @brief タイム記録を送信する
-     * @details 非同期でAPIにタイム記録を送信します。
+     * @details 記録をSubmissionQueueに追加し、すぐに戻ります。記録はファイルに保存してから送信し、
+     * 通信できない場合は次回の起動後も含めて再送します。
      * 
      * @param stageNumber ステージ番号（1-5）
      * @param time クリアタイム（秒）
-     * @param callback 送信完了時のコールバック関数（成功時: true, 失敗時: false）
-     * @param replayData リプレイデータ（オプション、nullptrの場合は送信しない）
+     * @param callback 送信完了時のコールバック関数（受け付けられた場合: true, 拒否された場合や
+     * より速い記録に置き換えた場合: false。通信できない間は呼び出さない）
+     * @param replayData リプレイデータ（フレームが空の場合はリプレイなしで送信する）
      */
     static void submitTime(int stageNumber, float time, 
                           std::function<void(bool)> callback = nullptr,
-                          const ReplayData* replayData = nullptr);
+                          ReplayData replayData = ReplayData());
+    
+    /**
+     * @brief 前回までに送信できなかった記録の送信を再開する
+     * @details 設定ファイルを読み込んだ後に呼び出します。オンライン機能が無効の場合は何もしません。
+     */
+    static void resumeSubmissions();
     
     /**
      * @brief リプレイデータを取得する
@@ -89,6 +120,17 @@ public:
     static void fetchReplay(int leaderboardId,
                            std::function<void(const ReplayData*)> callback);
     
+    /**
+     * @brief リプレイデータを受信しながら復元する
+     * @details 非同期でAPIからリプレイデータを取得し、受信した分からdownloadでフレームを復元します。
+     * メインスレッドはdownloadから復元済みのフレームを受け取り、全体の受信を待たずに再生を始められます。
+     * download->cancel()で受信を中断します。
+     * 
+     * @param leaderboardId ランキングエントリID
+     * @param download 受信先
+     */
+    static void fetchReplayStream(int leaderboardId, std::shared_ptr<ReplayDownload> download);
+    
     /**
      * @brief 全ステージのトップ記録を取得する
      * @details 非同期でAPIから全ステージのトップ記録を取得します。
@@ -106,44 +148,54 @@ public:
      */
     static bool isOnlineEnabled();
     
+    /**
+     * @brief フレンドかどうかを確認する
+     * @details leaderboard_config.jsonのfriends（プレイヤー名の配列）に含まれるかで判定します。
+     * 
+     * @param name プレイヤー名
+     * @return フレンドの場合true
+     */
+    static bool isFriend(const std::string& name);
+    
     /**
      * @brief 設定ファイルから設定を読み込む
-     * @details assets/config/leaderboard_config.jsonからbaseUrlとenabledを読み込みます。
+     * @details assets/config/leaderboard_config.jsonからbaseUrl、enabled、friendsを読み込みます。
      * ファイルが見つからない場合はデフォルト値（localhost:3000）を使用します。
      * 
      * @return 設定ファイルの読み込みに成功した場合true
      */
     static bool loadConfigFromFile();
+    
+    /**
+     * @brief 通信を終了する
+     * @details 送信キューに追加済みの記録をファイルに書き終えてから、処理中のリクエストを中断し、通信スレッドを終了し、ランキングのキャッシュを保存します。
+     * アプリケーションの終了時に呼び出します。
+     */
+    static void shutdown();
 
 private:
     static std::string baseUrl;  /**< @brief APIベースURL */
     static std::string playerName;  /**< @brief プレイヤー名 */
     static bool onlineEnabled;  /**< @brief オンライン機能が有効かどうか */
+    static std::vector<std::string> friendNames;  /**< @brief フレンドのプレイヤー名 */
     
     /**
-     * @brief HTTP GETリクエストを送信する
-     * @param url リクエストURL
-     * @param response レスポンスデータを受け取る文字列
-     * @return 成功時true
-     */
-    static bool httpGet(const std::string& url, std::string& response);
-    
-    /**
-     * @brief HTTP POSTリクエストを送信する
-     * @param url リクエストURL
-     * @param jsonData JSONデータ
-     * @param response レスポンスデータを受け取る文字列
+     * @brief JSON文字列をLeaderboardEntryのベクターに変換する
+     * @param jsonStr JSON文字列
+     * @param entries 変換結果を受け取るベクター
      * @return 成功時true
      */
-    static bool httpPost(const std::string& url, const std::string& jsonData, std::string& response);
+    static bool parseLeaderboardJson(const std::string& jsonStr, std::vector<LeaderboardEntry>& entries);
     
     /**
-     * @brief JSON文字列をLeaderboardEntryのベクターに変換する
+     * @brief まとめて取得したランキングのJSON文字列を1つの配列に変換する
      * @param jsonStr JSON文字列
-     * @param entries 変換結果を受け取るベクター
+     * @param entries 変換結果を受け取るベクター（ステージの順、順位の順）
+     * @param etags 変換結果: ステージごとのETag
      * @return 成功時true
      */
-    static bool parseLeaderboardJson(const std::string& jsonStr, std::vector<LeaderboardEntry>& entries);
+    static bool parseLeaderboardsJson(const std::string& jsonStr, std::vector<LeaderboardEntry>& entries,
+                                      std::map<int, std::string>& etags);
     
     /**
      * @brief JSON文字列をグローバルトップ記録のマップに変換する
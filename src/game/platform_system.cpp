@@ -8,7 +8,6 @@
 #include <algorithm>
 #include <iostream>
 #include <cmath>
-#include <glm/gtc/matrix_transform.hpp>
 
 void PlatformSystem::update(float deltaTime, const glm::vec3& playerPos, float absoluteTime, float timeScale) {
     // リプレイモードでは、absoluteTimeは既に各フレーム区間のtimeScaleを考慮した累積ゲーム時間
@@ -16,7 +15,10 @@ void PlatformSystem::update(float deltaTime, const glm::vec3& playerPos, float a
     float actualTime = absoluteTime;
     // timeScaleパラメータは使用しない（リプレイモードでは既に考慮済み）
     
-    for (auto& platform : platforms) {
+    bool spatialIndexValid = !spatialIndexDirty && spatialEntries.size() == platforms.size();
+    
+    for (int i = 0; i < static_cast<int>(platforms.size()); i++) {
+        auto& platform = platforms[i];
         std::visit(overloaded{
             [this, deltaTime, actualTime, absoluteTime](StaticPlatform& p) { updateStaticPlatform(p, deltaTime); },
             [this, deltaTime, actualTime, absoluteTime, &playerPos](MovingPlatform& p) { 
@@ -52,26 +54,109 @@ void PlatformSystem::update(float deltaTime, const glm::vec3& playerPos, float a
             [this, deltaTime, actualTime, absoluteTime](DisappearingPlatform& p) { updateDisappearingPlatform(p, deltaTime); },
             [this, deltaTime, actualTime, absoluteTime, &playerPos](FlyingPlatform& p) { updateFlyingPlatform(p, deltaTime, playerPos); }
         }, platform);
+        
+        // 更新直後（バリアントがキャッシュにある間）に衝突判定用の境界ボックスへ反映する
+        if (spatialIndexValid) {
+            writeCollisionBounds(i);
+        }
+    }
+    
+    // 動的ツリーは移動するプラットフォームのみ更新する（太らせた境界ボックスからはみ出した場合のみ再挿入）
+    if (spatialIndexValid) {
+        for (int index : dynamicPlatforms) {
+            SpatialEntry& entry = spatialEntries[index];
+            computeSpatialBounds(platforms[index], entry.boundsMin, entry.boundsMax);
+            dynamicTree.moveProxy(entry.dynamicProxyId, entry.boundsMin, entry.boundsMax,
+                                  GameConstants::PhysicsConstants::BROADPHASE_FAT_MARGIN);
+        }
     }
 }
 
 std::pair<PlatformVariant*, int> PlatformSystem::checkCollisionWithIndex(const glm::vec3& playerPos, const glm::vec3& playerSize) {
-    for (int i = 0; i < platforms.size(); i++) {
+    collectCollisionCandidates(playerPos - playerSize * 0.5f, playerPos + playerSize * 0.5f);
+    
+    // 候補は昇順なので、全走査時と同じく最も小さいインデックスの衝突を返す
+    // 回転プラットフォーム以外は境界ボックスの判定がそのまま衝突判定になる
+    for (int i : candidateScratch) {
         auto& platform = platforms[i];
-        bool collision = std::visit(overloaded{
-            [this, &playerPos, &playerSize](const RotatingPlatform& p) {
-                return checkCollisionWithRotatingPlatform(p, playerPos, playerSize);
+        if (const auto* rotating = std::get_if<RotatingPlatform>(&platform)) {
+            if (!checkCollisionWithRotatingPlatform(*rotating, playerPos, playerSize)) continue;
+        }
+        return {&platform, i};
+    }
+    return {nullptr, -1};
+}
+
+std::pair<PlatformVariant*, int> PlatformSystem::sweepCollisionWithIndex(const glm::vec3& playerPos, const glm::vec3& playerSize,
+                                                                         const glm::vec3& displacement, float& outTime) {
+    glm::vec3 playerMin = playerPos - playerSize * 0.5f;
+    glm::vec3 playerMax = playerPos + playerSize * 0.5f;
+    collectCollisionCandidates(glm::min(playerMin, playerMin + displacement), glm::max(playerMax, playerMax + displacement));
+    
+    // 接触時刻が最も早いもの（同時刻なら小さいインデックス）を返す
+    int hitIndex = -1;
+    float hitTime = 0.0f;
+    for (int i : candidateScratch) {
+        float time = 0.0f;
+        bool hit = std::visit(overloaded{
+            [&](const RotatingPlatform& p) {
+                // 上面の平面に達する時刻を求め、その位置で実際に面の範囲内にいるかをOBBで確認する
+                if (!p.orientedBox.sweepTopPlane(playerMin, playerMax, displacement, time)) return false;
+                glm::vec3 contactOffset = displacement * time;
+                return p.orientedBox.overlapsAABB(playerMin + contactOffset, playerMax + contactOffset);
             },
-            [this, &playerPos, &playerSize](const auto& p) {
-                return checkCollisionWithBase(p, playerPos, playerSize);
+            [&](const auto& p) {
+                // 消失中（サイズ0）の足場は止まる対象にならないため除く
+                if (p.size.x <= 0.0f || p.size.y <= 0.0f || p.size.z <= 0.0f) return false;
+                return collisionBounds.sweep(i, playerMin, playerMax, displacement, time);
             }
-        }, platform);
-        
-        if (collision) {
-            return {&platform, i};
+        }, platforms[i]);
+        if (hit && (hitIndex < 0 || time < hitTime)) {
+            hitIndex = i;
+            hitTime = time;
         }
     }
-    return {nullptr, -1};
+    
+    if (hitIndex < 0) {
+        return {nullptr, -1};
+    }
+    outTime = hitTime;
+    return {&platforms[hitIndex], hitIndex};
+}
+
+void PlatformSystem::collectCollisionCandidates(const glm::vec3& queryMin, const glm::vec3& queryMax) {
+    if (static_cast<int>(platforms.size()) <= GameConstants::PhysicsConstants::BROADPHASE_LINEAR_SCAN_MAX_PLATFORMS) {
+        // 少数ならツリーをたどるより全件をSIMDで判定する方が速い
+        ensureSpatialIndex();
+        candidateScratch.clear();
+        collisionBounds.query(queryMin, queryMax, candidateScratch);
+    } else {
+        queryAABB(queryMin, queryMax, candidateScratch);
+        collisionBounds.filter(queryMin, queryMax, candidateScratch);
+    }
+}
+
+void PlatformSystem::queryAABB(const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<int>& outIndices) {
+    ensureSpatialIndex();
+    outIndices.clear();
+    
+    staticTree.query(queryMin, queryMax, outIndices);
+    
+    // 動的ツリーの葉は太らせてあるため、実際の境界ボックスで絞り込む
+    size_t dynamicBegin = outIndices.size();
+    dynamicTree.query(queryMin, queryMax, outIndices);
+    size_t count = dynamicBegin;
+    for (size_t i = dynamicBegin; i < outIndices.size(); i++) {
+        const SpatialEntry& entry = spatialEntries[outIndices[i]];
+        if (queryMax.x >= entry.boundsMin.x && queryMin.x <= entry.boundsMax.x &&
+            queryMax.y >= entry.boundsMin.y && queryMin.y <= entry.boundsMax.y &&
+            queryMax.z >= entry.boundsMin.z && queryMin.z <= entry.boundsMax.z) {
+            outIndices[count++] = outIndices[i];
+        }
+    }
+    outIndices.resize(count);
+    
+    std::sort(outIndices.begin(), outIndices.end());
 }
 
 std::vector<glm::vec3> PlatformSystem::getPositions() const {
@@ -343,15 +428,27 @@ void PlatformSystem::updateMovingPlatformFromTime(MovingPlatform& platform, floa
 }
 
 void PlatformSystem::updateRotatingPlatform(RotatingPlatform& platform, float deltaTime) {
+    float previousAngle = platform.rotationAngle;
     platform.rotationAngle += platform.rotationSpeed * deltaTime;
     if (platform.rotationAngle >= 360.0f) {
         platform.rotationAngle -= 360.0f;
     }
+    if (platform.rotationAngle != previousAngle) {
+        refreshOrientedBox(platform);
+    }
 }
 
 void PlatformSystem::updateRotatingPlatformFromTime(RotatingPlatform& platform, float absoluteTime) {
     // 絶対時間から回転角度を直接計算
+    float previousAngle = platform.rotationAngle;
     platform.rotationAngle = std::fmod(platform.rotationSpeed * absoluteTime, 360.0f);
+    if (platform.rotationAngle != previousAngle) {
+        refreshOrientedBox(platform);
+    }
+}
+
+void PlatformSystem::refreshOrientedBox(RotatingPlatform& platform) {
+    platform.orientedBox = OrientedBox::fromRotation(platform.position, platform.size, platform.rotationAxis, platform.rotationAngle);
 }
 
 void PlatformSystem::updatePatrollingPlatform(PatrollingPlatform& platform, float deltaTime) {
@@ -613,77 +710,92 @@ void PlatformSystem::resetMovingPlatformFlags() {
     }
 }
 
-bool PlatformSystem::checkCollisionWithBase(const BasePlatform& platform, const glm::vec3& playerPos, const glm::vec3& playerSize) {
-    if (!platform.isVisible) return false;
-    
-    glm::vec3 platformMin = platform.position - platform.size * 0.5f;
-    glm::vec3 platformMax = platform.position + platform.size * 0.5f;
-    glm::vec3 playerMin = playerPos - playerSize * 0.5f;
-    glm::vec3 playerMax = playerPos + playerSize * 0.5f;
-    
-    return (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
-            playerMax.y >= platformMin.y && playerMin.y <= platformMax.y &&
-            playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
+void PlatformSystem::computeSpatialBounds(const PlatformVariant& platform, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    std::visit(overloaded{
+        [&boundsMin, &boundsMax](const RotatingPlatform& p) {
+            // 回転角度に依存しないよう外接球で囲む
+            float radius = glm::length(p.size * 0.5f);
+            boundsMin = p.position - glm::vec3(radius);
+            boundsMax = p.position + glm::vec3(radius);
+        },
+        [&boundsMin, &boundsMax](const CycleDisappearingPlatform& p) {
+            // 消失中はサイズが0になるため、元のサイズで登録して再登録を避ける
+            glm::vec3 halfSize = glm::max(p.size, p.originalSize) * 0.5f;
+            boundsMin = p.position - halfSize;
+            boundsMax = p.position + halfSize;
+        },
+        [&boundsMin, &boundsMax](const auto& p) {
+            boundsMin = p.position - p.size * 0.5f;
+            boundsMax = p.position + p.size * 0.5f;
+        }
+    }, platform);
+}
+
+void PlatformSystem::refreshCollisionBounds(int index) {
+    // 再構築待ちの間は境界ボックスの配列がプラットフォーム数と一致しないことがある（再構築時に全て設定し直す）
+    if (spatialIndexDirty || index < 0 || index >= collisionBounds.size() || index >= static_cast<int>(platforms.size())) {
+        return;
+    }
+    writeCollisionBounds(index);
+}
+
+void PlatformSystem::writeCollisionBounds(int index) {
+    std::visit(overloaded{
+        [this, index](const RotatingPlatform& p) {
+            glm::vec3 boundsMin, boundsMax;
+            p.orientedBox.computeAABB(boundsMin, boundsMax);
+            collisionBounds.set(index, boundsMin, boundsMax, p.isVisible);
+        },
+        [this, index](const auto& p) {
+            collisionBounds.set(index, p.position - p.size * 0.5f, p.position + p.size * 0.5f, p.isVisible);
+        }
+    }, platforms[index]);
+}
+
+bool PlatformSystem::isDynamicPlatform(const PlatformVariant& platform) {
+    // 回転プラットフォームは外接球で囲むため、回転しても境界ボックスは変わらない
+    return std::holds_alternative<MovingPlatform>(platform) ||
+           std::holds_alternative<PatrollingPlatform>(platform) ||
+           std::holds_alternative<FlyingPlatform>(platform);
+}
+
+void PlatformSystem::rebuildSpatialIndex() {
+    staticTree.clear();
+    dynamicTree.clear();
+    spatialEntries.assign(platforms.size(), SpatialEntry());
+    dynamicPlatforms.clear();
+    collisionBounds.resize(static_cast<int>(platforms.size()));
+    
+    std::vector<AABBTree::BuildEntry> staticEntries;
+    staticEntries.reserve(platforms.size());
+    for (int i = 0; i < static_cast<int>(platforms.size()); i++) {
+        // エディタ等で位置・サイズが変わっている可能性があるため、OBBも作り直す
+        if (auto* rotating = std::get_if<RotatingPlatform>(&platforms[i])) {
+            refreshOrientedBox(*rotating);
+        }
+        SpatialEntry& entry = spatialEntries[i];
+        computeSpatialBounds(platforms[i], entry.boundsMin, entry.boundsMax);
+        if (isDynamicPlatform(platforms[i])) {
+            entry.dynamicProxyId = dynamicTree.createProxy(entry.boundsMin, entry.boundsMax, i,
+                                                           GameConstants::PhysicsConstants::BROADPHASE_FAT_MARGIN);
+            dynamicPlatforms.push_back(i);
+        } else {
+            staticEntries.push_back({entry.boundsMin, entry.boundsMax, i});
+        }
+        writeCollisionBounds(i);
+    }
+    staticTree.build(staticEntries);
+    spatialIndexDirty = false;
+}
+
+void PlatformSystem::ensureSpatialIndex() {
+    if (spatialIndexDirty || spatialEntries.size() != platforms.size()) {
+        rebuildSpatialIndex();
+    }
 }
 
 bool PlatformSystem::checkCollisionWithRotatingPlatform(const RotatingPlatform& platform, const glm::vec3& playerPos, const glm::vec3& playerSize) {
     if (!platform.isVisible) return false;
     
-    glm::vec3 halfSize = platform.size * 0.5f;
-    
-    if (glm::length(platform.rotationAxis - glm::vec3(0, 1, 0)) < 0.1f) {
-        float angle = glm::radians(platform.rotationAngle);
-        float cosAngle = cos(angle);
-        float sinAngle = sin(angle);
-        
-        glm::vec3 localPlayerPos = playerPos - platform.position;
-        
-        float newX = localPlayerPos.x * cosAngle + localPlayerPos.z * sinAngle;
-        float newZ = -localPlayerPos.x * sinAngle + localPlayerPos.z * cosAngle;
-        
-        glm::vec3 unrotatedPlayerPos = platform.position + glm::vec3(newX, localPlayerPos.y, newZ);
-        
-        glm::vec3 platformMin = platform.position - halfSize;
-        glm::vec3 platformMax = platform.position + halfSize;
-        glm::vec3 playerMin = unrotatedPlayerPos - playerSize * 0.5f;
-        glm::vec3 playerMax = unrotatedPlayerPos + playerSize * 0.5f;
-        
-        return (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
-                playerMax.y >= platformMin.y && playerMin.y <= platformMax.y &&
-                playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
-    } else if (glm::length(platform.rotationAxis - glm::vec3(1, 0, 0)) < 0.1f) {
-        float angle = glm::radians(platform.rotationAngle);
-        float cosAngle = cos(angle);
-        float sinAngle = sin(angle);
-        
-        glm::vec3 localPlayerPos = playerPos - platform.position;
-        
-        float newY = localPlayerPos.y * cosAngle - localPlayerPos.z * sinAngle;
-        float newZ = localPlayerPos.y * sinAngle + localPlayerPos.z * cosAngle;
-        
-        glm::vec3 unrotatedPlayerPos = platform.position + glm::vec3(localPlayerPos.x, newY, newZ);
-        
-        glm::vec3 platformMin = platform.position - halfSize;
-        glm::vec3 platformMax = platform.position + halfSize;
-        glm::vec3 playerMin = unrotatedPlayerPos - playerSize * 0.5f;
-        glm::vec3 playerMax = unrotatedPlayerPos + playerSize * 0.5f;
-        
-        return (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
-                playerMax.y >= platformMin.y && playerMin.y <= platformMax.y &&
-                playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
-    } else {
-        glm::vec3 localPlayerPos = playerPos - platform.position;
-        glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(-platform.rotationAngle), platform.rotationAxis);
-        glm::vec4 rotatedPlayerPos = rotationMatrix * glm::vec4(localPlayerPos, 1.0f);
-        glm::vec3 unrotatedPlayerPos = glm::vec3(rotatedPlayerPos) + platform.position;
-        
-        glm::vec3 platformMin = platform.position - halfSize;
-        glm::vec3 platformMax = platform.position + halfSize;
-        glm::vec3 playerMin = unrotatedPlayerPos - playerSize * 0.5f;
-        glm::vec3 playerMax = unrotatedPlayerPos + playerSize * 0.5f;
-        
-        return (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
-                playerMax.y >= platformMin.y && playerMin.y <= platformMax.y &&
-                playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
-    }
+    return platform.orientedBox.overlapsAABB(playerPos - playerSize * 0.5f, playerPos + playerSize * 0.5f);
 }
@@ -11,6 +11,8 @@
 
 #include "game_state.h"
 #include "../core/types/platform_types.h"
+#include "../physics/aabb_tree.h"
+#include "../physics/aabb_batch.h"
 #include <vector>
 #include <functional>
 
@@ -22,6 +24,28 @@ class PlatformSystem {
 private:
     std::vector<PlatformVariant> platforms;
     
+    /**
+     * @brief ブロードフェーズ用の登録情報
+     * @details プラットフォームの保守的な境界ボックスと、動的ツリーのプロキシIDを保持します。
+     */
+    struct SpatialEntry {
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+        int dynamicProxyId = AABBTree::NULL_NODE;  // 静的ツリーに登録した場合はNULL_NODE
+    };
+    
+    // ブロードフェーズ（静的ツリーはステージ読み込み時に一括構築、動的ツリーは移動するプラットフォームのみ）
+    AABBTree staticTree;
+    AABBTree dynamicTree;
+    std::vector<SpatialEntry> spatialEntries;  // platformsと同じインデックス
+    std::vector<int> dynamicPlatforms;         // update()で位置・サイズが変わるプラットフォーム
+    std::vector<int> candidateScratch;
+    bool spatialIndexDirty = false;
+    
+    // 衝突判定用の境界ボックスと表示状態（platformsと同じインデックス、update()のたびに同期する）
+    // 回転プラットフォームはOBBを囲む境界ボックスを登録し、重なった場合のみOBBで判定する
+    AABBBatch collisionBounds;
+    
 public:
     /**
      * @brief プラットフォームを追加する
@@ -33,6 +57,7 @@ public:
     template<typename T>
     void addPlatform(const T& platform) {
         platforms.push_back(platform);
+        spatialIndexDirty = true;  // ステージ読み込み時の連続追加に備え、構築は次回の問い合わせ時にまとめて行う
     }
     
     /**
@@ -49,6 +74,7 @@ public:
     /**
      * @brief 衝突判定（インデックス付き）
      * @details プレイヤーとプラットフォームの衝突判定を行い、衝突したプラットフォームとインデックスを返します。
+     * プラットフォーム数が少ない場合は全件をSIMDで判定し、多い場合はブロードフェーズの候補のみを判定します。
      * 
      * @param playerPos プレイヤー位置
      * @param playerSize プレイヤーサイズ
@@ -56,6 +82,58 @@ public:
      */
     std::pair<PlatformVariant*, int> checkCollisionWithIndex(const glm::vec3& playerPos, const glm::vec3& playerSize);
     
+    /**
+     * @brief 掃引衝突判定（インデックス付き）
+     * @details プレイヤーを移動量だけ動かしたときに最初に接触するプラットフォームと接触時刻を返します。
+     * 1ステップの移動量が足場の厚さを超える場合（時間倍率が高い場合など）のすり抜け対策に使用します。
+     * 開始時点で既に重なっているプラットフォームは対象外です（離散判定で処理）。
+     * 回転プラットフォームは上面への接触のみを判定します。
+     * 
+     * @param playerPos 移動開始時のプレイヤー位置
+     * @param playerSize プレイヤーサイズ
+     * @param displacement 移動量
+     * @param outTime 出力: 接触時刻（0〜1、移動量に対する割合）
+     * @return 接触したプラットフォームへのポインタとインデックスのペア（接触しない場合は{nullptr, -1}）
+     */
+    std::pair<PlatformVariant*, int> sweepCollisionWithIndex(const glm::vec3& playerPos, const glm::vec3& playerSize,
+                                                             const glm::vec3& displacement, float& outTime);
+    
+    /**
+     * @brief 境界ボックスと重なる可能性のあるプラットフォームを取得する
+     * @details ブロードフェーズ（静的・動的AABBツリー）で候補を絞り込みます。
+     * 候補はプラットフォームの保守的な境界ボックス（回転プラットフォームは外接球）で判定するため、
+     * 実際に衝突するかは呼び出し側で確認してください。
+     * 
+     * @param queryMin 問い合わせ範囲の最小座標
+     * @param queryMax 問い合わせ範囲の最大座標
+     * @param outIndices 出力: 候補のインデックス（昇順、重複なし）
+     */
+    void queryAABB(const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<int>& outIndices);
+    
+    /**
+     * @brief ブロードフェーズの再構築を要求する
+     * @details getPlatforms()経由でプラットフォームの位置やサイズを直接変更した場合（エディタ等）に呼び出します。
+     * 次回の問い合わせ時に再構築されます。
+     */
+    void markSpatialIndexDirty() { spatialIndexDirty = true; }
+    
+    /**
+     * @brief 衝突判定用の境界ボックスを更新する
+     * @details getPlatforms()経由で表示状態やサイズを変更した場合（スイッチ等）に呼び出します。
+     * 位置を大きく動かした場合はmarkSpatialIndexDirty()を使用してください。
+     * ブロードフェーズの再構築待ちの場合や範囲外のインデックスの場合は何もしません（再構築時に反映されます）。
+     * 
+     * @param index プラットフォームのインデックス
+     */
+    void refreshCollisionBounds(int index);
+    
+    /**
+     * @brief ブロードフェーズを再構築する
+     * @details 静的ツリーを一括構築し、移動するプラットフォームを動的ツリーに登録します。
+     * ステージ読み込みの完了時に呼び出すと、最初の問い合わせでの構築を避けられます。
+     */
+    void rebuildSpatialIndex();
+    
     /**
      * @brief 全てのプラットフォームを取得する（const版）
      * @return プラットフォームのベクターへのconst参照
@@ -74,7 +152,15 @@ public:
      * @brief プラットフォームをクリアする
      * @details 全プラットフォームを削除します。
      */
-    void clear() { platforms.clear(); }
+    void clear() {
+        platforms.clear();
+        staticTree.clear();
+        dynamicTree.clear();
+        spatialEntries.clear();
+        dynamicPlatforms.clear();
+        collisionBounds.clear();
+        spatialIndexDirty = false;
+    }
     
     /**
      * @brief プラットフォームを削除する
@@ -86,6 +172,7 @@ public:
     bool removePlatform(int index) {
         if (index >= 0 && index < static_cast<int>(platforms.size())) {
             platforms.erase(platforms.begin() + index);
+            spatialIndexDirty = true;  // 以降のインデックスがずれるため再構築する
             return true;
         }
         return false;
@@ -159,6 +246,7 @@ private:
     void updateMovingPlatformFromTime(MovingPlatform& platform, float absoluteTime, const glm::vec3& playerPos, const glm::vec3& playerSize);
     void updateRotatingPlatform(RotatingPlatform& platform, float deltaTime);
     void updateRotatingPlatformFromTime(RotatingPlatform& platform, float absoluteTime);
+    static void refreshOrientedBox(RotatingPlatform& platform);
     void updatePatrollingPlatform(PatrollingPlatform& platform, float deltaTime);
     void updatePatrollingPlatformFromTime(PatrollingPlatform& platform, float absoluteTime);
     void updateTeleportPlatform(TeleportPlatform& platform, float deltaTime);
@@ -168,7 +256,11 @@ private:
     void updateDisappearingPlatform(DisappearingPlatform& platform, float deltaTime);
     void updateFlyingPlatform(FlyingPlatform& platform, float deltaTime, const glm::vec3& playerPos);
     
-    bool checkCollisionWithBase(const BasePlatform& platform, const glm::vec3& playerPos, const glm::vec3& playerSize);
+    static void computeSpatialBounds(const PlatformVariant& platform, glm::vec3& boundsMin, glm::vec3& boundsMax);
+    static bool isDynamicPlatform(const PlatformVariant& platform);
+    void writeCollisionBounds(int index);
+    void ensureSpatialIndex();
+    void collectCollisionCandidates(const glm::vec3& queryMin, const glm::vec3& queryMax);
     bool checkCollisionWithRotatingPlatform(const RotatingPlatform& platform, const glm::vec3& playerPos, const glm::vec3& playerSize);
 };
 
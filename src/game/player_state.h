@@ -19,6 +19,7 @@ struct PlayerState {
     bool isShowingFrontTexture = false;
     
     int currentPlatformIndex = -1;  // -1の場合は足場の上にいない
+    bool wasOnPlatform = false;  // 前ステップで足場の上にいたか（着地音の判定に使用）
     
     glm::vec3 lastCheckpoint = glm::vec3(0, 30.0f, 0);
     int lastCheckpointItemId = -1;  // -1の場合はチェックポイント未通過
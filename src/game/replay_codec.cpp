@@ -0,0 +1,948 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_codec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr uint8_t MAGIC[4] = {'S', 'L', 'R', 'P'};
+    constexpr uint8_t INDEX_MAGIC[4] = {'S', 'L', 'I', 'X'};
+    constexpr uint8_t INPUT_MAGIC[4] = {'S', 'L', 'I', 'N'};
+    constexpr uint8_t LIBRARY_MAGIC[4] = {'S', 'L', 'L', 'B'};
+    constexpr uint64_t MAX_STREAM_FRAMES = uint64_t(1) << 24;  // StreamDecoderのフレーム数の上限（破損データで巨大な確保をしないため）
+    constexpr uint64_t MAX_LIBRARY_ENTRIES = 1 << 20;  // 破損データで巨大な確保をしないための上限
+    constexpr uint64_t MAX_INPUT_TICKS = uint64_t(1) << 26;  // 60Hzで約310時間（破損データで巨大な確保をしないための上限）
+    constexpr uint8_t INPUT_FLAG_EASY_MODE = 1 << 0;
+    constexpr float VECTOR_SCALE = 1024.0f;     // 位置・速度の量子化単位（1/1024）
+    constexpr float TIMESTAMP_SCALE = 10000.0f; // タイムスタンプの量子化単位（0.1ミリ秒）
+    constexpr size_t STREAM_FRAME_COUNT_WIDTH = 5;  // StreamEncoderのフレーム数のバイト数（35ビット）
+    constexpr size_t STREAM_STAGE_NUMBER_WIDTH = 5; // StreamEncoderのステージ番号のバイト数（int32のzigzag varintの最大長）
+
+    class ByteWriter {
+    public:
+        std::vector<uint8_t> bytes;
+
+        void writeU8(uint8_t value) {
+            bytes.push_back(value);
+        }
+
+        void writeU16(uint16_t value) {
+            bytes.push_back(static_cast<uint8_t>(value));
+            bytes.push_back(static_cast<uint8_t>(value >> 8));
+        }
+
+        void writeU32(uint32_t value) {
+            for (int i = 0; i < 4; i++) {
+                bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+            }
+        }
+
+        void writeF32(float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int i = 0; i < 4; i++) {
+                bytes.push_back(static_cast<uint8_t>(bits >> (i * 8)));
+            }
+        }
+
+        void writeVarint(uint64_t value) {
+            while (value >= 0x80) {
+                bytes.push_back(static_cast<uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+
+        // 後から同じ大きさで書き換えられるように、継続ビットで埋めて常にwidthバイトにする
+        void writePaddedVarint(uint64_t value, size_t width) {
+            for (size_t i = 0; i + 1 < width; i++) {
+                bytes.push_back(static_cast<uint8_t>(value & 0x7F) | 0x80);
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<uint8_t>(value & 0x7F));
+        }
+
+        void writeSignedVarint(int64_t value) {
+            // zigzag: 絶対値の小さい負数も短く収める
+            writeVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void writePaddedSignedVarint(int64_t value, size_t width) {
+            writePaddedVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63), width);
+        }
+
+        void writeString(const std::string& value) {
+            writeVarint(value.size());
+            bytes.insert(bytes.end(), value.begin(), value.end());
+        }
+    };
+
+    class ByteReader {
+    public:
+        ByteReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+        bool readU8(uint8_t& value) {
+            if (offset + 1 > size) return false;
+            value = data[offset++];
+            return true;
+        }
+
+        bool readU16(uint16_t& value) {
+            if (offset + 2 > size) return false;
+            value = static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+            offset += 2;
+            return true;
+        }
+
+        bool readU32(uint32_t& value) {
+            if (offset + 4 > size) return false;
+            value = 0;
+            for (int i = 0; i < 4; i++) {
+                value |= static_cast<uint32_t>(data[offset + i]) << (i * 8);
+            }
+            offset += 4;
+            return true;
+        }
+
+        bool readF32(float& value) {
+            if (offset + 4 > size) return false;
+            uint32_t bits = 0;
+            for (int i = 0; i < 4; i++) {
+                bits |= static_cast<uint32_t>(data[offset + i]) << (i * 8);
+            }
+            std::memcpy(&value, &bits, sizeof(value));
+            offset += 4;
+            return true;
+        }
+
+        bool readVarint(uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (offset >= size) return false;
+                uint8_t byte = data[offset++];
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return true;
+            }
+            return false;
+        }
+
+        bool readSignedVarint(int64_t& value) {
+            uint64_t encoded;
+            if (!readVarint(encoded)) return false;
+            value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+            return true;
+        }
+
+        bool readString(std::string& value) {
+            uint64_t length;
+            if (!readVarint(length) || length > size - offset) return false;
+            value.assign(reinterpret_cast<const char*>(data + offset), static_cast<size_t>(length));
+            offset += static_cast<size_t>(length);
+            return true;
+        }
+
+        void skip(size_t count) {
+            offset = std::min(size, offset + count);
+        }
+
+        size_t position() const {
+            return offset;
+        }
+
+    private:
+        const uint8_t* data;
+        size_t size;
+        size_t offset = 0;
+    };
+
+    int64_t quantize(float value, float scale) {
+        // 非有限値や極端な値で差分が桁あふれしないように範囲を制限する
+        constexpr double LIMIT = 1099511627776.0;  // 2^40
+        double scaled = static_cast<double>(value) * scale;
+        if (!std::isfinite(scaled)) return 0;
+        return static_cast<int64_t>(std::llround(std::clamp(scaled, -LIMIT, LIMIT)));
+    }
+
+    // 破損したデータで累積値が桁あふれしないように、quantize()の範囲を超える値は拒否する
+    bool accumulate(int64_t& total, int64_t delta) {
+        constexpr int64_t LIMIT = int64_t(1) << 41;
+        if (delta > LIMIT || delta < -LIMIT) return false;
+        total += delta;
+        return total <= LIMIT && total >= -LIMIT;
+    }
+
+    float dequantize(int64_t value, float scale) {
+        return static_cast<float>(static_cast<double>(value) / scale);
+    }
+
+    const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    void encodeBlock(ByteWriter& writer, const std::vector<ReplayFrame>& frames, size_t begin, size_t end, size_t itemCount) {
+        // 位置・速度・タイムスタンプはブロック内で差分をとる（ブロック先頭は絶対値 = キーフレーム）
+        int64_t previousTimestamp = 0;
+        for (size_t i = begin; i < end; i++) {
+            int64_t timestamp = quantize(frames[i].timestamp, TIMESTAMP_SCALE);
+            writer.writeSignedVarint(timestamp - previousTimestamp);
+            previousTimestamp = timestamp;
+        }
+
+        int64_t previousVector[6] = {0, 0, 0, 0, 0, 0};
+        for (size_t i = begin; i < end; i++) {
+            const auto& frame = frames[i];
+            const float components[6] = {
+                frame.playerPosition.x, frame.playerPosition.y, frame.playerPosition.z,
+                frame.playerVelocity.x, frame.playerVelocity.y, frame.playerVelocity.z
+            };
+            for (int axis = 0; axis < 6; axis++) {
+                int64_t quantized = quantize(components[axis], VECTOR_SCALE);
+                writer.writeSignedVarint(quantized - previousVector[axis]);
+                previousVector[axis] = quantized;
+            }
+        }
+
+        // timeScale（ブロック先頭の値と、値が変わったフレームのみ）
+        writer.writeF32(frames[begin].timeScale);
+        std::vector<size_t> timeScaleChanges;
+        for (size_t i = begin + 1; i < end; i++) {
+            if (frames[i].timeScale != frames[i - 1].timeScale) {
+                timeScaleChanges.push_back(i);
+            }
+        }
+        writer.writeVarint(timeScaleChanges.size());
+        size_t previousFrame = begin;
+        for (size_t frameIndex : timeScaleChanges) {
+            writer.writeVarint(frameIndex - previousFrame);
+            writer.writeF32(frames[frameIndex].timeScale);
+            previousFrame = frameIndex;
+        }
+
+        // アイテム状態（ブロック先頭の全状態をビット列で、以降は変化したものだけ）
+        for (size_t item = 0; item < itemCount; item += 8) {
+            uint8_t bits = 0;
+            for (size_t bit = 0; bit < 8 && item + bit < itemCount; bit++) {
+                if (frames[begin].isItemCollected(item + bit)) bits |= static_cast<uint8_t>(1 << bit);
+            }
+            writer.writeU8(bits);
+        }
+        struct ItemChange {
+            size_t frameIndex;
+            size_t itemIndex;
+            bool collected;
+        };
+        std::vector<ItemChange> itemChanges;
+        for (size_t i = begin + 1; i < end; i++) {
+            if (frames[i].itemCollectedStates == frames[i - 1].itemCollectedStates) {
+                continue;
+            }
+            for (size_t item = 0; item < itemCount; item++) {
+                bool collected = frames[i].isItemCollected(item);
+                if (collected != frames[i - 1].isItemCollected(item)) {
+                    itemChanges.push_back({i, item, collected});
+                }
+            }
+        }
+        writer.writeVarint(itemChanges.size());
+        previousFrame = begin;
+        for (const auto& change : itemChanges) {
+            writer.writeVarint(change.frameIndex - previousFrame);
+            writer.writeVarint(change.itemIndex);
+            writer.writeU8(change.collected ? 1 : 0);
+            previousFrame = change.frameIndex;
+        }
+    }
+
+    bool decodeBlockInto(const uint8_t* data, size_t size, size_t frameCount, size_t itemCount, ReplayFrame* frames,
+                         size_t* consumed = nullptr) {
+        ByteReader reader(data, size);
+
+        // 再生側は時刻で二分探索するため、先頭以外の差分が0以下（時刻が進まない・戻る）のデータは拒否する
+        int64_t timestamp = 0;
+        for (size_t i = 0; i < frameCount; i++) {
+            int64_t delta;
+            if (!reader.readSignedVarint(delta) || (i > 0 && delta <= 0) || !accumulate(timestamp, delta)) return false;
+            frames[i].timestamp = dequantize(timestamp, TIMESTAMP_SCALE);
+        }
+
+        int64_t vector[6] = {0, 0, 0, 0, 0, 0};
+        for (size_t i = 0; i < frameCount; i++) {
+            for (int axis = 0; axis < 6; axis++) {
+                int64_t delta;
+                if (!reader.readSignedVarint(delta) || !accumulate(vector[axis], delta)) return false;
+            }
+            frames[i].playerPosition = glm::vec3(dequantize(vector[0], VECTOR_SCALE), dequantize(vector[1], VECTOR_SCALE), dequantize(vector[2], VECTOR_SCALE));
+            frames[i].playerVelocity = glm::vec3(dequantize(vector[3], VECTOR_SCALE), dequantize(vector[4], VECTOR_SCALE), dequantize(vector[5], VECTOR_SCALE));
+        }
+
+        float timeScale;
+        uint64_t changeCount;
+        if (!reader.readF32(timeScale) || !reader.readVarint(changeCount)) return false;
+        uint64_t changeFrame = 0;
+        size_t nextFrame = 0;
+        for (uint64_t change = 0; change <= changeCount; change++) {
+            float nextTimeScale = timeScale;
+            if (change < changeCount) {
+                uint64_t delta;
+                if (!reader.readVarint(delta) || !reader.readF32(nextTimeScale)) return false;
+                changeFrame += delta;
+                if (changeFrame >= frameCount || changeFrame < nextFrame) return false;
+            } else {
+                changeFrame = frameCount;
+            }
+            for (; nextFrame < changeFrame; nextFrame++) {
+                frames[nextFrame].timeScale = timeScale;
+            }
+            timeScale = nextTimeScale;
+        }
+
+        // アイテム状態は変化があるまで同じものをフレーム間で共有し、変化したときだけ複製する
+        auto currentStates = std::make_shared<std::vector<bool>>(itemCount, false);
+        bool statesShared = false;
+        for (size_t item = 0; item < itemCount; item += 8) {
+            uint8_t bits;
+            if (!reader.readU8(bits)) return false;
+            for (size_t bit = 0; bit < 8 && item + bit < itemCount; bit++) {
+                (*currentStates)[item + bit] = (bits >> bit) & 1;
+            }
+        }
+        if (!reader.readVarint(changeCount)) return false;
+        changeFrame = 0;
+        nextFrame = 0;
+        auto fillUntil = [&](size_t endFrame) {
+            for (; nextFrame < endFrame; nextFrame++) {
+                if (itemCount > 0) {
+                    frames[nextFrame].itemCollectedStates = currentStates;
+                    statesShared = true;
+                } else {
+                    frames[nextFrame].itemCollectedStates.reset();
+                }
+            }
+        };
+        for (uint64_t change = 0; change < changeCount; change++) {
+            uint64_t delta;
+            uint64_t itemIndex;
+            uint8_t collected;
+            if (!reader.readVarint(delta) || !reader.readVarint(itemIndex) || !reader.readU8(collected)) return false;
+            changeFrame += delta;
+            if (changeFrame >= frameCount || changeFrame < nextFrame || itemIndex >= itemCount) return false;
+            fillUntil(static_cast<size_t>(changeFrame));
+            if (statesShared) {
+                currentStates = std::make_shared<std::vector<bool>>(*currentStates);
+                statesShared = false;
+            }
+            (*currentStates)[static_cast<size_t>(itemIndex)] = (collected != 0);
+        }
+        fillUntil(frameCount);
+        if (consumed != nullptr) {
+            *consumed = reader.position();
+        }
+        return true;
+    }
+}
+
+void ReplayCodec::StreamDecoder::append(const uint8_t* data, size_t size) {
+    // 復元済みの部分が多くなったら取り除き、受信中のデータ全体を保持し続けない
+    if (readOffset > 0 && readOffset >= bytes.size() / 2) {
+        bytes.erase(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(readOffset));
+        readOffset = 0;
+    }
+    bytes.insert(bytes.end(), data, data + size);
+}
+
+bool ReplayCodec::StreamDecoder::readHeader() {
+    const uint8_t* data = bytes.data() + readOffset;
+    size_t size = bytes.size() - readOffset;
+    if (size < sizeof(MAGIC)) {
+        return false;
+    }
+    if (!isBinary(data, size)) {
+        failed = true;
+        return false;
+    }
+
+    ByteReader reader(data, size);
+    reader.skip(sizeof(MAGIC));
+    uint16_t version;
+    int64_t stageNumber;
+    uint64_t frames, items, interval;
+    ReplayData result{};
+    if (!reader.readU16(version)) {
+        return false;
+    }
+    if (version != FORMAT_VERSION) {
+        failed = true;
+        return false;
+    }
+    if (!reader.readSignedVarint(stageNumber) || !reader.readF32(result.clearTime) || !reader.readF32(result.frameRate) ||
+        !reader.readString(result.recordedDate) || !reader.readVarint(frames) || !reader.readVarint(items) ||
+        !reader.readVarint(interval)) {
+        return false;  // 続きを待つ
+    }
+    if (interval == 0 || frames > MAX_STREAM_FRAMES || items > MAX_ITEMS ||
+        stageNumber < INT32_MIN || stageNumber > INT32_MAX) {
+        failed = true;
+        return false;
+    }
+
+    // StreamEncoderで書いたファイルの記録日時は空白で埋められている
+    while (!result.recordedDate.empty() && result.recordedDate.back() == ' ') {
+        result.recordedDate.pop_back();
+    }
+    result.stageNumber = static_cast<int>(stageNumber);
+    header = std::move(result);
+    frameCount = static_cast<size_t>(frames);
+    itemCount = static_cast<size_t>(items);
+    keyframeInterval = static_cast<size_t>(interval);
+    readOffset += reader.position();
+    headerRead = true;
+    return true;
+}
+
+size_t ReplayCodec::StreamDecoder::decodeAvailable(std::vector<ReplayFrame>& frames) {
+    if (failed || (!headerRead && !readHeader())) {
+        return 0;
+    }
+
+    size_t added = 0;
+    while (decodedCount < frameCount) {
+        size_t blockFrames = std::min(keyframeInterval, frameCount - decodedCount);
+        size_t first = frames.size();
+        frames.resize(first + blockFrames);
+        size_t consumed = 0;
+        if (!decodeBlockInto(bytes.data() + readOffset, bytes.size() - readOffset, blockFrames, itemCount,
+                             frames.data() + first, &consumed)) {
+            frames.resize(first);
+            break;
+        }
+        if (decodedCount > 0 && first > 0 && frames[first].timestamp < frames[first - 1].timestamp) {
+            frames.resize(first);
+            failed = true;
+            break;
+        }
+        readOffset += consumed;
+        decodedCount += blockFrames;
+        added += blockFrames;
+    }
+    return added;
+}
+
+std::vector<uint8_t> ReplayCodec::encode(const ReplayData& replayData, size_t keyframeInterval) {
+    const auto& frames = replayData.frames;
+    keyframeInterval = std::max<size_t>(keyframeInterval, 1);
+    size_t itemCount = 0;
+    for (const auto& frame : frames) {
+        itemCount = std::max(itemCount, frame.itemCount());
+    }
+    itemCount = std::min(itemCount, MAX_ITEMS);
+
+    ByteWriter writer;
+    writer.bytes.reserve(48 + replayData.recordedDate.size() + frames.size() * 16);
+    writer.bytes.insert(writer.bytes.end(), std::begin(MAGIC), std::end(MAGIC));
+    writer.writeU16(FORMAT_VERSION);
+    writer.writeSignedVarint(replayData.stageNumber);
+    writer.writeF32(replayData.clearTime);
+    writer.writeF32(replayData.frameRate);
+    writer.writeString(replayData.recordedDate);
+    writer.writeVarint(frames.size());
+    writer.writeVarint(itemCount);
+    writer.writeVarint(keyframeInterval);
+
+    std::vector<size_t> blockOffsets;
+    for (size_t begin = 0; begin < frames.size(); begin += keyframeInterval) {
+        blockOffsets.push_back(writer.bytes.size());
+        encodeBlock(writer, frames, begin, std::min(begin + keyframeInterval, frames.size()), itemCount);
+    }
+
+    // 末尾のシーク用インデックス（ブロック先頭のフレーム番号・タイムスタンプ・位置）
+    size_t indexOffset = writer.bytes.size();
+    writer.writeVarint(blockOffsets.size());
+    int64_t previousTimestamp = 0;
+    size_t previousOffset = 0;
+    for (size_t block = 0; block < blockOffsets.size(); block++) {
+        int64_t timestamp = quantize(frames[block * keyframeInterval].timestamp, TIMESTAMP_SCALE);
+        writer.writeSignedVarint(timestamp - previousTimestamp);
+        writer.writeVarint(blockOffsets[block] - previousOffset);
+        previousTimestamp = timestamp;
+        previousOffset = blockOffsets[block];
+    }
+    writer.writeU32(static_cast<uint32_t>(indexOffset));
+    writer.bytes.insert(writer.bytes.end(), std::begin(INDEX_MAGIC), std::end(INDEX_MAGIC));
+
+    return std::move(writer.bytes);
+}
+
+void ReplayCodec::StreamEncoder::begin(size_t itemCount, size_t keyframeInterval) {
+    this->itemCount = std::min(itemCount, MAX_ITEMS);
+    this->keyframeInterval = std::max<size_t>(keyframeInterval, 1);
+    frameCount = 0;
+    bufferedCount = 0;
+    buffer.resize(this->keyframeInterval);
+    blockOffsets.clear();
+    blockTimestamps.clear();
+    headerSize = encodeHeader(ReplayData()).size();
+    nextBlockOffset = headerSize;
+}
+
+std::vector<uint8_t> ReplayCodec::StreamEncoder::encodeHeader(const ReplayData& header) const {
+    std::string recordedDate = header.recordedDate;
+    recordedDate.resize(RECORDED_DATE_LENGTH, ' ');
+
+    ByteWriter writer;
+    writer.bytes.insert(writer.bytes.end(), std::begin(MAGIC), std::end(MAGIC));
+    writer.writeU16(FORMAT_VERSION);
+    // ステージ番号も値によって大きさが変わらないように、最大の長さで書く
+    writer.writePaddedSignedVarint(header.stageNumber, STREAM_STAGE_NUMBER_WIDTH);
+    writer.writeF32(header.clearTime);
+    writer.writeF32(header.frameRate);
+    writer.writeString(recordedDate);
+    writer.writePaddedVarint(frameCount, STREAM_FRAME_COUNT_WIDTH);
+    writer.writeVarint(itemCount);
+    writer.writeVarint(keyframeInterval);
+    return std::move(writer.bytes);
+}
+
+bool ReplayCodec::StreamEncoder::addFrame(const ReplayFrame& frame, std::vector<uint8_t>& block) {
+    buffer[bufferedCount++] = frame;
+    frameCount++;
+    if (bufferedCount < keyframeInterval) {
+        return false;
+    }
+    encodeBufferedBlock(block);
+    return true;
+}
+
+bool ReplayCodec::StreamEncoder::flush(std::vector<uint8_t>& block) {
+    if (bufferedCount == 0) {
+        return false;
+    }
+    encodeBufferedBlock(block);
+    return true;
+}
+
+void ReplayCodec::StreamEncoder::encodeBufferedBlock(std::vector<uint8_t>& block) {
+    ByteWriter writer;
+    writer.bytes.swap(block);
+    writer.bytes.clear();
+    encodeBlock(writer, buffer, 0, bufferedCount, itemCount);
+
+    blockOffsets.push_back(nextBlockOffset);
+    blockTimestamps.push_back(buffer[0].timestamp);
+    nextBlockOffset += writer.bytes.size();
+    bufferedCount = 0;
+    block.swap(writer.bytes);
+}
+
+std::vector<uint8_t> ReplayCodec::StreamEncoder::encodeIndex() const {
+    ByteWriter writer;
+    writer.writeVarint(blockOffsets.size());
+    int64_t previousTimestamp = 0;
+    size_t previousOffset = 0;
+    for (size_t block = 0; block < blockOffsets.size(); block++) {
+        int64_t timestamp = quantize(blockTimestamps[block], TIMESTAMP_SCALE);
+        writer.writeSignedVarint(timestamp - previousTimestamp);
+        writer.writeVarint(blockOffsets[block] - previousOffset);
+        previousTimestamp = timestamp;
+        previousOffset = blockOffsets[block];
+    }
+    writer.writeU32(static_cast<uint32_t>(nextBlockOffset));
+    writer.bytes.insert(writer.bytes.end(), std::begin(INDEX_MAGIC), std::end(INDEX_MAGIC));
+    return std::move(writer.bytes);
+}
+
+bool ReplayCodec::isBinary(const uint8_t* data, size_t size) {
+    return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool ReplayCodec::readIndex(const uint8_t* data, size_t size, SeekIndex& index) {
+    constexpr size_t FOOTER_SIZE = 4 + sizeof(INDEX_MAGIC);
+    if (!isBinary(data, size) || size < sizeof(MAGIC) + FOOTER_SIZE ||
+        std::memcmp(data + size - sizeof(INDEX_MAGIC), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        return false;
+    }
+
+    ByteReader reader(data, size - FOOTER_SIZE);
+    reader.skip(sizeof(MAGIC));
+    uint16_t version;
+    if (!reader.readU16(version) || version != FORMAT_VERSION) {
+        return false;
+    }
+
+    SeekIndex result;
+    int64_t stageNumber;
+    uint64_t frameCount;
+    uint64_t itemCount;
+    uint64_t keyframeInterval;
+    if (!reader.readSignedVarint(stageNumber) ||
+        !reader.readF32(result.header.clearTime) ||
+        !reader.readF32(result.header.frameRate) ||
+        !reader.readString(result.header.recordedDate) ||
+        !reader.readVarint(frameCount) ||
+        !reader.readVarint(itemCount) ||
+        !reader.readVarint(keyframeInterval) || keyframeInterval == 0) {
+        return false;
+    }
+    result.header.stageNumber = static_cast<int>(stageNumber);
+
+    // 1フレームあたり最低7バイト（タイムスタンプ1 + 位置・速度6）あるため、それを超える数は破損とみなす
+    size_t blocksBegin = reader.position();
+    if (frameCount > size / 7 || itemCount > MAX_ITEMS) {
+        return false;
+    }
+    result.frameCount = static_cast<size_t>(frameCount);
+    result.itemCount = static_cast<size_t>(itemCount);
+
+    ByteReader footer(data + size - FOOTER_SIZE, 4);
+    uint32_t indexOffset;
+    if (!footer.readU32(indexOffset) || indexOffset < blocksBegin || indexOffset > size - FOOTER_SIZE) {
+        return false;
+    }
+
+    ByteReader indexReader(data, size - FOOTER_SIZE);
+    indexReader.skip(indexOffset);
+    uint64_t blockCount;
+    uint64_t expectedBlocks = (frameCount + keyframeInterval - 1) / keyframeInterval;
+    if (!indexReader.readVarint(blockCount) || blockCount != expectedBlocks) {
+        return false;
+    }
+
+    int64_t timestamp = 0;
+    uint64_t offset = 0;
+    result.blocks.resize(static_cast<size_t>(blockCount));
+    for (size_t block = 0; block < result.blocks.size(); block++) {
+        int64_t timestampDelta;
+        uint64_t offsetDelta;
+        if (!indexReader.readSignedVarint(timestampDelta) || (block > 0 && timestampDelta <= 0) ||
+            !accumulate(timestamp, timestampDelta) || !indexReader.readVarint(offsetDelta)) {
+            return false;
+        }
+        offset += offsetDelta;
+        if (offset < blocksBegin || offset > indexOffset || (block > 0 && offsetDelta == 0)) {
+            return false;
+        }
+        auto& entry = result.blocks[block];
+        entry.firstFrame = block * static_cast<size_t>(keyframeInterval);
+        entry.frameCount = std::min(static_cast<size_t>(keyframeInterval), result.frameCount - entry.firstFrame);
+        entry.firstTimestamp = dequantize(timestamp, TIMESTAMP_SCALE);
+        entry.offset = static_cast<size_t>(offset);
+    }
+    for (size_t block = 0; block < result.blocks.size(); block++) {
+        size_t end = (block + 1 < result.blocks.size()) ? result.blocks[block + 1].offset : indexOffset;
+        result.blocks[block].length = end - result.blocks[block].offset;
+    }
+
+    index = std::move(result);
+    return true;
+}
+
+size_t ReplayCodec::findBlock(const SeekIndex& index, float timestamp) {
+    auto upper = std::upper_bound(index.blocks.begin(), index.blocks.end(), timestamp,
+                                  [](float time, const SeekIndex::Block& block) { return time < block.firstTimestamp; });
+    return (upper == index.blocks.begin()) ? 0 : static_cast<size_t>(upper - index.blocks.begin()) - 1;
+}
+
+bool ReplayCodec::decodeBlock(const uint8_t* data, size_t size, const SeekIndex& index, size_t blockIndex,
+                              std::vector<ReplayFrame>& frames) {
+    if (blockIndex >= index.blocks.size()) {
+        return false;
+    }
+    const auto& block = index.blocks[blockIndex];
+    if (block.offset + block.length > size) {
+        return false;
+    }
+    frames.resize(block.frameCount);
+    return decodeBlockInto(data + block.offset, block.length, block.frameCount, index.itemCount, frames.data());
+}
+
+bool ReplayCodec::seek(const uint8_t* data, size_t size, const SeekIndex& index, float timestamp, ReplayFrame& frame) {
+    if (index.blocks.empty()) {
+        return false;
+    }
+
+    // キーフレーム1つと、そこから対象までの差分だけを復元する
+    std::vector<ReplayFrame> blockFrames;
+    if (!decodeBlock(data, size, index, findBlock(index, timestamp), blockFrames)) {
+        return false;
+    }
+    auto upper = std::upper_bound(blockFrames.begin(), blockFrames.end(), timestamp,
+                                  [](float time, const ReplayFrame& blockFrame) { return time < blockFrame.timestamp; });
+    frame = (upper == blockFrames.begin()) ? blockFrames.front() : *(upper - 1);
+    return true;
+}
+
+bool ReplayCodec::decode(const uint8_t* data, size_t size, ReplayData& replayData) {
+    SeekIndex index;
+    if (!readIndex(data, size, index)) {
+        return false;
+    }
+
+    ReplayData result = index.header;
+    result.frames.resize(index.frameCount);
+    for (const auto& block : index.blocks) {
+        if (block.offset + block.length > size ||
+            !decodeBlockInto(data + block.offset, block.length, block.frameCount, index.itemCount, result.frames.data() + block.firstFrame)) {
+            return false;
+        }
+        if (block.firstFrame > 0 && result.frames[block.firstFrame].timestamp < result.frames[block.firstFrame - 1].timestamp) {
+            return false;
+        }
+    }
+
+    replayData = std::move(result);
+    return true;
+}
+
+std::vector<uint8_t> ReplayCodec::encodeInputs(const InputReplay& replay) {
+    ByteWriter writer;
+    for (uint8_t byte : INPUT_MAGIC) writer.writeU8(byte);
+    writer.writeU16(INPUT_FORMAT_VERSION);
+    writer.writeSignedVarint(replay.stageNumber);
+    writer.writeU32(static_cast<uint32_t>(replay.stageHash));
+    writer.writeU32(static_cast<uint32_t>(replay.stageHash >> 32));
+    writer.writeU32(replay.rngSeed);
+    writer.writeVarint(static_cast<uint64_t>(std::max(replay.tickRate, 0)));
+    writer.writeF32(replay.clearTime);
+    writer.writeU8(replay.isEasyMode ? INPUT_FLAG_EASY_MODE : 0);
+    writer.writeVarint(replay.inputs.size());
+
+    // 入力は数ティックから数十ティック同じ値が続くため、連続区間ごとにまとめる
+    size_t runStart = 0;
+    while (runStart < replay.inputs.size()) {
+        const TickInput& input = replay.inputs[runStart];
+        size_t runEnd = runStart + 1;
+        while (runEnd < replay.inputs.size() && replay.inputs[runEnd] == input) {
+            runEnd++;
+        }
+        writer.writeVarint(runEnd - runStart);
+        writer.writeU8(input.buttons);
+        writer.writeU8(static_cast<uint8_t>(input.moveX));
+        writer.writeU8(static_cast<uint8_t>(input.moveZ));
+        writer.writeU8(input.timeScaleLevel);
+        runStart = runEnd;
+    }
+    return writer.bytes;
+}
+
+bool ReplayCodec::decodeInputs(const uint8_t* data, size_t size, InputReplay& replay) {
+    if (size < sizeof(INPUT_MAGIC) || std::memcmp(data, INPUT_MAGIC, sizeof(INPUT_MAGIC)) != 0) {
+        return false;
+    }
+
+    ByteReader reader(data, size);
+    reader.skip(sizeof(INPUT_MAGIC));
+
+    uint16_t version;
+    int64_t stageNumber;
+    uint32_t hashLow, hashHigh, rngSeed;
+    uint64_t tickRate, tickCount;
+    float clearTime;
+    uint8_t flags;
+    if (!reader.readU16(version) || version != INPUT_FORMAT_VERSION ||
+        !reader.readSignedVarint(stageNumber) ||
+        !reader.readU32(hashLow) || !reader.readU32(hashHigh) || !reader.readU32(rngSeed) ||
+        !reader.readVarint(tickRate) || !reader.readF32(clearTime) || !reader.readU8(flags) ||
+        !reader.readVarint(tickCount)) {
+        return false;
+    }
+    if (stageNumber < INT32_MIN || stageNumber > INT32_MAX || tickRate == 0 || tickRate > 10000 || tickCount > MAX_INPUT_TICKS) {
+        return false;
+    }
+
+    InputReplay result;
+    result.stageNumber = static_cast<int>(stageNumber);
+    result.stageHash = (static_cast<uint64_t>(hashHigh) << 32) | hashLow;
+    result.rngSeed = rngSeed;
+    result.tickRate = static_cast<int>(tickRate);
+    result.clearTime = clearTime;
+    result.isEasyMode = (flags & INPUT_FLAG_EASY_MODE) != 0;
+    result.inputs.reserve(static_cast<size_t>(tickCount));
+
+    while (result.inputs.size() < tickCount) {
+        uint64_t runLength;
+        uint8_t buttons, moveX, moveZ, timeScaleLevel;
+        if (!reader.readVarint(runLength) || runLength == 0 || runLength > tickCount - result.inputs.size() ||
+            !reader.readU8(buttons) || !reader.readU8(moveX) || !reader.readU8(moveZ) || !reader.readU8(timeScaleLevel) ||
+            timeScaleLevel > 2) {
+            return false;
+        }
+
+        TickInput input;
+        input.buttons = buttons;
+        input.moveX = static_cast<int8_t>(moveX);
+        input.moveZ = static_cast<int8_t>(moveZ);
+        input.timeScaleLevel = timeScaleLevel;
+        result.inputs.insert(result.inputs.end(), static_cast<size_t>(runLength), input);
+    }
+
+    replay = std::move(result);
+    return true;
+}
+
+std::vector<uint8_t> ReplayCodec::encodeLibraryIndex(const std::vector<ReplayLibraryEntry>& entries, uint32_t packGeneration) {
+    ByteWriter writer;
+    for (uint8_t byte : LIBRARY_MAGIC) writer.writeU8(byte);
+    writer.writeU16(LIBRARY_FORMAT_VERSION);
+    writer.writeVarint(packGeneration);
+    writer.writeVarint(entries.size());
+    for (const auto& entry : entries) {
+        writer.writeVarint(entry.id);
+        writer.writeSignedVarint(entry.stageNumber);
+        writer.writeF32(entry.clearTime);
+        writer.writeString(entry.recordedDate);
+        writer.writeString(entry.playerName);
+        writer.writeVarint(entry.offset);
+        writer.writeVarint(entry.replaySize);
+        writer.writeVarint(entry.inputSize);
+        writer.writeVarint(entry.lastUsed);
+    }
+    return writer.bytes;
+}
+
+bool ReplayCodec::decodeLibraryIndex(const uint8_t* data, size_t size, std::vector<ReplayLibraryEntry>& entries,
+                                     uint32_t& packGeneration) {
+    if (size < sizeof(LIBRARY_MAGIC) || std::memcmp(data, LIBRARY_MAGIC, sizeof(LIBRARY_MAGIC)) != 0) {
+        return false;
+    }
+
+    ByteReader reader(data, size);
+    reader.skip(sizeof(LIBRARY_MAGIC));
+
+    uint16_t version;
+    uint64_t generation = 0;
+    uint64_t count;
+    if (!reader.readU16(version) || version < 1 || version > LIBRARY_FORMAT_VERSION) {
+        return false;
+    }
+    // バージョン1は世代を持たない（常に最初のデータファイルを指す）
+    if ((version >= 2 && (!reader.readVarint(generation) || generation > UINT32_MAX)) ||
+        !reader.readVarint(count) || count > MAX_LIBRARY_ENTRIES) {
+        return false;
+    }
+
+    std::vector<ReplayLibraryEntry> result(static_cast<size_t>(count));
+    for (auto& entry : result) {
+        uint64_t id, offset, replaySize, inputSize, lastUsed;
+        int64_t stageNumber;
+        if (!reader.readVarint(id) || !reader.readSignedVarint(stageNumber) || !reader.readF32(entry.clearTime) ||
+            !reader.readString(entry.recordedDate) || !reader.readString(entry.playerName) ||
+            !reader.readVarint(offset) || !reader.readVarint(replaySize) || !reader.readVarint(inputSize) ||
+            !reader.readVarint(lastUsed)) {
+            return false;
+        }
+        if (id > UINT32_MAX || stageNumber < INT32_MIN || stageNumber > INT32_MAX ||
+            replaySize > UINT32_MAX || inputSize > UINT32_MAX) {
+            return false;
+        }
+        entry.id = static_cast<uint32_t>(id);
+        entry.stageNumber = static_cast<int>(stageNumber);
+        entry.offset = offset;
+        entry.replaySize = static_cast<uint32_t>(replaySize);
+        entry.inputSize = static_cast<uint32_t>(inputSize);
+        entry.lastUsed = lastUsed;
+    }
+
+    entries = std::move(result);
+    packGeneration = static_cast<uint32_t>(generation);
+    return true;
+}
+
+bool ReplayCodec::fromJson(const nlohmann::json& replayJson, ReplayData& replayData) {
+    if (!replayJson.is_object()) {
+        return false;
+    }
+
+    ReplayData result;
+    result.stageNumber = replayJson.value("stageNumber", 0);
+    result.clearTime = replayJson.value("clearTime", 0.0f);
+    result.recordedDate = replayJson.value("recordedDate", "");
+    result.frameRate = replayJson.value("frameRate", 0.1f);
+
+    if (replayJson.contains("frames") && replayJson["frames"].is_array()) {
+        const auto& framesJson = replayJson["frames"];
+        result.frames.reserve(framesJson.size());
+        for (const auto& frameJson : framesJson) {
+            ReplayFrame frame;
+            frame.timestamp = frameJson.value("timestamp", 0.0f);
+            frame.playerPosition = glm::vec3(0.0f);
+            frame.playerVelocity = glm::vec3(0.0f);
+
+            if (frameJson.contains("playerPosition") && frameJson["playerPosition"].is_array() && frameJson["playerPosition"].size() == 3) {
+                const auto& pos = frameJson["playerPosition"];
+                frame.playerPosition = glm::vec3(pos[0].get<float>(), pos[1].get<float>(), pos[2].get<float>());
+            }
+
+            if (frameJson.contains("playerVelocity") && frameJson["playerVelocity"].is_array() && frameJson["playerVelocity"].size() == 3) {
+                const auto& vel = frameJson["playerVelocity"];
+                frame.playerVelocity = glm::vec3(vel[0].get<float>(), vel[1].get<float>(), vel[2].get<float>());
+            }
+
+            // timeScaleは後方互換性のため、存在しない場合は1.0fをデフォルト値とする
+            frame.timeScale = frameJson.value("timeScale", 1.0f);
+
+            if (frameJson.contains("itemCollectedStates") && frameJson["itemCollectedStates"].is_array()) {
+                const auto& statesJson = frameJson["itemCollectedStates"];
+                if (statesJson.size() > MAX_ITEMS) {
+                    return false;
+                }
+                std::vector<bool> states;
+                states.reserve(statesJson.size());
+                for (const auto& state : statesJson) {
+                    states.push_back(state.get<bool>());
+                }
+                // 直前のフレームと同じ状態なら共有する
+                if (!result.frames.empty() && result.frames.back().itemCollectedStates &&
+                    *result.frames.back().itemCollectedStates == states) {
+                    frame.itemCollectedStates = result.frames.back().itemCollectedStates;
+                } else if (!states.empty()) {
+                    frame.itemCollectedStates = std::make_shared<const std::vector<bool>>(std::move(states));
+                }
+            }
+
+            result.frames.push_back(std::move(frame));
+        }
+    }
+
+    replayData = std::move(result);
+    return true;
+}
+
+std::string ReplayCodec::toBase64(const std::vector<uint8_t>& data) {
+    std::string text;
+    text.reserve((data.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t chunk = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < data.size()) chunk |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < data.size()) chunk |= static_cast<uint32_t>(data[i + 2]);
+        text.push_back(BASE64_CHARS[(chunk >> 18) & 0x3F]);
+        text.push_back(BASE64_CHARS[(chunk >> 12) & 0x3F]);
+        text.push_back(i + 1 < data.size() ? BASE64_CHARS[(chunk >> 6) & 0x3F] : '=');
+        text.push_back(i + 2 < data.size() ? BASE64_CHARS[chunk & 0x3F] : '=');
+    }
+    return text;
+}
+
+bool ReplayCodec::fromBase64(const std::string& text, std::vector<uint8_t>& data) {
+    int8_t lookup[256];
+    std::fill(std::begin(lookup), std::end(lookup), static_cast<int8_t>(-1));
+    for (int i = 0; i < 64; i++) {
+        lookup[static_cast<uint8_t>(BASE64_CHARS[i])] = static_cast<int8_t>(i);
+    }
+
+    data.clear();
+    data.reserve(text.size() / 4 * 3);
+    uint32_t chunk = 0;
+    int bits = 0;
+    for (char c : text) {
+        if (c == '=') break;
+        int8_t value = lookup[static_cast<uint8_t>(c)];
+        if (value < 0) return false;
+        chunk = (chunk << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            data.push_back(static_cast<uint8_t>(chunk >> bits));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,334 @@
+/**
+ * @file replay_codec.h
+ * @brief リプレイのシリアライズ
+ * @details リプレイデータのバイナリ形式への変換と、旧形式（JSON）の読み込みを提供します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_state.h"
+#include "input_replay.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief リプレイのシリアライズ
+ * @details バイナリ形式（リトルエンディアン）は次の順に並びます。
+ * - ヘッダー: マジック"SLRP"、バージョン、ステージ番号、クリアタイム、記録間隔、記録日時、フレーム数、アイテム数、キーフレーム間隔
+ * - ブロック: キーフレーム間隔ごとにフレームをまとめたもの。先頭フレームは絶対値（キーフレーム）、以降は差分です。
+ *   - タイムスタンプ: 直前との差分（0.1ミリ秒単位、先頭以外は正の値）をzigzag varintで格納
+ *   - 位置・速度: 1/1024単位の固定小数点に量子化し、直前との差分をzigzag varintで格納
+ *   - timeScale: 先頭の値と、値が変わったフレームだけを（フレーム番号の差分, 値）の組で格納
+ *   - アイテム状態: 先頭の全状態をビット列で、以降は変わったものだけを（フレーム番号の差分, アイテム番号, 状態）の組で格納
+ * - インデックス: 各ブロックの先頭タイムスタンプと位置
+ * - フッター: インデックスの位置（4バイト）とマジック"SLIX"
+ *
+ * 任意の時刻へのシークは、インデックスからブロックを二分探索し、そのブロックだけを復元します。
+ * StreamEncoderを使うと、記録しながらブロック単位でファイルに書き出せます。
+ * StreamDecoderを使うと、受信しながらブロック単位でフレームを復元できます（インデックスは使いません）。
+ * 量子化は差分をとる前に行うため、誤差はフレーム数によらず1/2048以内です。
+ *
+ * 入力リプレイ（InputReplay）は別の形式で、マジック"SLIN"、バージョン、ステージ番号、ステージハッシュ、
+ * 乱数の種、ティックレート、クリアタイム、フラグ、ティック数に続けて、同じ入力が続く区間を
+ * （ティック数, ボタン, 移動X, 移動Z, timeScaleレベル）の組で格納します。
+ *
+ * リプレイライブラリのインデックス（ReplayLibraryEntryの一覧）は、マジック"SLLB"、バージョン、データファイルの世代、件数に続けて、
+ * 1件ごとに（ID, ステージ番号, クリアタイム, 記録日時, プレイヤー名, 位置, リプレイのバイト数, 入力リプレイのバイト数, 使用順）を格納します。
+ */
+class ReplayCodec {
+public:
+    static constexpr uint16_t FORMAT_VERSION = 2;
+    static constexpr uint16_t INPUT_FORMAT_VERSION = 1;
+    static constexpr uint16_t LIBRARY_FORMAT_VERSION = 2;
+    static constexpr size_t DEFAULT_KEYFRAME_INTERVAL = 50;  /**< @brief キーフレーム間隔（フレーム数） */
+    static constexpr size_t MAX_ITEMS = 1024;  /**< @brief アイテム数の上限（超えるデータは破損とみなし、エンコード時は切り捨てる） */
+
+    /**
+     * @brief シーク用インデックス
+     * @details readIndex()でヘッダーと末尾のインデックスだけを読み込んだ結果です。
+     */
+    struct SeekIndex {
+        struct Block {
+            size_t firstFrame = 0;       // 先頭フレームの番号
+            size_t frameCount = 0;
+            float firstTimestamp = 0.0f; // 先頭フレーム（キーフレーム）のタイムスタンプ
+            size_t offset = 0;           // データ先頭からのバイト位置
+            size_t length = 0;
+        };
+
+        ReplayData header;  // メタデータ（framesは空）
+        size_t frameCount = 0;
+        size_t itemCount = 0;
+        std::vector<Block> blocks;
+    };
+
+    /**
+     * @brief ストリーミング用のエンコーダー
+     * @details フレームを1つずつ受け取り、キーフレーム間隔ごとにブロックのバイト列を出力します。
+     * ヘッダーのフレーム数は固定長のvarint、記録日時は固定長の文字列で書き込むため、ヘッダーの大きさは
+     * 最初から変わりません。先頭に仮のヘッダー、続けてブロック、最後にインデックスを書き込み、
+     * 最後にヘッダーを書き直すと、encode()と同じ内容として読み込めるデータになります。
+     * フレームのバッファは使い回すため、ブロックの出力以外ではメモリを確保しません。
+     */
+    class StreamEncoder {
+    public:
+        static constexpr size_t RECORDED_DATE_LENGTH = 19;  /**< @brief 記録日時の長さ（"%Y-%m-%d %H:%M:%S"） */
+
+        /**
+         * @brief エンコードを開始する
+         * @param itemCount アイテム数（ステージのアイテム数）
+         * @param keyframeInterval キーフレーム間隔（フレーム数）
+         */
+        void begin(size_t itemCount, size_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+        /**
+         * @brief ヘッダーを作成する
+         * @details フレーム数はそれまでに追加した数です。記録日時はRECORDED_DATE_LENGTH文字に切り詰め・空白で埋めます。
+         * ステージ番号とフレーム数は値によらず同じ長さで書くため、大きさは常にgetHeaderSize()と同じです。
+         *
+         * @param header メタデータ（ステージ番号、クリアタイム、記録間隔、記録日時）
+         * @return ヘッダーのバイト列
+         */
+        std::vector<uint8_t> encodeHeader(const ReplayData& header) const;
+
+        /**
+         * @brief フレームを追加する
+         * @param frame フレーム（タイムスタンプ順）
+         * @param block 出力: ブロックのバイト列（ブロックがそろった場合）
+         * @return ブロックを出力した場合true
+         */
+        bool addFrame(const ReplayFrame& frame, std::vector<uint8_t>& block);
+
+        /**
+         * @brief 残りのフレームをブロックとして出力する
+         * @param block 出力: ブロックのバイト列
+         * @return ブロックを出力した場合true（残りのフレームがない場合false）
+         */
+        bool flush(std::vector<uint8_t>& block);
+
+        /**
+         * @brief インデックスとフッターを作成する
+         * @details flush()の後に呼び出します。ブロックの位置はヘッダーの直後から順に並べた場合のものです。
+         * @return インデックスとフッターのバイト列
+         */
+        std::vector<uint8_t> encodeIndex() const;
+
+        size_t getHeaderSize() const { return headerSize; }
+        size_t getFrameCount() const { return frameCount; }
+
+    private:
+        size_t itemCount = 0;
+        size_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL;
+        size_t headerSize = 0;
+        size_t frameCount = 0;
+        size_t bufferedCount = 0;
+        std::vector<ReplayFrame> buffer;
+        std::vector<size_t> blockOffsets;
+        std::vector<float> blockTimestamps;
+        size_t nextBlockOffset = 0;
+
+        void encodeBufferedBlock(std::vector<uint8_t>& block);
+    };
+
+    /**
+     * @brief ストリーミング用のデコーダー
+     * @details 受信したバイト列を先頭から順に受け取り、ヘッダーとブロックがそろった分だけフレームを復元します。
+     * インデックスは使わないため、ダウンロード中のデータから再生を始められます。
+     * ブロックの途中までしか受信していない場合は、続きを受け取るまで待ちます。
+     */
+    class StreamDecoder {
+    public:
+        /**
+         * @brief 受信したバイト列を追加する
+         * @param data バイト列
+         * @param size バイト数
+         */
+        void append(const uint8_t* data, size_t size);
+
+        /**
+         * @brief 受信済みのブロックを復元する
+         * @param frames 出力: 復元したフレームを末尾に追加する
+         * @return 追加したフレーム数
+         */
+        size_t decodeAvailable(std::vector<ReplayFrame>& frames);
+
+        /**
+         * @brief ヘッダーを読み込んだかどうか
+         * @return 読み込んだ場合true
+         */
+        bool hasHeader() const { return headerRead; }
+
+        /**
+         * @brief ヘッダーのメタデータ（ステージ番号、クリアタイム、記録間隔、記録日時）を取得する
+         * @return メタデータ（framesは空）
+         */
+        const ReplayData& getHeader() const { return header; }
+
+        /**
+         * @brief 全てのフレームを復元したかどうか
+         * @return 復元した場合true
+         */
+        bool isComplete() const { return headerRead && decodedCount == frameCount; }
+
+        /**
+         * @brief データが壊れているかどうか
+         * @details マジック・バージョンの不一致やヘッダーの破損を検出した場合trueです。
+         * ブロックの破損は続きを待っている状態と区別できないため、受信の終了時にisComplete()で判定してください。
+         * @return 壊れている場合true
+         */
+        bool hasFailed() const { return failed; }
+
+        size_t getFrameCount() const { return frameCount; }
+        size_t getDecodedCount() const { return decodedCount; }
+
+    private:
+        std::vector<uint8_t> bytes;  // 未処理のバイト列（復元したブロックの分は取り除く）
+        size_t readOffset = 0;
+        bool headerRead = false;
+        bool failed = false;
+        ReplayData header{};
+        size_t frameCount = 0;
+        size_t itemCount = 0;
+        size_t keyframeInterval = 0;
+        size_t decodedCount = 0;
+
+        bool readHeader();
+    };
+
+    /**
+     * @brief リプレイデータをバイナリ形式に変換する
+     * @details フレームごとのアイテム状態の数が異なる場合は、最大の数に揃えて未収集として扱います。
+     *
+     * @param replayData リプレイデータ
+     * @param keyframeInterval キーフレーム間隔（フレーム数）
+     * @return バイナリデータ
+     */
+    static std::vector<uint8_t> encode(const ReplayData& replayData, size_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    /**
+     * @brief バイナリ形式からリプレイデータを復元する
+     * @param data バイナリデータ
+     * @param size バイト数
+     * @param replayData 出力: リプレイデータ
+     * @return 成功時true（マジック・バージョンの不一致やデータの破損時はfalse）
+     */
+    static bool decode(const uint8_t* data, size_t size, ReplayData& replayData);
+
+    /**
+     * @brief ヘッダーとシーク用インデックスだけを読み込む
+     * @param data バイナリデータ
+     * @param size バイト数
+     * @param index 出力: シーク用インデックス
+     * @return 成功時true
+     */
+    static bool readIndex(const uint8_t* data, size_t size, SeekIndex& index);
+
+    /**
+     * @brief 指定時刻を含むブロックを探す
+     * @details 先頭タイムスタンプが指定時刻以下の最後のブロックを返します（指定時刻が最初より前なら0）。
+     *
+     * @param index シーク用インデックス
+     * @param timestamp 時刻
+     * @return ブロック番号
+     */
+    static size_t findBlock(const SeekIndex& index, float timestamp);
+
+    /**
+     * @brief 1ブロック分のフレームを復元する
+     * @param data バイナリデータ
+     * @param size バイト数
+     * @param index シーク用インデックス
+     * @param blockIndex ブロック番号
+     * @param frames 出力: ブロック内のフレーム
+     * @return 成功時true
+     */
+    static bool decodeBlock(const uint8_t* data, size_t size, const SeekIndex& index, size_t blockIndex,
+                            std::vector<ReplayFrame>& frames);
+
+    /**
+     * @brief 指定時刻のフレームを取得する
+     * @details キーフレーム1つとそこからの差分だけを復元し、指定時刻以前で最も新しいフレームを返します。
+     *
+     * @param data バイナリデータ
+     * @param size バイト数
+     * @param index シーク用インデックス
+     * @param timestamp 時刻
+     * @param frame 出力: フレーム
+     * @return 成功時true
+     */
+    static bool seek(const uint8_t* data, size_t size, const SeekIndex& index, float timestamp, ReplayFrame& frame);
+
+    /**
+     * @brief バイナリ形式かどうかを判定する
+     * @param data データ
+     * @param size バイト数
+     * @return 先頭がマジックと一致する場合true
+     */
+    static bool isBinary(const uint8_t* data, size_t size);
+
+    /**
+     * @brief 入力リプレイをバイナリ形式に変換する
+     * @param replay 入力リプレイ
+     * @return バイナリデータ
+     */
+    static std::vector<uint8_t> encodeInputs(const InputReplay& replay);
+
+    /**
+     * @brief バイナリ形式から入力リプレイを復元する
+     * @param data バイナリデータ
+     * @param size バイト数
+     * @param replay 出力: 入力リプレイ
+     * @return 成功時true（マジック・バージョンの不一致やデータの破損時はfalse）
+     */
+    static bool decodeInputs(const uint8_t* data, size_t size, InputReplay& replay);
+
+    /**
+     * @brief リプレイライブラリのインデックスをバイナリ形式に変換する
+     * @param entries ライブラリのエントリー
+     * @param packGeneration エントリーの位置が指すデータファイルの世代
+     * @return バイナリデータ
+     */
+    static std::vector<uint8_t> encodeLibraryIndex(const std::vector<ReplayLibraryEntry>& entries, uint32_t packGeneration);
+
+    /**
+     * @brief バイナリ形式からリプレイライブラリのインデックスを復元する
+     * @param data バイナリデータ
+     * @param size バイト数
+     * @param entries 出力: ライブラリのエントリー
+     * @param packGeneration 出力: データファイルの世代（世代を持たないバージョン1のインデックスは0）
+     * @return 成功時true（マジック・バージョンの不一致やデータの破損時はfalse）
+     */
+    static bool decodeLibraryIndex(const uint8_t* data, size_t size, std::vector<ReplayLibraryEntry>& entries,
+                                   uint32_t& packGeneration);
+
+    /**
+     * @brief 旧形式（JSON）からリプレイデータを読み込む
+     * @details 各フレームを"timestamp"、"playerPosition"、"playerVelocity"、"timeScale"、
+     * "itemCollectedStates"のオブジェクトとして持つ形式です。
+     *
+     * @param replayJson リプレイのJSON
+     * @param replayData 出力: リプレイデータ
+     * @return 成功時true
+     */
+    static bool fromJson(const nlohmann::json& replayJson, ReplayData& replayData);
+
+    /**
+     * @brief Base64文字列に変換する（JSONでの送受信用）
+     * @param data バイナリデータ
+     * @return Base64文字列
+     */
+    static std::string toBase64(const std::vector<uint8_t>& data);
+
+    /**
+     * @brief Base64文字列から復元する
+     * @param text Base64文字列
+     * @param data 出力: バイナリデータ
+     * @return 成功時true
+     */
+    static bool fromBase64(const std::string& text, std::vector<uint8_t>& data);
+};
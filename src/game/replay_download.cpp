@@ -0,0 +1,205 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_download.h"
+#include <cstdio>
+#include <nlohmann/json.hpp>
+
+namespace {
+    constexpr size_t BASE64_CHUNK = 4096;      // まとめてデコードするBase64の文字数（4の倍数）
+    constexpr size_t MAX_KEY_LENGTH = 16;      // キーの判定に使う文字列の最大長
+    constexpr const char* DATA_KEY = "data";
+
+    bool isWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+}
+
+bool ReplayDownload::append(const char* data, size_t size) {
+    if (cancelled.load()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    receivedBytes += size;
+    if (!dataFound) {
+        legacyBody.append(data, size);
+    }
+    scan(data, size);
+    if (dataFound) {
+        legacyBody.clear();
+        legacyBody.shrink_to_fit();
+    }
+    decodeBase64(false);
+    collectFrames();
+    return true;
+}
+
+void ReplayDownload::scan(const char* data, size_t size) {
+    for (size_t i = 0; i < size && !dataEnded; i++) {
+        char c = data[i];
+        if (inString) {
+            if (isEscaped) {
+                isEscaped = false;
+                if (isDataString && c == '/') {
+                    base64.push_back(c);  // "\/"はBase64の'/'
+                } else if (!isDataString && !lastStringTooLong) {
+                    lastString.push_back(c);
+                }
+            } else if (c == '\\') {
+                isEscaped = true;
+            } else if (c == '"') {
+                inString = false;
+                if (isDataString) {
+                    dataEnded = true;
+                }
+            } else if (isDataString) {
+                base64.push_back(c);
+            } else if (!lastStringTooLong) {
+                lastString.push_back(c);
+                lastStringTooLong = lastString.size() > MAX_KEY_LENGTH;
+            }
+            continue;
+        }
+
+        if (isWhitespace(c)) {
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+            isDataString = expectDataValue;
+            dataFound = dataFound || isDataString;
+            expectDataValue = false;
+            lastString.clear();
+            lastStringTooLong = false;
+        } else if (c == ':') {
+            expectDataValue = !lastStringTooLong && lastString == DATA_KEY;
+            lastString.clear();
+        } else {
+            expectDataValue = false;
+            lastString.clear();
+        }
+    }
+}
+
+void ReplayDownload::decodeBase64(bool final) {
+    size_t length = final ? base64.size() : (base64.size() / BASE64_CHUNK) * BASE64_CHUNK;
+    if (length == 0 || failed) {
+        return;
+    }
+
+    std::vector<uint8_t> bytes;
+    if (!ReplayCodec::fromBase64(base64.substr(0, length), bytes)) {
+        printf("ONLINE: Replay download has invalid base64 data\n");
+        failed = true;
+        return;
+    }
+    base64.erase(0, length);
+    decoder.append(bytes.data(), bytes.size());
+}
+
+void ReplayDownload::collectFrames() {
+    if (failed) {
+        return;
+    }
+    size_t before = pendingFrames.size();
+    decoder.decodeAvailable(pendingFrames);
+    if (decoder.hasFailed()) {
+        printf("ONLINE: Replay download is not a valid binary replay\n");
+        failed = true;
+        return;
+    }
+    if (pendingFrames.size() > before) {
+        bufferedTime = pendingFrames.back().timestamp;
+    }
+}
+
+void ReplayDownload::finish(bool success) {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    if (!success || cancelled.load()) {
+        failed = true;
+        return;
+    }
+
+    if (dataFound) {
+        decodeBase64(true);
+        collectFrames();
+        complete = !failed && decoder.isComplete();
+        failed = !complete;
+        if (failed) {
+            printf("ONLINE: Replay download ended with %zu of %zu frames\n", decoder.getDecodedCount(), decoder.getFrameCount());
+        }
+        return;
+    }
+
+    // 旧形式（フレームごとのJSON）はまとめて解析する
+    try {
+        auto json = nlohmann::json::parse(legacyBody);
+        if (json.value("success", false) && json.contains("replayData") &&
+            ReplayCodec::fromJson(json["replayData"], legacyReplay)) {
+            pendingFrames = std::move(legacyReplay.frames);
+            legacyReplay.frames.clear();
+            bufferedTime = pendingFrames.empty() ? -1.0f : pendingFrames.back().timestamp;
+            complete = true;
+        }
+    } catch (const std::exception& e) {
+        printf("ONLINE: Failed to parse replay JSON: %s\n", e.what());
+    }
+    legacyBody.clear();
+    failed = !complete;
+}
+
+void ReplayDownload::cancel() {
+    cancelled.store(true);
+}
+
+bool ReplayDownload::hasHeader() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return decoder.hasHeader() || complete;
+}
+
+ReplayData ReplayDownload::getHeader() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ReplayData header = decoder.hasHeader() ? decoder.getHeader() : legacyReplay;
+    header.frames.clear();
+    return header;
+}
+
+size_t ReplayDownload::takeFrames(std::vector<ReplayFrame>& frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = pendingFrames.size();
+    if (frames.empty()) {
+        frames.swap(pendingFrames);
+    } else {
+        frames.insert(frames.end(), std::make_move_iterator(pendingFrames.begin()), std::make_move_iterator(pendingFrames.end()));
+    }
+    pendingFrames.clear();
+    return count;
+}
+
+float ReplayDownload::getBufferedTime() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bufferedTime;
+}
+
+bool ReplayDownload::isComplete() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return complete;
+}
+
+bool ReplayDownload::hasFailed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+bool ReplayDownload::isFinished() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished;
+}
+
+size_t ReplayDownload::getReceivedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return receivedBytes;
+}
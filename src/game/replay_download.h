@@ -0,0 +1,128 @@
+/**
+ * @file replay_download.h
+ * @brief ダウンロード中のリプレイ
+ * @details オンラインから受信中のリプレイのレスポンスを少しずつ解析し、復元できたフレームから受け渡します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "replay_codec.h"
+
+/**
+ * @brief ダウンロード中のリプレイ
+ * @details リプレイ取得APIのレスポンス（{"success", "replayData": {..., "data": Base64, ...}}）を受信した順に受け取り、
+ * JSONの"data"の文字列だけを取り出してBase64をデコードし、ReplayCodec::StreamDecoderでフレームを復元します。
+ * レスポンス全体をJSONとして解析しないため、受信の途中からフレームを取り出せます。
+ * "data"のない旧形式（フレームごとのJSON）の場合は、受信の終了時にまとめて解析します。
+ *
+ * append()・finish()は受信スレッド、それ以外はメインスレッドから呼び出します（内部でロックします）。
+ */
+class ReplayDownload {
+public:
+    static constexpr float PREBUFFER_SECONDS = 3.0f;  /**< @brief 再生を始めるまでに受信しておく再生時間（秒） */
+    static constexpr float RESUME_BUFFER_SECONDS = 1.0f;  /**< @brief 受信待ちで止まった後、再開するまでに受信しておく再生時間（秒） */
+
+    /**
+     * @brief 受信したレスポンスの一部を追加する
+     * @param data データ
+     * @param size バイト数
+     * @return 受信を続ける場合true（cancel()された場合false）
+     */
+    bool append(const char* data, size_t size);
+
+    /**
+     * @brief 受信を終了する
+     * @param success 最後まで受信できた場合true
+     */
+    void finish(bool success);
+
+    /**
+     * @brief 受信を取り消す
+     * @details 以降のappend()はfalseを返します（受信スレッドは通信を中断します）。
+     */
+    void cancel();
+
+    bool isCancelled() const { return cancelled.load(); }
+
+    /**
+     * @brief リプレイのヘッダーを受信したかどうか
+     * @return 受信した場合true
+     */
+    bool hasHeader() const;
+
+    /**
+     * @brief リプレイのメタデータを取得する
+     * @return メタデータ（ステージ番号、クリアタイム、記録間隔、記録日時。framesは空）
+     */
+    ReplayData getHeader() const;
+
+    /**
+     * @brief 復元したフレームを受け取る
+     * @details 前回以降に復元したフレームをframesの末尾に追加します。
+     * @param frames 出力: フレーム
+     * @return 追加したフレーム数
+     */
+    size_t takeFrames(std::vector<ReplayFrame>& frames);
+
+    /**
+     * @brief 復元済みのフレームのうち最後のタイムスタンプを取得する（受け取り済みのものを含む）
+     * @return タイムスタンプ（フレームがない場合は負の値）
+     */
+    float getBufferedTime() const;
+
+    /**
+     * @brief 全てのフレームを復元したかどうか
+     * @return 受信が正常に終了し、全てのフレームを復元した場合true
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief 受信または解析に失敗したかどうか
+     * @return 失敗した場合true
+     */
+    bool hasFailed() const;
+
+    /**
+     * @brief 受信を終えたかどうか（成功・失敗を問わない）
+     * @return 終えた場合true
+     */
+    bool isFinished() const;
+
+    size_t getReceivedBytes() const;
+
+private:
+    mutable std::mutex mutex;
+    std::atomic<bool> cancelled{false};
+
+    // JSONの走査
+    bool inString = false;
+    bool isEscaped = false;
+    bool isDataString = false;   // 現在の文字列が"data"の値
+    bool expectDataValue = false;  // "data":の直後
+    bool dataFound = false;
+    bool dataEnded = false;
+    std::string lastString;      // 直前に読んだ文字列（キーの判定用、短いものだけ）
+    bool lastStringTooLong = false;
+    std::string base64;          // デコード待ちのBase64文字
+    std::string legacyBody;      // "data"が見つかるまでのレスポンス（旧形式の解析用）
+
+    ReplayCodec::StreamDecoder decoder;
+    ReplayData legacyReplay;
+    std::vector<ReplayFrame> pendingFrames;
+    float bufferedTime = -1.0f;
+    size_t receivedBytes = 0;
+    bool finished = false;
+    bool failed = false;
+    bool complete = false;
+
+    void scan(const char* data, size_t size);
+    void decodeBase64(bool final);
+    void collectFrames();
+};
@@ -0,0 +1,406 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_library.h"
+#include "replay_codec.h"
+#include "replay_manager.h"
+#include "../core/error_handler.h"
+#include "../core/utils/mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace {
+    constexpr const char* PACK_FILE_STEM = "library";  // データファイルは library.slpk（世代0）、library.<世代>.slpk
+    constexpr const char* PACK_FILE_EXTENSION = ".slpk";
+    constexpr const char* INDEX_FILE_NAME = "library.sldx";
+    constexpr uint64_t MIN_COMPACT_BYTES = 1024 * 1024;  // これより小さいデータファイルは詰め直さない
+
+    struct LibraryState {
+        std::mutex mutex;
+        bool isLoaded = false;
+        bool isIndexDirty = false;
+        std::string directory;
+        std::string packPath;    // 現在の世代のデータファイル
+        std::string indexPath;
+        uint32_t packGeneration = 0;  // データファイルを詰め直すたびに増やし、インデックスに記録する
+        std::vector<ReplayLibraryEntry> entries;
+        uint32_t nextId = 1;
+        uint64_t useCounter = 0;
+        uint64_t packSize = 0;   // データファイルの大きさ
+        uint64_t liveBytes = 0;  // データファイルのうち、インデックスから参照している部分の大きさ
+        MappedFile pack;
+    };
+
+    LibraryState library;
+
+    uint64_t entryBytes(const ReplayLibraryEntry& entry) {
+        return static_cast<uint64_t>(entry.replaySize) + entry.inputSize;
+    }
+
+    bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+        // 書き込み中に終了しても古いファイルが残るよう、一時ファイルに書いてから置き換える
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!file) {
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        return !error;
+    }
+
+    std::string getPackPath(uint32_t generation) {
+        if (generation == 0) {
+            return library.directory + "/" + PACK_FILE_STEM + PACK_FILE_EXTENSION;
+        }
+        return library.directory + "/" + PACK_FILE_STEM + "." + std::to_string(generation) + PACK_FILE_EXTENSION;
+    }
+
+    bool writeIndex() {
+        if (!writeFile(library.indexPath, ReplayCodec::encodeLibraryIndex(library.entries, library.packGeneration))) {
+            ErrorHandler::logErrorFormat("Failed to write replay library index: %s", library.indexPath.c_str());
+            return false;
+        }
+        library.isIndexDirty = false;
+        return true;
+    }
+
+    void ensureLoaded() {
+        if (library.isLoaded) {
+            return;
+        }
+        library.isLoaded = true;
+
+        library.directory = ReplayManager::prepareReplayDirectory();
+        library.packPath = getPackPath(0);
+        library.indexPath = library.directory + "/" + INDEX_FILE_NAME;
+
+        std::vector<ReplayLibraryEntry> entries;
+        {
+            MappedFile indexFile;
+            uint32_t generation = 0;
+            if (indexFile.open(library.indexPath)) {
+                if (ReplayCodec::decodeLibraryIndex(indexFile.data(), indexFile.size(), entries, generation)) {
+                    library.packGeneration = generation;
+                    library.packPath = getPackPath(generation);
+                } else {
+                    ErrorHandler::logErrorFormat("Failed to decode replay library index: %s", library.indexPath.c_str());
+                    entries.clear();
+                }
+            }
+        }
+
+        std::error_code error;
+        uint64_t packSize = std::filesystem::exists(library.packPath, error) ? std::filesystem::file_size(library.packPath, error) : 0;
+        library.packSize = error ? 0 : packSize;
+
+        // 詰め直しの途中で終了した場合に残る、インデックスが指していない世代のデータファイルを削除する
+        if (library.packGeneration > 0) {
+            std::filesystem::remove(getPackPath(library.packGeneration - 1), error);
+        }
+        std::filesystem::remove(getPackPath(library.packGeneration + 1), error);
+
+        for (const auto& entry : entries) {
+            // データファイルの範囲外を指すもの（データファイルの書き込み中に終了した場合など）は読み込まない
+            if (entry.offset + entryBytes(entry) > library.packSize) {
+                continue;
+            }
+            library.entries.push_back(entry);
+            library.liveBytes += entryBytes(entry);
+            library.nextId = std::max(library.nextId, entry.id + 1);
+            library.useCounter = std::max(library.useCounter, entry.lastUsed);
+        }
+        printf("REPLAY: Loaded replay library (%zu replays, %llu bytes)\n",
+               library.entries.size(), static_cast<unsigned long long>(library.liveBytes));
+    }
+
+    bool mapPack() {
+        if (library.pack.isOpen() && library.pack.size() == library.packSize) {
+            return true;
+        }
+        if (!library.pack.open(library.packPath)) {
+            ErrorHandler::logErrorFormat("Failed to map replay library: %s", library.packPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<ReplayLibraryEntry>::iterator findEntry(uint32_t id) {
+        return std::find_if(library.entries.begin(), library.entries.end(),
+                            [id](const ReplayLibraryEntry& entry) { return entry.id == id; });
+    }
+
+    const ReplayLibraryEntry* findBestEntry(int stageNumber) {
+        const ReplayLibraryEntry* best = nullptr;
+        for (const auto& entry : library.entries) {
+            if (entry.stageNumber == stageNumber && (best == nullptr || entry.clearTime < best->clearTime)) {
+                best = &entry;
+            }
+        }
+        return best;
+    }
+
+    void removeEntry(std::vector<ReplayLibraryEntry>::iterator it) {
+        library.liveBytes -= entryBytes(*it);
+        library.entries.erase(it);
+        library.isIndexDirty = true;
+    }
+
+    /**
+     * @brief 使っていない部分を除いてデータファイルを作り直す
+     * @details 詰め直したデータは次の世代のデータファイルに書き、その世代を記録したインデックスを保存してから
+     * 古いデータファイルを削除します。どの時点で終了しても、インデックスと指しているデータファイルは一致します。
+     */
+    void compact() {
+        if (!mapPack()) {
+            return;
+        }
+
+        std::vector<ReplayLibraryEntry*> ordered;
+        for (auto& entry : library.entries) {
+            ordered.push_back(&entry);
+        }
+        std::sort(ordered.begin(), ordered.end(),
+                  [](const ReplayLibraryEntry* a, const ReplayLibraryEntry* b) { return a->offset < b->offset; });
+
+        std::vector<uint8_t> bytes;
+        bytes.reserve(static_cast<size_t>(library.liveBytes));
+        std::vector<uint64_t> offsets;
+        for (const auto* entry : ordered) {
+            offsets.push_back(bytes.size());
+            const uint8_t* begin = library.pack.data() + entry->offset;
+            bytes.insert(bytes.end(), begin, begin + entryBytes(*entry));
+        }
+
+        // Windowsではマップ中のファイルを削除できないため、先にマップを解除する
+        library.pack.close();
+        uint32_t previousGeneration = library.packGeneration;
+        std::string previousPath = library.packPath;
+        std::string nextPath = getPackPath(previousGeneration + 1);
+        if (!writeFile(nextPath, bytes)) {
+            ErrorHandler::logErrorFormat("Failed to compact replay library: %s", nextPath.c_str());
+            return;
+        }
+
+        std::vector<uint64_t> previousOffsets;
+        for (size_t i = 0; i < ordered.size(); i++) {
+            previousOffsets.push_back(ordered[i]->offset);
+            ordered[i]->offset = offsets[i];
+        }
+        library.packGeneration = previousGeneration + 1;
+        library.packPath = nextPath;
+        if (!writeIndex()) {
+            // インデックスは古い世代のデータファイルを指したままのため、元に戻す
+            for (size_t i = 0; i < ordered.size(); i++) {
+                ordered[i]->offset = previousOffsets[i];
+            }
+            library.packGeneration = previousGeneration;
+            library.packPath = previousPath;
+            std::error_code error;
+            std::filesystem::remove(nextPath, error);
+            return;
+        }
+
+        std::error_code error;
+        std::filesystem::remove(previousPath, error);
+        uint64_t previousSize = library.packSize;
+        library.packSize = bytes.size();
+        printf("REPLAY: Compacted replay library (%llu -> %llu bytes)\n",
+               static_cast<unsigned long long>(previousSize), static_cast<unsigned long long>(library.packSize));
+    }
+
+    /**
+     * @brief 上限を超えた分を使った順の古いものから削除する
+     */
+    void evict() {
+        while (library.entries.size() > ReplayLibrary::MAX_ENTRIES || library.liveBytes > ReplayLibrary::MAX_LIBRARY_BYTES) {
+            auto oldest = library.entries.end();
+            for (auto it = library.entries.begin(); it != library.entries.end(); ++it) {
+                if (&*it == findBestEntry(it->stageNumber)) {
+                    continue;
+                }
+                if (oldest == library.entries.end() || it->lastUsed < oldest->lastUsed) {
+                    oldest = it;
+                }
+            }
+            if (oldest == library.entries.end()) {
+                break;
+            }
+            removeEntry(oldest);
+        }
+
+        uint64_t deadBytes = library.packSize - library.liveBytes;
+        if (library.packSize >= MIN_COMPACT_BYTES && deadBytes > library.liveBytes) {
+            compact();
+        }
+    }
+}
+
+uint32_t ReplayLibrary::add(const ReplayData& replayData, const std::string& playerName) {
+    if (replayData.frames.empty()) {
+        return 0;
+    }
+
+    // エンコードはロックの外で行う
+    std::vector<uint8_t> replayBytes = ReplayCodec::encode(replayData);
+    std::vector<uint8_t> inputBytes;
+    if (!replayData.inputs.inputs.empty()) {
+        inputBytes = ReplayCodec::encodeInputs(replayData.inputs);
+    }
+
+    std::lock_guard<std::mutex> lock(library.mutex);
+    try {
+        ensureLoaded();
+
+        // Windowsではマップ中のファイルに書き込めないため、先にマップを解除する（次のload()でマップし直す）
+        library.pack.close();
+        std::ofstream file(library.packPath, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            ErrorHandler::logErrorFormat("Failed to open replay library for writing: %s", library.packPath.c_str());
+            return 0;
+        }
+        // 前回の書き込みが途中で終わっていても、実際の末尾に追記する
+        file.seekp(0, std::ios::end);
+        uint64_t offset = static_cast<uint64_t>(file.tellp());
+        file.write(reinterpret_cast<const char*>(replayBytes.data()), static_cast<std::streamsize>(replayBytes.size()));
+        file.write(reinterpret_cast<const char*>(inputBytes.data()), static_cast<std::streamsize>(inputBytes.size()));
+        file.close();
+        if (file.fail()) {
+            ErrorHandler::logErrorFormat("Failed to write replay library: %s", library.packPath.c_str());
+            return 0;
+        }
+
+        ReplayLibraryEntry entry;
+        entry.id = library.nextId++;
+        entry.stageNumber = replayData.stageNumber;
+        entry.clearTime = replayData.clearTime;
+        entry.recordedDate = replayData.recordedDate;
+        entry.playerName = playerName;
+        entry.offset = offset;
+        entry.replaySize = static_cast<uint32_t>(replayBytes.size());
+        entry.inputSize = static_cast<uint32_t>(inputBytes.size());
+        entry.lastUsed = ++library.useCounter;
+        library.entries.push_back(entry);
+        library.packSize = offset + entryBytes(entry);
+        library.liveBytes += entryBytes(entry);
+
+        evict();
+        writeIndex();
+
+        printf("REPLAY: Added replay %u to library (stage %d, %.2fs, %u bytes, %zu replays)\n",
+               entry.id, entry.stageNumber, entry.clearTime, static_cast<uint32_t>(entryBytes(entry)), library.entries.size());
+        return entry.id;
+    } catch (const std::exception& e) {
+        ErrorHandler::logErrorFormat("Failed to add replay to library: %s", e.what());
+        return 0;
+    }
+}
+
+std::vector<ReplayLibraryEntry> ReplayLibrary::list(int stageNumber, SortKey sortKey) {
+    std::lock_guard<std::mutex> lock(library.mutex);
+    ensureLoaded();
+
+    std::vector<ReplayLibraryEntry> result;
+    for (const auto& entry : library.entries) {
+        if (stageNumber < 0 || entry.stageNumber == stageNumber) {
+            result.push_back(entry);
+        }
+    }
+
+    switch (sortKey) {
+        case SortKey::ClearTime:
+            std::stable_sort(result.begin(), result.end(),
+                             [](const ReplayLibraryEntry& a, const ReplayLibraryEntry& b) { return a.clearTime < b.clearTime; });
+            break;
+        case SortKey::RecordedDate:
+            // 記録日時は"%Y-%m-%d %H:%M:%S"のため、文字列の比較で並べられる
+            std::stable_sort(result.begin(), result.end(),
+                             [](const ReplayLibraryEntry& a, const ReplayLibraryEntry& b) { return a.recordedDate > b.recordedDate; });
+            break;
+        case SortKey::LastUsed:
+            std::stable_sort(result.begin(), result.end(),
+                             [](const ReplayLibraryEntry& a, const ReplayLibraryEntry& b) { return a.lastUsed > b.lastUsed; });
+            break;
+    }
+    return result;
+}
+
+bool ReplayLibrary::findBest(int stageNumber, ReplayLibraryEntry& entry) {
+    std::lock_guard<std::mutex> lock(library.mutex);
+    ensureLoaded();
+
+    const ReplayLibraryEntry* best = findBestEntry(stageNumber);
+    if (best == nullptr) {
+        return false;
+    }
+    entry = *best;
+    return true;
+}
+
+bool ReplayLibrary::load(uint32_t id, ReplayData& replayData) {
+    std::lock_guard<std::mutex> lock(library.mutex);
+    ensureLoaded();
+
+    auto it = findEntry(id);
+    if (it == library.entries.end() || !mapPack()) {
+        return false;
+    }
+    if (it->offset + entryBytes(*it) > library.pack.size()) {
+        ErrorHandler::logErrorFormat("Replay %u is outside the replay library", id);
+        return false;
+    }
+
+    const uint8_t* data = library.pack.data() + it->offset;
+    ReplayData result;
+    if (!ReplayCodec::decode(data, it->replaySize, result)) {
+        ErrorHandler::logErrorFormat("Failed to decode replay %u in the replay library", id);
+        return false;
+    }
+    result.inputs = InputReplay();
+    if (it->inputSize > 0 && !ReplayCodec::decodeInputs(data + it->replaySize, it->inputSize, result.inputs)) {
+        ErrorHandler::logErrorFormat("Failed to decode input replay %u in the replay library", id);
+        result.inputs = InputReplay();
+    }
+
+    it->lastUsed = ++library.useCounter;
+    library.isIndexDirty = true;
+    replayData = std::move(result);
+    return true;
+}
+
+bool ReplayLibrary::remove(uint32_t id) {
+    std::lock_guard<std::mutex> lock(library.mutex);
+    ensureLoaded();
+
+    auto it = findEntry(id);
+    if (it == library.entries.end()) {
+        return false;
+    }
+    removeEntry(it);
+    evict();
+    writeIndex();
+    return true;
+}
+
+size_t ReplayLibrary::count() {
+    std::lock_guard<std::mutex> lock(library.mutex);
+    ensureLoaded();
+    return library.entries.size();
+}
+
+void ReplayLibrary::flush() {
+    std::lock_guard<std::mutex> lock(library.mutex);
+    if (library.isLoaded && library.isIndexDirty) {
+        writeIndex();
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @file replay_library.h
+ * @brief ローカルのリプレイライブラリ
+ * @details タイムアタックの全ての走行のリプレイを1つのデータファイルにまとめて保存し、
+ * メタデータの一覧をインデックスファイルで管理します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_state.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief ローカルのリプレイライブラリ
+ * @details リプレイ本体はデータファイル（library.slpk、詰め直した後はlibrary.<世代>.slpk）に追記し、ステージ・クリアタイム・記録日時・
+ * プレイヤー名・データファイル内の位置をインデックスファイル（library.sldx）に保存します。
+ * インデックスは最初の使用時にメモリに読み込むため、一覧の取得や並べ替えでリプレイのファイルを読みません。
+ * リプレイ本体はデータファイルをメモリマップして、必要な部分だけを読み込みます。
+ *
+ * 件数がMAX_ENTRIES、データの合計がMAX_LIBRARY_BYTESを超えた場合は、最後に使ってから最も時間が経ったもの（LRU）
+ * から削除します。ただし、ステージごとの最速のリプレイは削除しません。削除した分はデータファイルに残り、
+ * 使っていない部分が半分を超えたらデータファイルを詰め直します。
+ * 詰め直したデータは次の世代のデータファイルに書き、インデックスにはどの世代を指しているかを記録します。
+ *
+ * 全ての関数はスレッドセーフです（ReplayStreamWriterの書き込みスレッドから追加し、メインスレッドから参照します）。
+ */
+class ReplayLibrary {
+public:
+    static constexpr size_t MAX_ENTRIES = 500;  /**< @brief 保存する最大件数 */
+    static constexpr uint64_t MAX_LIBRARY_BYTES = 64ull * 1024 * 1024;  /**< @brief 保存するリプレイの合計の上限（バイト） */
+
+    /**
+     * @brief 一覧の並べ替えの基準
+     */
+    enum class SortKey {
+        ClearTime,     // クリアタイムの短い順
+        RecordedDate,  // 記録日時の新しい順
+        LastUsed       // 最後に使った順
+    };
+
+    /**
+     * @brief リプレイを追加する
+     * @details 追加後、上限を超えていれば古いリプレイを削除します。
+     *
+     * @param replayData リプレイデータ（入力リプレイがあれば一緒に保存する）
+     * @param playerName プレイヤー名
+     * @return 追加したリプレイのID（失敗時は0）
+     */
+    static uint32_t add(const ReplayData& replayData, const std::string& playerName);
+
+    /**
+     * @brief リプレイの一覧を取得する
+     * @param stageNumber ステージ番号（負の値の場合は全ステージ）
+     * @param sortKey 並べ替えの基準
+     * @return メタデータの一覧
+     */
+    static std::vector<ReplayLibraryEntry> list(int stageNumber, SortKey sortKey = SortKey::ClearTime);
+
+    /**
+     * @brief ステージの最速のリプレイを探す
+     * @param stageNumber ステージ番号
+     * @param entry 出力: メタデータ
+     * @return 見つかった場合true
+     */
+    static bool findBest(int stageNumber, ReplayLibraryEntry& entry);
+
+    /**
+     * @brief リプレイを読み込む
+     * @details 読み込んだリプレイは最後に使ったものとして扱います（使用順はflush()または次の追加時に保存します）。
+     *
+     * @param id リプレイのID
+     * @param replayData 出力: リプレイデータ
+     * @return 成功時true
+     */
+    static bool load(uint32_t id, ReplayData& replayData);
+
+    /**
+     * @brief リプレイを削除する
+     * @param id リプレイのID
+     * @return 削除した場合true
+     */
+    static bool remove(uint32_t id);
+
+    /**
+     * @brief 保存しているリプレイの件数を取得する
+     * @return 件数
+     */
+    static size_t count();
+
+    /**
+     * @brief 保存していない使用順をインデックスファイルに書き込む
+     * @details アプリケーションの終了時に呼び出します。
+     */
+    static void flush();
+};
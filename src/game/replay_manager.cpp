@@ -3,8 +3,14 @@
 #endif
 
 #include "replay_manager.h"
+#include "replay_codec.h"
+#include "replay_stream_writer.h"
+#include "replay_library.h"
 #include "../core/error_handler.h"
+#include <filesystem>
 #include <fstream>
+#include <cstdio>
+#include <iterator>
 #include <iostream>
 #include <ctime>
 #include <iomanip>
@@ -19,11 +25,32 @@
 #endif
 
 bool ReplayManager::fileExists(const std::string& filename) {
-    std::ifstream file(filename);
-    return file.good();
+    // ファイルを開かずに確認する
+    std::error_code error;
+    return std::filesystem::is_regular_file(filename, error);
 }
 
 std::string ReplayManager::getReplayFilePath(int stageNumber) {
+    std::string filename = "assets/replays/stage" + std::to_string(stageNumber) + "_best.slrp";
+    
+    if (!fileExists(filename)) {
+        filename = "../assets/replays/stage" + std::to_string(stageNumber) + "_best.slrp";
+    }
+    
+    return filename;
+}
+
+std::string ReplayManager::getInputReplayFilePath(int stageNumber) {
+    std::string filename = "assets/replays/stage" + std::to_string(stageNumber) + "_best.slin";
+    
+    if (!fileExists(filename)) {
+        filename = "../assets/replays/stage" + std::to_string(stageNumber) + "_best.slin";
+    }
+    
+    return filename;
+}
+
+std::string ReplayManager::getLegacyReplayFilePath(int stageNumber) {
     std::string filename = "assets/replays/stage" + std::to_string(stageNumber) + "_best.json";
     
     if (!fileExists(filename)) {
@@ -34,75 +61,86 @@ std::string ReplayManager::getReplayFilePath(int stageNumber) {
 }
 
 bool ReplayManager::replayExists(int stageNumber) {
-    std::string filepath = getReplayFilePath(stageNumber);
-    return fileExists(filepath);
+    ReplayLibraryEntry best;
+    return fileExists(getReplayFilePath(stageNumber)) || fileExists(getLegacyReplayFilePath(stageNumber)) ||
+           ReplayLibrary::findBest(stageNumber, best);
 }
 
-bool ReplayManager::saveReplay(const ReplayData& replayData, int stageNumber) {
-    try {
-        std::string dirPath = "assets/replays";
+std::string ReplayManager::prepareReplayFilePath(int stageNumber) {
+    prepareReplayDirectory();
+    return getReplayFilePath(stageNumber);
+}
+
+std::string ReplayManager::prepareReplayDirectory() {
+    std::string dirPath = "assets/replays";
+    #ifdef _WIN32
+        if (_access(dirPath.c_str(), 0) != 0) {
+            _mkdir(dirPath.c_str());
+        }
+    #else
+        struct stat info;
+        if (stat(dirPath.c_str(), &info) != 0) {
+            mkdir(dirPath.c_str(), 0755);
+        }
+    #endif
+    
+    if (!fileExists(dirPath + "/.gitkeep")) {
+        dirPath = "../assets/replays";
         #ifdef _WIN32
             if (_access(dirPath.c_str(), 0) != 0) {
                 _mkdir(dirPath.c_str());
             }
         #else
-            struct stat info;
             if (stat(dirPath.c_str(), &info) != 0) {
                 mkdir(dirPath.c_str(), 0755);
             }
         #endif
+    }
+    
+    return dirPath;
+}
+
+void ReplayManager::saveInputReplay(const std::string& replayFilePath, const InputReplay& inputs, int stageNumber) {
+    std::string inputPath = replayFilePath.substr(0, replayFilePath.size() - 5) + ".slin";
+    if (inputs.inputs.empty()) {
+        // 古い走行の入力リプレイが残らないようにする
+        std::remove(inputPath.c_str());
+        return;
+    }
+    
+    std::vector<uint8_t> inputBytes = ReplayCodec::encodeInputs(inputs);
+    std::ofstream inputFile(inputPath, std::ios::binary);
+    if (inputFile.is_open()) {
+        inputFile.write(reinterpret_cast<const char*>(inputBytes.data()), static_cast<std::streamsize>(inputBytes.size()));
+        printf("REPLAY: Saved input replay for stage %d (%zu ticks, %zu bytes)\n",
+               stageNumber, inputs.inputs.size(), inputBytes.size());
+    } else {
+        ErrorHandler::logErrorFormat("Failed to open input replay file for writing: %s", inputPath.c_str());
+    }
+}
+
+bool ReplayManager::saveReplay(const ReplayData& replayData, int stageNumber) {
+    try {
+        std::vector<uint8_t> bytes = ReplayCodec::encode(replayData);
         
-        if (!fileExists(dirPath + "/.gitkeep")) {
-            dirPath = "../assets/replays";
-            #ifdef _WIN32
-                if (_access(dirPath.c_str(), 0) != 0) {
-                    _mkdir(dirPath.c_str());
-                }
-            #else
-                if (stat(dirPath.c_str(), &info) != 0) {
-                    mkdir(dirPath.c_str(), 0755);
-                }
-            #endif
-        }
-        
-        nlohmann::json jsonData;
-        jsonData["stageNumber"] = replayData.stageNumber;
-        jsonData["clearTime"] = replayData.clearTime;
-        jsonData["recordedDate"] = replayData.recordedDate;
-        jsonData["frameRate"] = replayData.frameRate;
-        
-        nlohmann::json framesArray = nlohmann::json::array();
-        for (const auto& frame : replayData.frames) {
-            nlohmann::json frameJson;
-            frameJson["timestamp"] = frame.timestamp;
-            frameJson["playerPosition"] = {frame.playerPosition.x, frame.playerPosition.y, frame.playerPosition.z};
-            frameJson["playerVelocity"] = {frame.playerVelocity.x, frame.playerVelocity.y, frame.playerVelocity.z};
-            frameJson["timeScale"] = frame.timeScale;
-            
-            if (!frame.itemCollectedStates.empty()) {
-                frameJson["itemCollectedStates"] = frame.itemCollectedStates;
-            }
-            
-            framesArray.push_back(frameJson);
-        }
-        jsonData["frames"] = framesArray;
-        
-        std::string filepath = getReplayFilePath(stageNumber);
-        std::ofstream file(filepath);
+        std::string filepath = prepareReplayFilePath(stageNumber);
+        std::ofstream file(filepath, std::ios::binary);
         if (!file.is_open()) {
-            filepath = "../assets/replays/stage" + std::to_string(stageNumber) + "_best.json";
-            file.open(filepath);
+            filepath = "../assets/replays/stage" + std::to_string(stageNumber) + "_best.slrp";
+            file.open(filepath, std::ios::binary);
             if (!file.is_open()) {
                 ErrorHandler::logErrorFormat("Failed to open replay file for writing: %s", filepath.c_str());
                 return false;
             }
         }
         
-        file << jsonData.dump(2);  // インデント付きで保存
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
         file.close();
         
-        printf("REPLAY: Saved replay for stage %d (%zu frames, %.2fs)\n", 
-               stageNumber, replayData.frames.size(), replayData.clearTime);
+        printf("REPLAY: Saved replay for stage %d (%zu frames, %.2fs, %zu bytes)\n", 
+               stageNumber, replayData.frames.size(), replayData.clearTime, bytes.size());
+        
+        saveInputReplay(filepath, replayData.inputs, stageNumber);
         return true;
         
     } catch (const std::exception& e) {
@@ -112,59 +150,66 @@ bool ReplayManager::saveReplay(const ReplayData& replayData, int stageNumber) {
 }
 
 bool ReplayManager::loadReplay(ReplayData& replayData, int stageNumber) {
+    // 書き込みスレッドが保存中のリプレイを先に書き終える
+    ReplayStreamWriter::waitIdle();
     try {
         std::string filepath = getReplayFilePath(stageNumber);
-        if (!fileExists(filepath)) {
-            printf("REPLAY: Replay file not found: %s\n", filepath.c_str());
-            return false;
-        }
-        
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            ErrorHandler::logErrorFormat("Failed to open replay file: %s", filepath.c_str());
-            return false;
+        if (fileExists(filepath)) {
+            std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) {
+                ErrorHandler::logErrorFormat("Failed to open replay file: %s", filepath.c_str());
+                return false;
+            }
+            
+            // ファイル全体を一度に読み込んでからデコードする
+            std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            file.close();
+            
+            if (!ReplayCodec::decode(bytes.data(), bytes.size(), replayData)) {
+                ErrorHandler::logErrorFormat("Failed to decode replay file: %s", filepath.c_str());
+                return false;
+            }
+        } else {
+            // 旧形式（JSON）のリプレイを読み込む
+            filepath = getLegacyReplayFilePath(stageNumber);
+            if (!fileExists(filepath)) {
+                // 自己ベストのファイルがない場合は、リプレイライブラリの最速のリプレイを使う
+                ReplayLibraryEntry best;
+                if (ReplayLibrary::findBest(stageNumber, best) && ReplayLibrary::load(best.id, replayData)) {
+                    printf("REPLAY: Loaded replay for stage %d from library (%zu frames, %.2fs)\n",
+                           stageNumber, replayData.frames.size(), replayData.clearTime);
+                    return true;
+                }
+                printf("REPLAY: Replay file not found: %s\n", filepath.c_str());
+                return false;
+            }
+            
+            std::ifstream file(filepath);
+            if (!file.is_open()) {
+                ErrorHandler::logErrorFormat("Failed to open replay file: %s", filepath.c_str());
+                return false;
+            }
+            
+            nlohmann::json jsonData;
+            file >> jsonData;
+            file.close();
+            
+            if (!ReplayCodec::fromJson(jsonData, replayData)) {
+                ErrorHandler::logErrorFormat("Failed to parse replay file: %s", filepath.c_str());
+                return false;
+            }
         }
         
-        nlohmann::json jsonData;
-        file >> jsonData;
-        file.close();
-        
-        replayData.stageNumber = jsonData["stageNumber"].get<int>();
-        replayData.clearTime = jsonData["clearTime"].get<float>();
-        replayData.recordedDate = jsonData["recordedDate"].get<std::string>();
-        replayData.frameRate = jsonData.contains("frameRate") ? jsonData["frameRate"].get<float>() : 0.1f;
-        
-        replayData.frames.clear();
-        if (jsonData.contains("frames") && jsonData["frames"].is_array()) {
-            for (const auto& frameJson : jsonData["frames"]) {
-                ReplayFrame frame;
-                frame.timestamp = frameJson["timestamp"].get<float>();
-                
-                auto pos = frameJson["playerPosition"];
-                frame.playerPosition = glm::vec3(
-                    pos[0].get<float>(),
-                    pos[1].get<float>(),
-                    pos[2].get<float>()
-                );
-                
-                auto vel = frameJson["playerVelocity"];
-                frame.playerVelocity = glm::vec3(
-                    vel[0].get<float>(),
-                    vel[1].get<float>(),
-                    vel[2].get<float>()
-                );
-                
-                // timeScaleは後方互換性のため、存在しない場合は1.0fをデフォルト値とする
-                frame.timeScale = frameJson.contains("timeScale") ? frameJson["timeScale"].get<float>() : 1.0f;
-                
-                if (frameJson.contains("itemCollectedStates") && frameJson["itemCollectedStates"].is_array()) {
-                    frame.itemCollectedStates.clear();
-                    for (const auto& state : frameJson["itemCollectedStates"]) {
-                        frame.itemCollectedStates.push_back(state.get<bool>());
-                    }
-                }
-                
-                replayData.frames.push_back(frame);
+        replayData.inputs = InputReplay();
+        std::string inputPath = getInputReplayFilePath(stageNumber);
+        if (fileExists(inputPath)) {
+            std::ifstream inputFile(inputPath, std::ios::binary);
+            std::vector<uint8_t> inputBytes((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+            if (!ReplayCodec::decodeInputs(inputBytes.data(), inputBytes.size(), replayData.inputs)) {
+                ErrorHandler::logErrorFormat("Failed to decode input replay file: %s", inputPath.c_str());
+                replayData.inputs = InputReplay();
             }
         }
         
@@ -177,4 +222,3 @@ bool ReplayManager::loadReplay(ReplayData& replayData, int stageNumber) {
         return false;
     }
 }
-
@@ -2,6 +2,8 @@
  * @file replay_manager.h
  * @brief リプレイマネージャー
  * @details リプレイデータの保存と読み込みを管理します。
+ * 保存はバイナリ形式（ReplayCodec）で行い、旧形式（JSON）のファイルも読み込めます。
+ * 入力リプレイがある場合は別ファイル（.slin）に保存します。
  */
 #pragma once
 
@@ -20,8 +22,9 @@
 class ReplayManager {
 public:
     /**
-     * @brief リプレイデータをJSONファイルに保存する
-     * @details リプレイデータをJSONファイルに保存します。
+     * @brief リプレイデータをファイルに保存する
+     * @details リプレイデータをバイナリ形式（ReplayCodec）でファイルに保存します。
+     * 入力リプレイ（ReplayData::inputs）があれば、getInputReplayFilePath()にも保存します。
      * 
      * @param replayData リプレイデータ
      * @param stageNumber ステージ番号
@@ -30,8 +33,11 @@ public:
     static bool saveReplay(const ReplayData& replayData, int stageNumber);
     
     /**
-     * @brief JSONファイルからリプレイデータを読み込む
-     * @details JSONファイルからリプレイデータを読み込みます。
+     * @brief ファイルからリプレイデータを読み込む
+     * @details バイナリ形式のファイルを優先し、存在しない場合は旧形式（JSON）のファイル、
+     * それもない場合はReplayLibraryの最速のリプレイを読み込みます。
+     * 入力リプレイのファイルがあれば、ReplayData::inputsに読み込みます。
+     * ReplayStreamWriterが保存中の場合は、書き終わるまで待ちます。
      * 
      * @param replayData リプレイデータ
      * @param stageNumber ステージ番号
@@ -39,6 +45,30 @@ public:
      */
     static bool loadReplay(ReplayData& replayData, int stageNumber);
     
+    /**
+     * @brief リプレイファイルの保存先を準備する
+     * @details 保存先のディレクトリがなければ作成し、saveReplay()が書き込むパスを返します。
+     * @param stageNumber ステージ番号
+     * @return リプレイファイルのパス
+     */
+    static std::string prepareReplayFilePath(int stageNumber);
+    
+    /**
+     * @brief リプレイの保存先のディレクトリを準備する
+     * @details ディレクトリがなければ作成します（実行ディレクトリのassets/replays、なければ../assets/replays）。
+     * @return ディレクトリのパス
+     */
+    static std::string prepareReplayDirectory();
+    
+    /**
+     * @brief 入力リプレイをファイルに保存する
+     * @details リプレイファイルと同じ場所に拡張子.slinで保存します。入力が空の場合は古いファイルを削除します。
+     * @param replayFilePath リプレイファイル（.slrp）のパス
+     * @param inputs 入力リプレイ
+     * @param stageNumber ステージ番号
+     */
+    static void saveInputReplay(const std::string& replayFilePath, const InputReplay& inputs, int stageNumber);
+    
     /**
      * @brief リプレイファイルのパスを取得する
      * @param stageNumber ステージ番号
@@ -46,8 +76,23 @@ public:
      */
     static std::string getReplayFilePath(int stageNumber);
     
+    /**
+     * @brief 入力リプレイファイルのパスを取得する
+     * @param stageNumber ステージ番号
+     * @return 入力リプレイファイルのパス
+     */
+    static std::string getInputReplayFilePath(int stageNumber);
+    
+    /**
+     * @brief 旧形式（JSON）のリプレイファイルのパスを取得する
+     * @param stageNumber ステージ番号
+     * @return リプレイファイルのパス
+     */
+    static std::string getLegacyReplayFilePath(int stageNumber);
+    
     /**
      * @brief リプレイファイルが存在するか確認する
+     * @details バイナリ形式と旧形式（JSON）のどちらかのファイル、またはReplayLibraryにステージのリプレイがあればtrueを返します。
      * @param stageNumber ステージ番号
      * @return 存在する場合true
      */
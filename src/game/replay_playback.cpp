@@ -0,0 +1,107 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_playback.h"
+#include <algorithm>
+#include <iterator>
+
+void ReplayPlayback::prepare(ReplayState& replay) {
+    const auto& frames = replay.currentReplay.frames;
+    replay.scaledTimePrefix.resize(frames.size());
+    replay.playbackCursor = 0;
+    if (frames.empty()) {
+        return;
+    }
+
+    // 0.0から最初のフレームまでは最初のフレームのtimeScaleで進んだとみなす
+    float accumulated = (frames[0].timestamp > 0.0f) ? frames[0].timestamp * frames[0].timeScale : 0.0f;
+    replay.scaledTimePrefix[0] = accumulated;
+    for (size_t i = 1; i < frames.size(); i++) {
+        accumulated += (frames[i].timestamp - frames[i - 1].timestamp) * frames[i - 1].timeScale;
+        replay.scaledTimePrefix[i] = accumulated;
+    }
+}
+
+void ReplayPlayback::append(ReplayState& replay, std::vector<ReplayFrame>&& frames) {
+    auto& replayFrames = replay.currentReplay.frames;
+    if (frames.empty()) {
+        return;
+    }
+    if (replay.scaledTimePrefix.size() != replayFrames.size() || replayFrames.empty()) {
+        size_t cursor = replay.playbackCursor;
+        replayFrames.insert(replayFrames.end(), std::make_move_iterator(frames.begin()), std::make_move_iterator(frames.end()));
+        prepare(replay);
+        replay.playbackCursor = cursor;
+        return;
+    }
+
+    size_t first = replayFrames.size();
+    replayFrames.insert(replayFrames.end(), std::make_move_iterator(frames.begin()), std::make_move_iterator(frames.end()));
+    replay.scaledTimePrefix.resize(replayFrames.size());
+    float accumulated = replay.scaledTimePrefix[first - 1];
+    for (size_t i = first; i < replayFrames.size(); i++) {
+        accumulated += (replayFrames[i].timestamp - replayFrames[i - 1].timestamp) * replayFrames[i - 1].timeScale;
+        replay.scaledTimePrefix[i] = accumulated;
+    }
+}
+
+bool ReplayPlayback::findSegment(ReplayState& replay, float playbackTime, size_t& outIndex) {
+    const auto& frames = replay.currentReplay.frames;
+    if (frames.size() < 2 || playbackTime < frames.front().timestamp || playbackTime > frames.back().timestamp) {
+        return false;
+    }
+
+    auto contains = [&frames, playbackTime](size_t index) {
+        return frames[index].timestamp <= playbackTime && playbackTime <= frames[index + 1].timestamp;
+    };
+
+    // 通常は前回と同じ区間か隣の区間にある
+    size_t cursor = std::min(replay.playbackCursor, frames.size() - 2);
+    if (contains(cursor)) {
+        outIndex = cursor;
+        return true;
+    }
+    if (cursor + 1 < frames.size() - 1 && contains(cursor + 1)) {
+        replay.playbackCursor = outIndex = cursor + 1;
+        return true;
+    }
+    if (cursor > 0 && contains(cursor - 1)) {
+        replay.playbackCursor = outIndex = cursor - 1;
+        return true;
+    }
+
+    // シーク時は二分探索
+    auto upper = std::upper_bound(frames.begin(), frames.end(), playbackTime,
+                                  [](float time, const ReplayFrame& frame) { return time < frame.timestamp; });
+    size_t index = static_cast<size_t>(upper - frames.begin());
+    index = (index == 0) ? 0 : index - 1;
+    replay.playbackCursor = outIndex = std::min(index, frames.size() - 2);
+    return true;
+}
+
+float ReplayPlayback::segmentFactor(const ReplayState& replay, size_t index, float playbackTime) {
+    const auto& frame1 = replay.currentReplay.frames[index];
+    const auto& frame2 = replay.currentReplay.frames[index + 1];
+    float t = 0.0f;
+    if (frame2.timestamp > frame1.timestamp) {
+        t = (playbackTime - frame1.timestamp) / (frame2.timestamp - frame1.timestamp);
+    }
+    return std::clamp(t, 0.0f, 1.0f);
+}
+
+float ReplayPlayback::scaledGameTime(ReplayState& replay, float playbackTime, float currentTimeScale) {
+    const auto& frames = replay.currentReplay.frames;
+    if (frames.empty() || playbackTime < frames.front().timestamp) {
+        return playbackTime * currentTimeScale;
+    }
+    if (replay.scaledTimePrefix.size() != frames.size()) {
+        prepare(replay);  // prepare()を呼ばずに差し替えられた場合の保険
+    }
+
+    size_t index = frames.size() - 1;
+    if (playbackTime <= frames.back().timestamp) {
+        findSegment(replay, playbackTime, index);
+    }
+    return replay.scaledTimePrefix[index] + (playbackTime - frames[index].timestamp) * currentTimeScale;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file replay_playback.h
+ * @brief リプレイ再生
+ * @details 再生時間に対応するフレーム区間の検索と、ギミック同期用のゲーム時間の計算を行います。
+ */
+#pragma once
+
+#include "replay_state.h"
+
+/**
+ * @brief リプレイ再生
+ * @details フレーム区間は前回の位置（カーソル）から探し、見つからない場合は二分探索します。
+ * 通常再生・早送り・巻き戻しでは隣の区間に移るだけなので、1フレームあたり償却O(1)です。
+ * timeScale込みのゲーム時間は読み込み時に累積和を作っておき、区間内の経過分だけを足します。
+ */
+class ReplayPlayback {
+public:
+    /**
+     * @brief 再生の準備をする
+     * @details currentReplayのframesから累積ゲーム時間を作り、カーソルを先頭に戻します。
+     * リプレイを読み込んで再生を開始するときに呼び出します。
+     *
+     * @param replay リプレイ状態
+     */
+    static void prepare(ReplayState& replay);
+
+    /**
+     * @brief 再生中のリプレイにフレームを追加する
+     * @details ダウンロード中のリプレイのように、後から届いたフレームを末尾に追加し、累積ゲーム時間も続きから作ります。
+     * カーソルは変わりません。
+     *
+     * @param replay リプレイ状態
+     * @param frames 追加するフレーム（既存の最後のフレームより後の時刻）
+     */
+    static void append(ReplayState& replay, std::vector<ReplayFrame>&& frames);
+
+    /**
+     * @brief 再生時間を含むフレーム区間を探す
+     * @details frames[i].timestamp <= playbackTime <= frames[i + 1].timestamp となるiを返します。
+     *
+     * @param replay リプレイ状態（カーソルを更新する）
+     * @param playbackTime 再生時間
+     * @param outIndex 出力: 区間の先頭フレームのインデックス
+     * @return 最初のフレームから最後のフレームの範囲内の場合true
+     */
+    static bool findSegment(ReplayState& replay, float playbackTime, size_t& outIndex);
+
+    /**
+     * @brief フレーム区間内の補間係数を求める
+     * @param replay リプレイ状態
+     * @param index 区間の先頭フレームのインデックス
+     * @param playbackTime 再生時間
+     * @return 補間係数（0〜1）
+     */
+    static float segmentFactor(const ReplayState& replay, size_t index, float playbackTime);
+
+    /**
+     * @brief timeScale込みのゲーム時間を求める
+     * @details 最初のフレームより前は再生時間にcurrentTimeScaleを掛けた値、それ以降は
+     * 直前のフレームまでの累積値に、そのフレームからの経過時間×currentTimeScaleを足した値です。
+     *
+     * @param replay リプレイ状態
+     * @param playbackTime 再生時間
+     * @param currentTimeScale 現在のtimeScale
+     * @return ゲーム時間
+     */
+    static float scaledGameTime(ReplayState& replay, float playbackTime, float currentTimeScale);
+};
@@ -0,0 +1,115 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_recorder.h"
+
+ReplayFrame ReplayRecorder::captureFrame(const GameState& gameState, float timestamp) {
+    ReplayFrame frame;
+    captureFrame(gameState, timestamp, frame);
+    return frame;
+}
+
+void ReplayRecorder::captureFrame(const GameState& gameState, float timestamp, ReplayFrame& frame) {
+    frame.timestamp = timestamp;
+    frame.playerPosition = gameState.player.position;
+    frame.playerVelocity = gameState.player.velocity;
+    frame.timeScale = gameState.progress.timeScale;
+
+    // アイテム状態は変わった場合だけ作り直し、変わらない間は記録済みのフレームと共有する
+    const auto& items = gameState.items.items;
+    bool changed = (frame.itemCount() != items.size());
+    for (size_t i = 0; !changed && i < items.size(); i++) {
+        changed = (frame.isItemCollected(i) != items[i].isCollected);
+    }
+    if (!changed) {
+        return;
+    }
+    if (items.empty()) {
+        frame.itemCollectedStates.reset();
+        return;
+    }
+    auto states = std::make_shared<std::vector<bool>>(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        (*states)[i] = items[i].isCollected;
+    }
+    frame.itemCollectedStates = std::move(states);
+}
+
+void ReplayRecorder::begin(ReplayState& replay, const ReplayFrame& firstFrame) {
+    replay.isRecordingReplay = true;
+    replay.replayBuffer.clear();
+    replay.replayBuffer.reserve(INITIAL_BUFFER_CAPACITY);
+    replay.pendingRecordFrames.resize(MAX_PENDING_FRAMES);
+    replay.pendingRecordCount = 0;
+    replay.streamedFrameCount = 0;
+    replay.replayBuffer.push_back(firstFrame);
+}
+
+void ReplayRecorder::record(ReplayState& replay, const ReplayFrame& frame) {
+    if (replay.replayBuffer.empty()) {
+        replay.replayBuffer.push_back(frame);
+        return;
+    }
+
+    // 時間が進んでいないフレーム（タイムストップ中など）は補間の区間にならないため候補にしない
+    const ReplayFrame& latest = (replay.pendingRecordCount == 0) ? replay.replayBuffer.back() : replay.pendingRecordFrames[replay.pendingRecordCount - 1];
+    if (frame.timestamp <= latest.timestamp) {
+        return;
+    }
+
+    if (replay.pendingRecordFrames.empty()) {
+        replay.pendingRecordFrames.resize(MAX_PENDING_FRAMES);
+    } else if (replay.pendingRecordCount == replay.pendingRecordFrames.size()) {
+        emitPending(replay);
+    }
+
+    // 状態が切り替わった場合は、切り替わる直前と直後のフレームを両方記録する
+    if (frame.timeScale != latest.timeScale || !frame.hasSameItemStates(latest)) {
+        emitPending(replay);
+        replay.replayBuffer.push_back(frame);
+        return;
+    }
+
+    if (!canInterpolate(replay, replay.replayBuffer.back(), frame)) {
+        emitPending(replay);
+        if (!canInterpolate(replay, replay.replayBuffer.back(), frame)) {
+            replay.replayBuffer.push_back(frame);
+            return;
+        }
+    }
+    replay.pendingRecordFrames[replay.pendingRecordCount++] = frame;
+}
+
+void ReplayRecorder::finish(ReplayState& replay, const ReplayFrame& lastFrame) {
+    record(replay, lastFrame);
+    emitPending(replay);
+    replay.isRecordingReplay = false;
+}
+
+bool ReplayRecorder::canInterpolate(const ReplayState& replay, const ReplayFrame& anchor, const ReplayFrame& frame) {
+    float duration = frame.timestamp - anchor.timestamp;
+    if (duration > replay.maxRecordInterval) {
+        return false;
+    }
+
+    // 間の候補が全て、anchorとframeの線形補間から許容誤差以内にあるか
+    float maxErrorSquared = replay.maxRecordPositionError * replay.maxRecordPositionError;
+    for (size_t i = 0; i < replay.pendingRecordCount; i++) {
+        const ReplayFrame& pending = replay.pendingRecordFrames[i];
+        float t = (pending.timestamp - anchor.timestamp) / duration;
+        glm::vec3 interpolated = glm::mix(anchor.playerPosition, frame.playerPosition, t);
+        glm::vec3 error = pending.playerPosition - interpolated;
+        if (glm::dot(error, error) > maxErrorSquared) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ReplayRecorder::emitPending(ReplayState& replay) {
+    if (replay.pendingRecordCount > 0) {
+        replay.replayBuffer.push_back(replay.pendingRecordFrames[replay.pendingRecordCount - 1]);
+        replay.pendingRecordCount = 0;
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @file replay_recorder.h
+ * @brief リプレイ記録
+ * @details 誤差の上限を保ちながら、必要なフレームだけをリプレイに記録します。
+ */
+#pragma once
+
+#include "game_state.h"
+
+/**
+ * @brief リプレイ記録
+ * @details 毎フレームの状態を候補として受け取り、最後に記録したフレームから線形補間したときの
+ * 位置の誤差がReplayState::maxRecordPositionErrorを超える直前のフレームだけを記録します。
+ * 止まっている間や等速で動いている間はほとんど記録せず、大砲やジャンプ台で急に向きが変わったときは
+ * 毎フレーム記録します。記録間隔はReplayState::maxRecordIntervalを超えません。
+ * timeScaleやアイテムの収集状態が変わったフレームは必ず記録します。
+ * 候補はReplayState::pendingRecordFramesの固定数のスロットに上書きして保持するため、
+ * 毎ティックの処理ではメモリを確保しません（確保するのは記録したフレームの分だけです）。
+ */
+class ReplayRecorder {
+public:
+    static constexpr size_t MAX_PENDING_FRAMES = 240;  /**< @brief 候補の最大数（一杯になったら直前の候補を記録する） */
+    static constexpr size_t INITIAL_BUFFER_CAPACITY = 1024;  /**< @brief 記録開始時に確保するフレーム数 */
+
+    /**
+     * @brief 現在の状態からリプレイフレームを作成する
+     * @param gameState ゲーム状態
+     * @param timestamp タイムスタンプ
+     * @return リプレイフレーム
+     */
+    static ReplayFrame captureFrame(const GameState& gameState, float timestamp);
+
+    /**
+     * @brief 現在の状態をリプレイフレームに上書きする
+     * @details アイテム状態の確保済み領域を使い回すため、同じフレームに繰り返し取得してもメモリを確保しません。
+     *
+     * @param gameState ゲーム状態
+     * @param timestamp タイムスタンプ
+     * @param frame 出力: リプレイフレーム
+     */
+    static void captureFrame(const GameState& gameState, float timestamp, ReplayFrame& frame);
+
+    /**
+     * @brief 記録を開始する
+     * @details バッファを空にして、最初のフレームを記録します。候補のスロットはここで確保します。
+     *
+     * @param replay リプレイ状態
+     * @param firstFrame 最初のフレーム
+     */
+    static void begin(ReplayState& replay, const ReplayFrame& firstFrame);
+
+    /**
+     * @brief フレームを候補として追加する
+     * @details 補間で再現できなくなった場合は、直前の候補を記録します。
+     *
+     * @param replay リプレイ状態
+     * @param frame 現在のフレーム
+     */
+    static void record(ReplayState& replay, const ReplayFrame& frame);
+
+    /**
+     * @brief 記録を終了する
+     * @details 最後のフレームを必ず記録し、isRecordingReplayをfalseにします。
+     *
+     * @param replay リプレイ状態
+     * @param lastFrame 最後のフレーム
+     */
+    static void finish(ReplayState& replay, const ReplayFrame& lastFrame);
+
+private:
+    static bool canInterpolate(const ReplayState& replay, const ReplayFrame& anchor, const ReplayFrame& frame);
+    static void emitPending(ReplayState& replay);
+};
@@ -5,20 +5,39 @@
  */
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 #include <glm/glm.hpp>
+#include "input_replay.h"
+
+class ReplayDownload;
 
 /**
  * @brief リプレイフレーム
  * @details リプレイの1フレーム分のデータを保持します。
+ * アイテムの取得状態は変わらない間は前後のフレームで同じものを共有し、フレームごとに複製しません。
  */
 struct ReplayFrame {
     float timestamp;
     glm::vec3 playerPosition;
     glm::vec3 playerVelocity;
-    std::vector<bool> itemCollectedStates;
+    std::shared_ptr<const std::vector<bool>> itemCollectedStates;  /**< @brief アイテムの取得状態（アイテムがない場合はnullptr） */
     float timeScale;  /**< @brief このフレーム時点でのtimeScale（重力倍率） */
+
+    size_t itemCount() const {
+        return itemCollectedStates ? itemCollectedStates->size() : 0;
+    }
+
+    bool isItemCollected(size_t item) const {
+        return item < itemCount() && (*itemCollectedStates)[item];
+    }
+
+    bool hasSameItemStates(const ReplayFrame& other) const {
+        if (itemCollectedStates == other.itemCollectedStates) return true;
+        return itemCount() == other.itemCount() && (itemCount() == 0 || *itemCollectedStates == *other.itemCollectedStates);
+    }
 };
 
 struct ReplayData {
@@ -26,14 +45,40 @@ struct ReplayData {
     float clearTime;
     std::vector<ReplayFrame> frames;
     std::string recordedDate;
-    float frameRate;
+    float frameRate;  /**< @brief 記録間隔（上限、単位: 秒） */
+    InputReplay inputs;  /**< @brief 同じ走行の入力リプレイ（記録していない場合は入力が空） */
+};
+
+/**
+ * @brief ローカルのリプレイライブラリの1件分のメタデータ
+ * @details リプレイ本体はライブラリのデータファイルのoffsetから、
+ * リプレイ（replaySize バイト）、入力リプレイ（inputSize バイト、ない場合は0）の順に並んでいます。
+ */
+struct ReplayLibraryEntry {
+    uint32_t id = 0;
+    int stageNumber = 0;
+    float clearTime = 0.0f;
+    std::string recordedDate;
+    std::string playerName;
+    uint64_t offset = 0;
+    uint32_t replaySize = 0;
+    uint32_t inputSize = 0;
+    uint64_t lastUsed = 0;  /**< @brief 最後に追加・読み込みした順番（大きいほど新しい、LRUの削除順に使う） */
 };
 
 struct ReplayState {
     bool isRecordingReplay = false;
     std::vector<ReplayFrame> replayBuffer;
-    float replayRecordTimer = 0.0f;
-    const float REPLAY_RECORD_INTERVAL = 0.1f;
+    std::vector<ReplayFrame> pendingRecordFrames;  /**< @brief 最後に記録したフレーム以降の候補（ReplayRecorder用、スロットを使い回す） */
+    size_t pendingRecordCount = 0;  /**< @brief pendingRecordFramesのうち有効な候補の数 */
+    ReplayFrame capturedFrame;  /**< @brief 毎ティックの状態の取得先（ReplayRecorder::captureFrameで上書きして使い回す） */
+    size_t streamedFrameCount = 0;  /**< @brief replayBufferのうちReplayStreamWriterに渡したフレーム数 */
+    float maxRecordPositionError = 0.02f;  /**< @brief 補間で許容する位置の誤差 */
+    float maxRecordInterval = 0.5f;  /**< @brief 記録間隔の上限（単位: 秒） */
+    
+    bool isRecordingInputs = false;  /**< @brief 入力リプレイを記録中か（固定ティックでない場合は途中で停止） */
+    InputReplay inputRecording;
+    TickInput tickInput;  /**< @brief 現在のティックで適用した入力（InputSystemが設定） */
     
     bool isReplayMode = false;
     ReplayData currentReplay;
@@ -42,8 +87,15 @@ struct ReplayState {
     bool isReplayPaused = false;
     float replayPlaybackSpeed = 1.0f;
     
+    std::vector<float> scaledTimePrefix;  /**< @brief 各フレーム時点までのtimeScale込みのゲーム時間（ReplayPlayback::prepareで作成） */
+    size_t playbackCursor = 0;  /**< @brief 前回参照したフレーム区間の先頭インデックス */
+    
     bool pendingReplayLoad = false;  /**< @brief リプレイ読み込み待ちフラグ */
     int pendingReplayStage = 0;  /**< @brief 読み込み待ちのリプレイステージ番号 */
     bool isOnlineReplay = false;  /**< @brief オンラインから取得したリプレイかどうか */
+    
+    std::shared_ptr<ReplayDownload> replayDownload;  /**< @brief ダウンロード中のオンラインリプレイ（なければnullptr） */
+    bool isReplayStreaming = false;  /**< @brief currentReplayのフレームがまだ届いている途中か */
+    bool isReplayBuffering = false;  /**< @brief 受信済みのフレームを再生し終え、続きを待っているか */
 };
 
@@ -0,0 +1,352 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_stream_writer.h"
+#include "replay_codec.h"
+#include "replay_manager.h"
+#include "replay_library.h"
+#include "../core/error_handler.h"
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace {
+    // 制御コマンド（開始・終了・取り消し）用に空けておくスロット数（フレームはここまで使えない）
+    constexpr size_t CONTROL_RESERVE = 8;
+
+    enum class CommandType {
+        Begin,
+        Frame,
+        Finish,
+        Cancel
+    };
+
+    struct Slot {
+        CommandType type = CommandType::Frame;
+        ReplayFrame frame;
+        int stageNumber = 0;
+        size_t itemCount = 0;
+        float frameRate = 0.0f;
+        bool broken = false;
+        bool commit = false;
+        ReplayData replayData;
+        std::string playerName;
+    };
+
+    /**
+     * @brief 書き込みスレッドが扱う1つのストリーム
+     */
+    struct Stream {
+        bool active = false;
+        bool broken = false;
+        int stageNumber = 0;
+        float frameRate = 0.0f;
+        std::string filePath;
+        std::string partPath;
+        std::ofstream file;
+        ReplayCodec::StreamEncoder encoder;
+        std::vector<uint8_t> block;
+    };
+
+    struct WriterState {
+        std::mutex mutex;
+        std::condition_variable wake;   // 書き込みスレッドへの通知（コマンドの追加・終了）
+        std::condition_variable space;  // メインスレッドへの通知（スロットの解放）
+        std::condition_variable idle;   // 全てのコマンドの処理が終わった
+        std::array<Slot, ReplayStreamWriter::RING_CAPACITY> ring;
+        size_t head = 0;
+        size_t count = 0;
+        bool stopping = false;
+        std::thread thread;
+
+        // メインスレッドだけが使う
+        bool producerActive = false;
+        bool producerBroken = false;
+
+        ~WriterState() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    };
+
+    // writerの破棄（書き込みスレッドの終了待ち）より後にstreamが破棄されるよう、先に定義する
+    Stream stream;  // 書き込みスレッドだけが使う
+    WriterState writer;
+
+    void abortStream() {
+        if (stream.file.is_open()) {
+            stream.file.close();
+        }
+        if (!stream.partPath.empty()) {
+            std::error_code error;
+            std::filesystem::remove(stream.partPath, error);
+        }
+        stream.active = false;
+        stream.partPath.clear();
+    }
+
+    bool writeBytes(const std::vector<uint8_t>& bytes) {
+        stream.file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(stream.file);
+    }
+
+    void beginStream(const Slot& slot) {
+        abortStream();
+        stream.active = true;
+        stream.broken = false;
+        stream.stageNumber = slot.stageNumber;
+        stream.frameRate = slot.frameRate;
+        stream.encoder.begin(slot.itemCount);
+
+        stream.filePath = ReplayManager::prepareReplayFilePath(slot.stageNumber);
+        stream.partPath = stream.filePath + ".part";
+        stream.file.open(stream.partPath, std::ios::binary | std::ios::trunc);
+        if (!stream.file.is_open()) {
+            stream.filePath = "../assets/replays/stage" + std::to_string(slot.stageNumber) + "_best.slrp";
+            stream.partPath = stream.filePath + ".part";
+            stream.file.open(stream.partPath, std::ios::binary | std::ios::trunc);
+        }
+        if (!stream.file.is_open()) {
+            ErrorHandler::logErrorFormat("Failed to open replay stream file for writing: %s", stream.partPath.c_str());
+            stream.partPath.clear();
+            stream.broken = true;
+            return;
+        }
+
+        // 仮のヘッダー（終了時に書き直す）
+        ReplayData header;
+        header.stageNumber = slot.stageNumber;
+        header.frameRate = slot.frameRate;
+        stream.broken = !writeBytes(stream.encoder.encodeHeader(header));
+    }
+
+    void writeFrame(const ReplayFrame& frame) {
+        if (!stream.active || stream.broken) {
+            return;
+        }
+        if (stream.encoder.addFrame(frame, stream.block)) {
+            stream.broken = !writeBytes(stream.block);
+        }
+    }
+
+    bool commitStream(ReplayData& replayData) {
+        if (stream.encoder.flush(stream.block) && !writeBytes(stream.block)) {
+            return false;
+        }
+        if (!writeBytes(stream.encoder.encodeIndex())) {
+            return false;
+        }
+
+        replayData.stageNumber = stream.stageNumber;
+        stream.file.seekp(0);
+        if (!writeBytes(stream.encoder.encodeHeader(replayData))) {
+            return false;
+        }
+        std::streamoff size = static_cast<std::streamoff>(stream.file.seekp(0, std::ios::end).tellp());
+        stream.file.close();
+        if (stream.file.fail()) {
+            return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(stream.partPath, stream.filePath, error);
+        if (error) {
+            ErrorHandler::logErrorFormat("Failed to replace replay file: %s (%s)", stream.filePath.c_str(), error.message().c_str());
+            return false;
+        }
+        stream.partPath.clear();
+        stream.active = false;
+
+        printf("REPLAY: Saved replay for stage %d (%zu frames, %.2fs, %lld bytes, streamed)\n",
+               stream.stageNumber, stream.encoder.getFrameCount(), replayData.clearTime, static_cast<long long>(size));
+        ReplayManager::saveInputReplay(stream.filePath, replayData.inputs, stream.stageNumber);
+        return true;
+    }
+
+    void finishStream(Slot& slot) {
+        if (!slot.replayData.frames.empty()) {
+            ReplayLibrary::add(slot.replayData, slot.playerName);
+        }
+        if (!slot.commit) {
+            abortStream();
+            return;
+        }
+
+        bool streamed = stream.active && !stream.broken && !slot.broken && commitStream(slot.replayData);
+        if (!streamed) {
+            // 途中で書き込めなくなった場合は、全体をまとめて保存し直す
+            abortStream();
+            if (!slot.replayData.frames.empty()) {
+                printf("REPLAY: Stream incomplete, saving replay for stage %d in one piece\n", slot.replayData.stageNumber);
+                ReplayManager::saveReplay(slot.replayData, slot.replayData.stageNumber);
+            }
+        }
+    }
+
+    void process(Slot& slot) {
+        try {
+            switch (slot.type) {
+                case CommandType::Begin:
+                    beginStream(slot);
+                    break;
+                case CommandType::Frame:
+                    writeFrame(slot.frame);
+                    break;
+                case CommandType::Finish:
+                    finishStream(slot);
+                    break;
+                case CommandType::Cancel:
+                    abortStream();
+                    break;
+            }
+        } catch (const std::exception& e) {
+            ErrorHandler::logErrorFormat("Replay stream error: %s", e.what());
+            stream.broken = true;
+        }
+        if (slot.type == CommandType::Finish) {
+            // 受け取ったデータは書き込みスレッドで解放し、メインスレッドを待たせない
+            slot.replayData = ReplayData();
+        }
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(writer.mutex);
+        while (true) {
+            writer.wake.wait(lock, [] { return writer.count > 0 || writer.stopping; });
+            if (writer.count == 0) {
+                break;
+            }
+
+            // 先頭のスロットはcountを減らすまでメインスレッドが上書きしないため、ロックを外して処理する
+            Slot& slot = writer.ring[writer.head];
+            lock.unlock();
+            process(slot);
+            lock.lock();
+
+            writer.head = (writer.head + 1) % ReplayStreamWriter::RING_CAPACITY;
+            writer.count--;
+            writer.space.notify_one();
+            if (writer.count == 0) {
+                writer.idle.notify_all();
+            }
+        }
+        abortStream();
+    }
+
+    /**
+     * @brief 空いているスロットを取得する（呼び出し側でロックを取っていること）
+     */
+    Slot& acquireSlot() {
+        if (!writer.thread.joinable()) {
+            writer.stopping = false;
+            writer.thread = std::thread(workerLoop);
+        }
+        return writer.ring[(writer.head + writer.count) % ReplayStreamWriter::RING_CAPACITY];
+    }
+
+    void publishSlot(std::unique_lock<std::mutex>& lock) {
+        writer.count++;
+        lock.unlock();
+        writer.wake.notify_one();
+    }
+
+    /**
+     * @brief 制御コマンド用のスロットを取得する
+     * @details リングバッファが完全に埋まっている場合だけ、空くまで待ちます。
+     */
+    Slot& acquireControlSlot(std::unique_lock<std::mutex>& lock) {
+        writer.space.wait(lock, [] { return writer.count < ReplayStreamWriter::RING_CAPACITY; });
+        return acquireSlot();
+    }
+}
+
+void ReplayStreamWriter::begin(int stageNumber, size_t itemCount, float frameRate) {
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    Slot& slot = acquireControlSlot(lock);
+    slot.type = CommandType::Begin;
+    slot.stageNumber = stageNumber;
+    slot.itemCount = itemCount;
+    slot.frameRate = frameRate;
+    writer.producerActive = true;
+    writer.producerBroken = false;
+    publishSlot(lock);
+}
+
+bool ReplayStreamWriter::push(const ReplayFrame& frame) {
+    if (!writer.producerActive || writer.producerBroken) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    if (writer.count + CONTROL_RESERVE >= RING_CAPACITY) {
+        writer.producerBroken = true;
+        printf("REPLAY: Stream buffer full, falling back to saving at the end\n");
+        return false;
+    }
+    Slot& slot = acquireSlot();
+    slot.type = CommandType::Frame;
+    // 代入でアイテム状態の確保済み領域を使い回す
+    slot.frame = frame;
+    publishSlot(lock);
+    return true;
+}
+
+void ReplayStreamWriter::pushRecorded(ReplayState& replay) {
+    for (; replay.streamedFrameCount < replay.replayBuffer.size(); replay.streamedFrameCount++) {
+        push(replay.replayBuffer[replay.streamedFrameCount]);
+    }
+}
+
+void ReplayStreamWriter::finish(ReplayData replayData, bool commit, const std::string& playerName) {
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    Slot& slot = acquireControlSlot(lock);
+    slot.type = CommandType::Finish;
+    slot.broken = writer.producerBroken;
+    slot.commit = commit;
+    slot.replayData = std::move(replayData);
+    slot.playerName = playerName;
+    writer.producerActive = false;
+    writer.producerBroken = false;
+    publishSlot(lock);
+}
+
+void ReplayStreamWriter::cancel() {
+    if (!writer.producerActive) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    Slot& slot = acquireControlSlot(lock);
+    slot.type = CommandType::Cancel;
+    writer.producerActive = false;
+    writer.producerBroken = false;
+    publishSlot(lock);
+}
+
+void ReplayStreamWriter::waitIdle() {
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    writer.idle.wait(lock, [] { return writer.count == 0; });
+}
+
+void ReplayStreamWriter::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(writer.mutex);
+        writer.stopping = true;
+        writer.producerActive = false;
+    }
+    writer.wake.notify_all();
+    if (writer.thread.joinable()) {
+        writer.thread.join();
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * @file replay_stream_writer.h
+ * @brief リプレイのストリーミング保存
+ * @details 記録中のリプレイを別スレッドでエンコードし、ブロック単位でファイルに書き出します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_state.h"
+#include <string>
+
+/**
+ * @brief リプレイのストリーミング保存
+ * @details 記録したフレームを固定容量のリングバッファで書き込みスレッドに渡し、
+ * 書き込みスレッドがReplayCodec::StreamEncoderでキーフレーム間隔ごとのブロックにエンコードして
+ * 一時ファイル（リプレイファイルのパス + ".part"）に追記します。
+ * リングバッファのスロットは使い回すため、フレームを渡すときにメモリを確保しません。
+ *
+ * ゴール時はfinish()で終了を依頼するだけで、インデックスの書き込み、ヘッダーの書き直し、
+ * リプレイファイルへの置き換え（新記録の場合）、入力リプレイの保存、ReplayLibraryへの追加は書き込みスレッドで行います。
+ * メインスレッドがファイルの書き込みを待つことはありません。
+ *
+ * begin()・push()・finish()・cancel()は同じスレッド（メインスレッド）から呼び出してください。
+ */
+class ReplayStreamWriter {
+public:
+    static constexpr size_t RING_CAPACITY = 1024;  /**< @brief リングバッファの容量（フレーム数） */
+
+    /**
+     * @brief ストリーミング保存を開始する
+     * @details 前の保存が終了していない場合は取り消します。
+     *
+     * @param stageNumber ステージ番号
+     * @param itemCount アイテム数
+     * @param frameRate 記録間隔（上限、単位: 秒）
+     */
+    static void begin(int stageNumber, size_t itemCount, float frameRate);
+
+    /**
+     * @brief フレームを書き込みスレッドに渡す
+     * @details リングバッファが一杯の場合は待たずにfalseを返し、このストリームは途切れたものとして扱います
+     * （finish()でreplayData.framesから保存し直します）。
+     *
+     * @param frame フレーム
+     * @return 渡せた場合true
+     */
+    static bool push(const ReplayFrame& frame);
+
+    /**
+     * @brief リプレイに新しく記録されたフレームを書き込みスレッドに渡す
+     * @details replay.replayBufferのうち、まだ渡していないフレーム（replay.streamedFrameCount以降）を渡します。
+     * @param replay リプレイ状態
+     */
+    static void pushRecorded(ReplayState& replay);
+
+    /**
+     * @brief ストリーミング保存を終了する
+     * @details commitがtrueの場合はリプレイファイルを置き換え、入力リプレイも保存します。
+     * falseの場合は一時ファイルを削除します。
+     * ストリームが途切れていた場合（一時ファイルを開けなかった場合やリングバッファがあふれた場合）は、
+     * 書き込みスレッドでReplayManager::saveReplay()によりreplayData.framesの全体を保存し直します。
+     * commitによらず、フレームがあればReplayLibraryにも追加します。
+     *
+     * @param replayData メタデータ（ステージ番号、クリアタイム、記録間隔、記録日時）と入力リプレイ、フレーム
+     * @param commit リプレイファイルを置き換える場合true
+     * @param playerName ReplayLibraryに保存するプレイヤー名
+     */
+    static void finish(ReplayData replayData, bool commit, const std::string& playerName = "");
+
+    /**
+     * @brief ストリーミング保存を取り消す
+     * @details 一時ファイルを削除します。
+     */
+    static void cancel();
+
+    /**
+     * @brief 依頼した処理が全て終わるまで待つ
+     */
+    static void waitIdle();
+
+    /**
+     * @brief 依頼した処理を全て終えてから書き込みスレッドを終了する
+     * @details アプリケーションの終了時に呼び出します。
+     */
+    static void shutdown();
+};
@@ -0,0 +1,468 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "simulation_system.h"
+#include "gravity_system.h"
+#include "switch_system.h"
+#include "cannon_system.h"
+#include "trigger_system.h"
+#include "input_replay_system.h"
+#include "../physics/physics_system.h"
+#include "../core/utils/physics_utils.h"
+#include "../core/constants/physics_constants.h"
+#include "../core/constants/input_constants.h"
+#include <variant>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+void SimulationSystem::updateWorld(GameState& gameState, PlatformSystem& platformSystem, float scaledDeltaTime) {
+    platformSystem.update(scaledDeltaTime, gameState.player.position, -1.0f, -1.0f);
+    GravitySystem::updateGravityZones(gameState, scaledDeltaTime);
+    SwitchSystem::updateSwitches(gameState, scaledDeltaTime);
+    CannonSystem::updateCannons(gameState, scaledDeltaTime);
+}
+
+void SimulationSystem::applyInput(GameState& gameState, PlatformSystem& platformSystem, const TickInput& input,
+                                  const glm::vec3& gravityDirection, float scaledDeltaTime, const SimulationEvents& events) {
+    if (gameState.progress.isGoalReached || gameState.progress.isGameOver) {
+        return;
+    }
+
+    glm::vec3 moveDir = InputReplaySystem::getMoveDirection(input);
+    if (glm::length(moveDir) > 0.0f) {
+        float moveDistance = GameConstants::InputConstants::MOVE_SPEED * scaledDeltaTime;
+
+        if (gameState.skills.isInBurstJumpAir) {
+            moveDistance *= 2.0f;
+        }
+
+        gameState.player.position.x += moveDir.x * moveDistance;
+        gameState.player.position.z += moveDir.z * moveDistance;
+    }
+
+    if (input.buttons & TickInput::BUTTON_JUMP) {
+        applyJump(gameState, platformSystem, gravityDirection, events);
+    }
+}
+
+void SimulationSystem::applyJump(GameState& gameState, PlatformSystem& platformSystem, const glm::vec3& gravityDirection,
+                                 const SimulationEvents& events) {
+    glm::vec3 playerSize = glm::vec3(1.0f, 1.0f, 1.0f);
+    bool onPlatform = false;
+
+    const auto& platforms = platformSystem.getPlatforms();
+
+    // 足場判定の許容範囲（上下0.5）を含めた範囲で候補を絞り込む
+    // 再シミュレーションを複数スレッドで行えるよう、候補の配列は共有しない
+    std::vector<int> candidates;
+    glm::vec3 queryMin = gameState.player.position - playerSize * 0.5f - glm::vec3(0, 0.5f, 0);
+    glm::vec3 queryMax = gameState.player.position + playerSize * 0.5f + glm::vec3(0, 0.5f, 0);
+    platformSystem.queryAABB(queryMin, queryMax, candidates);
+
+    for (int index : candidates) {
+        std::visit([&](const auto& p) {
+            if (p.size.x <= 0 || p.size.y <= 0 || p.size.z <= 0) return;
+
+            glm::vec3 platformMin = p.position - p.size * 0.5f;
+            glm::vec3 platformMax = p.position + p.size * 0.5f;
+            glm::vec3 playerMin = gameState.player.position - playerSize * 0.5f;
+            glm::vec3 playerMax = gameState.player.position + playerSize * 0.5f;
+
+            bool horizontalOverlap = (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
+                                     playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
+
+            if (gravityDirection.y > 0.5f) {
+                if (horizontalOverlap && std::abs(playerMax.y - platformMin.y) < 0.5f) {
+                    onPlatform = true;
+                }
+            } else {
+                if (horizontalOverlap && std::abs(playerMin.y - platformMax.y) < 0.5f) {
+                    onPlatform = true;
+                }
+            }
+        }, platforms[index]);
+
+        if (onPlatform) break;
+    }
+
+    // 重力反転時は下向きにジャンプする
+    float jumpSign = (gravityDirection.y > 0.5f) ? -1.0f : 1.0f;
+
+    if (onPlatform) {
+        emitSFX(events, "jump");
+
+        if (gameState.skills.isBurstJumpActive && !gameState.skills.hasUsedBurstJump) {
+            gameState.player.velocity.y = 20.0f * jumpSign;
+            gameState.skills.hasUsedBurstJump = true;
+            gameState.skills.isBurstJumpActive = false; // バーストジャンプを使用したので非アクティブに
+            gameState.skills.burstJumpDelayTimer = 0.01f; // 1秒後に空中フラグを設定
+        } else {
+            gameState.player.velocity.y = 8.0f * jumpSign;
+        }
+        gameState.player.canDoubleJump = true;
+        if (gameState.skills.isInBurstJumpAir) {
+            gameState.skills.isInBurstJumpAir = false; // バーストジャンプ空中フラグをリセット
+        }
+    } else if ((gameState.progress.selectedSecretStarType == GameProgressState::SecretStarType::NONE) &&
+               !gameState.progress.isTimeAttackMode &&
+               ((gameState.progress.isEasyMode && gameState.player.canDoubleJump) ||
+               (!gameState.progress.isEasyMode && gameState.skills.hasDoubleJumpSkill && gameState.skills.doubleJumpRemainingUses > 0 && gameState.player.canDoubleJump))) {
+        if (gameState.progress.currentStage != 0) {
+            emitSFX(events, "jump");
+
+            gameState.player.velocity.y = 6.0f * jumpSign;
+            gameState.player.canDoubleJump = false; // 二段ジャンプを使用
+
+            if (!gameState.progress.isEasyMode) {
+                gameState.skills.doubleJumpRemainingUses--;
+            }
+        }
+    } else if ((gameState.progress.selectedSecretStarType == GameProgressState::SecretStarType::NONE) &&
+               !gameState.progress.isTimeAttackMode &&
+               gameState.skills.isBurstJumpActive && !gameState.skills.hasUsedBurstJump && !gameState.skills.isInBurstJumpAir) {
+        emitSFX(events, "jump");
+
+        gameState.player.velocity.y = 20.0f * jumpSign;
+        gameState.skills.hasUsedBurstJump = true;
+        gameState.skills.isBurstJumpActive = false; // バーストジャンプを使用したので非アクティブに
+        gameState.skills.isInBurstJumpAir = true; // バーストジャンプ空中フラグを設定
+    }
+}
+
+void SimulationSystem::updatePhysics(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                                     float deltaTime, float scaledDeltaTime, const SimulationEvents& events) {
+    if (gameState.progress.isGameOver) {
+        return;
+    }
+
+    glm::vec3 gravityDirection = glm::vec3(0, -1, 0);
+    PhysicsSystem::isPlayerInGravityZone(gameState, gravityDirection);
+
+    float gravityStrength = PhysicsUtils::calculateGravityStrength(GameConstants::BASE_GRAVITY, deltaTime, gameState.progress.timeScale, gravityDirection, gameState);
+    glm::vec3 gravityForce = gravityDirection * gravityStrength;
+
+    gameState.player.velocity += gravityForce;
+
+    float airResistance = (gameState.progress.timeScale > 1.0f) ? GameConstants::AIR_RESISTANCE_FAST : GameConstants::AIR_RESISTANCE_NORMAL;
+    // 減衰率は1/60秒あたりの値なので、ティックレートに依存しないよう経過時間で指数補正する
+    gameState.player.velocity *= std::pow(airResistance, deltaTime * GameConstants::AIR_RESISTANCE_REFERENCE_RATE);
+
+    glm::vec3 playerSize = GameConstants::PLAYER_SIZE;
+
+    glm::vec3 stepStart = gameState.player.position;
+    glm::vec3 stepDisplacement(0.0f, gameState.player.velocity.y * scaledDeltaTime, 0.0f);
+    gameState.player.position.y += stepDisplacement.y;
+    resolveTunneling(gameState, platformSystem, stepStart, stepDisplacement, playerSize);
+
+    auto collisionResult = platformSystem.checkCollisionWithIndex(gameState.player.position, playerSize);
+    PlatformVariant* currentPlatform = collisionResult.first;
+    int currentPlatformIndex = collisionResult.second;
+
+    bool isOnPlatform = (currentPlatform != nullptr);
+
+    if (currentPlatform != nullptr) {
+        if (gameState.progress.isEasyMode) {
+            std::visit([&](const auto& platform) {
+                gameState.player.lastPlatformPosition = platform.position;
+                gameState.player.lastPlatformIndex = currentPlatformIndex;
+                gameState.player.isTrackingPlatform = true;
+            }, *currentPlatform);
+        }
+
+        std::visit(overloaded{
+            [&](const StaticPlatform& platform) {
+                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                if (platform.color.r > 0.9f && platform.color.g > 0.9f && platform.color.b < 0.1f) {
+                    if (!gameState.progress.gameWon && gameState.items.collectedItems >= gameState.items.requiredItems) {
+                        gameState.progress.gameWon = true;
+                        gameState.progress.isStageCompleted = true;
+                        gameState.progress.isGoalReached = true;
+
+                        // リプレイモードでない場合、かつリプレイのクリアタイムが設定されていない場合のみclearTimeを更新
+                        if (!gameState.replay.isReplayMode &&
+                            (gameState.replay.currentReplay.frames.empty() || gameState.replay.currentReplay.clearTime <= 0.0f)) {
+                            gameState.progress.clearTime = gameState.progress.simulationTime;
+                        }
+
+                        if (events.onGoalReached) {
+                            events.onGoalReached();
+                        }
+                    }
+                }
+            },
+            [&](const MovingPlatform& platform) {
+                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                const_cast<MovingPlatform&>(platform).hasPlayerOnBoard = true;
+                glm::vec3 platformMovement = platform.position - platform.previousPosition;
+                gameState.player.position.x += platformMovement.x;
+                gameState.player.position.z += platformMovement.z;
+            },
+            [&](const RotatingPlatform& platform) {
+                glm::vec3 halfSize = platform.size * 0.5f;
+                glm::vec3 platformMin = platform.position - halfSize;
+                glm::vec3 platformMax = platform.position + halfSize;
+                bool onPlatform = (gameState.player.position.x >= platformMin.x && gameState.player.position.x <= platformMax.x &&
+                                   gameState.player.position.z >= platformMin.z && gameState.player.position.z <= platformMax.z);
+                if (onPlatform) {
+                    glm::vec3 localPlayerPos = gameState.player.position - platform.position;
+                    if (glm::length(platform.rotationAxis - glm::vec3(0, 1, 0)) < 0.1f) {
+                        float angle = glm::radians(platform.rotationAngle);
+                        float cosAngle = cos(angle);
+                        float sinAngle = sin(angle);
+                        float newX = localPlayerPos.x * cosAngle - localPlayerPos.z * sinAngle;
+                        float newZ = localPlayerPos.x * sinAngle + localPlayerPos.z * cosAngle;
+                        gameState.player.position = platform.position + glm::vec3(newX, localPlayerPos.y, newZ);
+                    } else if (glm::length(platform.rotationAxis - glm::vec3(1, 0, 0)) < 0.1f) {
+                        float angle = glm::radians(platform.rotationAngle);
+                        float cosAngle = cos(angle);
+                        float sinAngle = sin(angle);
+                        float newY = localPlayerPos.y * cosAngle - localPlayerPos.z * sinAngle;
+                        float newZ = localPlayerPos.y * sinAngle + localPlayerPos.z * cosAngle;
+                        gameState.player.position = platform.position + glm::vec3(localPlayerPos.x, newY, newZ);
+                    }
+                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                } else {
+                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                }
+            },
+            [&](const PatrollingPlatform& platform) {
+                glm::vec3 halfSize = platform.size * 0.5f;
+                glm::vec3 platformMin = platform.position - halfSize;
+                glm::vec3 platformMax = platform.position + halfSize;
+                glm::vec3 extendedHalfSize = halfSize * 1.5f;
+                glm::vec3 extendedMin = platform.position - extendedHalfSize;
+                glm::vec3 extendedMax = platform.position + extendedHalfSize;
+                bool onPlatform = (gameState.player.position.x >= platformMin.x && gameState.player.position.x <= platformMax.x &&
+                                  gameState.player.position.z >= platformMin.z && gameState.player.position.z <= platformMax.z);
+                bool inExtendedRange = (gameState.player.position.x >= extendedMin.x && gameState.player.position.x <= extendedMax.x &&
+                                       gameState.player.position.z >= extendedMin.z && gameState.player.position.z <= extendedMax.z);
+                if (onPlatform || inExtendedRange) {
+                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                    glm::vec3 platformMovement = platform.position - platform.previousPosition;
+                    gameState.player.position.x += platformMovement.x;
+                    gameState.player.position.z += platformMovement.z;
+                    if (!onPlatform && inExtendedRange) {
+                        glm::vec3 directionToCenter = platform.position - gameState.player.position;
+                        directionToCenter.y = 0;
+                        float distanceToCenter = glm::length(directionToCenter);
+                        if (distanceToCenter > 0.1f) {
+                            glm::vec3 normalizedDirection = glm::normalize(directionToCenter);
+                            gameState.player.position += normalizedDirection * 0.5f * deltaTime;
+                        }
+                    }
+                } else {
+                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                }
+            },
+            [&](const TeleportPlatform& platform) {
+                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                if (!platform.hasTeleported && platform.cooldownTimer <= 0.0f) {
+                    gameState.player.position = platform.teleportDestination;
+                    const_cast<TeleportPlatform&>(platform).hasTeleported = true;
+                    const_cast<TeleportPlatform&>(platform).cooldownTimer = 2.0f;
+                }
+            },
+            [&](const JumpPad& platform) {
+                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                gameState.player.velocity.y = platform.jumpPower;
+            },
+            [&](const CycleDisappearingPlatform& platform) {
+                if (platform.isCurrentlyVisible) {
+                    PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+                }
+            },
+            [&](const DisappearingPlatform& platform) {
+                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+            },
+            [&](const FlyingPlatform& platform) {
+                PhysicsUtils::adjustPlayerPositionForGravity(gameState, platform.position, platform.size, playerSize, gravityDirection);
+            }
+        }, *currentPlatform);
+    } else {
+        platformSystem.resetMovingPlatformFlags();
+    }
+
+    if (isOnPlatform && !gameState.player.wasOnPlatform) {
+        emitSFX(events, "on_ground");
+    }
+
+    // 地面に着地した時、バーストジャンプの空中効果をリセット
+    if (isOnPlatform && gameState.skills.isInBurstJumpAir) {
+        gameState.skills.isInBurstJumpAir = false;
+    }
+
+    gameState.player.wasOnPlatform = isOnPlatform;
+
+    if (gameState.player.position.y < 0 && !gameState.progress.isGameOver) {
+        respawnAfterFall(gameState, platformSystem, currentStage, events);
+    }
+}
+
+void SimulationSystem::resolveTunneling(GameState& gameState, PlatformSystem& platformSystem, const glm::vec3& stepStart,
+                                        const glm::vec3& stepDisplacement, const glm::vec3& playerSize) {
+    float impactTime = 0.0f;
+    auto sweepResult = platformSystem.sweepCollisionWithIndex(stepStart, playerSize, stepDisplacement, impactTime);
+    if (sweepResult.first == nullptr) {
+        return;
+    }
+
+    // 移動後も接触した足場と重なっていれば、通常の離散判定で処理できる
+    glm::vec3 playerMin = gameState.player.position - playerSize * 0.5f;
+    glm::vec3 playerMax = gameState.player.position + playerSize * 0.5f;
+    bool overlapsAfterStep = std::visit(overloaded{
+        [&](const RotatingPlatform& platform) {
+            return platform.orientedBox.overlapsAABB(playerMin, playerMax);
+        },
+        [&](const auto& platform) {
+            glm::vec3 platformMin = platform.position - platform.size * 0.5f;
+            glm::vec3 platformMax = platform.position + platform.size * 0.5f;
+            return (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
+                    playerMax.y >= platformMin.y && playerMin.y <= platformMax.y &&
+                    playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
+        }
+    }, *sweepResult.first);
+    if (overlapsAfterStep) {
+        return;
+    }
+
+    // すり抜けた場合は接触位置まで戻し、離散判定が確実に拾えるよう少しだけ食い込ませる
+    float stepLength = glm::length(stepDisplacement);
+    float skin = std::min(GameConstants::PhysicsConstants::CONTINUOUS_COLLISION_SKIN, stepLength * (1.0f - impactTime));
+    gameState.player.position = stepStart + stepDisplacement * impactTime + (stepDisplacement / stepLength) * skin;
+}
+
+void SimulationSystem::updateTriggers(GameState& gameState, PlatformSystem& platformSystem) {
+    TriggerSystem::update(gameState, gameState.player.position);
+
+    // リプレイ再生中は記録された位置をなぞるだけなので、プレイヤーを動かすギミックは作動させない
+    if (!gameState.replay.isReplayMode) {
+        SwitchSystem::checkSwitchCollision(gameState, platformSystem);
+        CannonSystem::checkCannonCollision(gameState);
+    }
+}
+
+void SimulationSystem::updateItems(GameState& gameState, float scaledDeltaTime, const SimulationEvents& events) {
+    for (auto& item : gameState.items.items) {
+        if (!item.isCollected) {
+            item.rotationAngle += scaledDeltaTime * 90.0f;
+            if (item.rotationAngle >= 360.0f) {
+                item.rotationAngle -= 360.0f;
+            }
+
+            item.bobTimer += scaledDeltaTime;
+            item.bobHeight = sin(item.bobTimer * 2.0f) * 0.2f;
+        }
+    }
+
+    // 収集範囲の判定はupdateTriggers()の結果を使う
+    for (const auto& triggerEvent : gameState.triggers.events) {
+        if (triggerEvent.type != TriggerType::Item || triggerEvent.phase == TriggerPhase::Exit) continue;
+        if (triggerEvent.targetIndex >= static_cast<int>(gameState.items.items.size())) continue;
+
+        auto& item = gameState.items.items[triggerEvent.targetIndex];
+        if (item.isCollected) continue;
+
+        emitSFX(events, "item");
+
+        item.isCollected = true;
+        gameState.items.collectedItems++;
+
+        if (gameState.progress.isTutorialStage) {
+            gameState.items.earnedItems++;
+        }
+
+        gameState.player.lastCheckpoint = item.position;
+        gameState.player.lastCheckpointItemId = item.itemId;
+    }
+}
+
+void SimulationSystem::step(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                            float deltaTime, const SimulationEvents& events) {
+    float scaledDeltaTime = deltaTime * gameState.progress.timeScale;
+
+    gameState.progress.gameTime += deltaTime;
+    gameState.progress.simulationTime += deltaTime;
+    if (gameState.progress.isTimeAttackMode && !gameState.progress.isStageCompleted) {
+        gameState.progress.currentTimeAttackTime += deltaTime;
+    }
+
+    updateWorld(gameState, platformSystem, scaledDeltaTime);
+    updatePhysics(gameState, platformSystem, currentStage, deltaTime, scaledDeltaTime, events);
+    updateTriggers(gameState, platformSystem);
+    updateItems(gameState, scaledDeltaTime, events);
+}
+
+void SimulationSystem::step(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                            float deltaTime, const TickInput& input, const SimulationEvents& events) {
+    float scaledDeltaTime = deltaTime * gameState.progress.timeScale;
+
+    gameState.progress.gameTime += deltaTime;
+    gameState.progress.simulationTime += deltaTime;
+    if (gameState.progress.isTimeAttackMode && !gameState.progress.isStageCompleted) {
+        gameState.progress.currentTimeAttackTime += deltaTime;
+    }
+
+    updateWorld(gameState, platformSystem, scaledDeltaTime);
+
+    // ゲーム本体ではtimeScaleの切り替えが入力処理の中で行われるため、このステップの移動には変更前の値を使う
+    gameState.progress.timeScaleLevel = std::min<int>(input.timeScaleLevel, 2);
+    gameState.progress.timeScale = 1.0f + static_cast<float>(gameState.progress.timeScaleLevel);
+    applyInput(gameState, platformSystem, input, glm::vec3(0, -1, 0), scaledDeltaTime, events);
+
+    updatePhysics(gameState, platformSystem, currentStage, deltaTime, scaledDeltaTime, events);
+    updateTriggers(gameState, platformSystem);
+    updateItems(gameState, scaledDeltaTime, events);
+}
+
+void SimulationSystem::emitSFX(const SimulationEvents& events, const std::string& name) {
+    if (events.onPlaySFX) {
+        events.onPlaySFX(name);
+    }
+}
+
+void SimulationSystem::respawnAfterFall(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                                        const SimulationEvents& events) {
+    emitSFX(events, "on_ground");  // damageSEとしてon_groundを使用
+
+    if (gameState.progress.isEasyMode) {
+        if (gameState.player.isTrackingPlatform && gameState.player.lastPlatformIndex >= 0) {
+            const auto& platforms = platformSystem.getPlatforms();
+            if (gameState.player.lastPlatformIndex < static_cast<int>(platforms.size())) {
+                std::visit([&](const auto& platform) {
+                    glm::vec3 currentPlatformPos = platform.position;
+                    gameState.player.position = currentPlatformPos + glm::vec3(0, 2.0f, 0);
+                }, platforms[gameState.player.lastPlatformIndex]);
+            } else {
+                gameState.player.position = gameState.player.lastPlatformPosition + glm::vec3(0, 2.0f, 0);
+            }
+        } else {
+            gameState.player.position = gameState.player.lastPlatformPosition + glm::vec3(0, 2.0f, 0);
+        }
+        gameState.player.velocity = glm::vec3(0, 0, 0);
+    } else if (currentStage == 0) {
+        gameState.player.position = glm::vec3(8, 2.0f, 0);
+        gameState.player.velocity = glm::vec3(0, 0, 0);
+    } else if (currentStage == 6) {
+        gameState.player.position = gameState.progress.tutorialStartPosition;
+        gameState.player.velocity = glm::vec3(0, 0, 0);
+        printf("TUTORIAL: Respawned at start position (%.1f, %.1f, %.1f)\n",
+               gameState.progress.tutorialStartPosition.x, gameState.progress.tutorialStartPosition.y, gameState.progress.tutorialStartPosition.z);
+    } else {
+        gameState.progress.lives--;
+
+        emitSFX(events, "damage");
+
+        if (gameState.progress.lives <= 0) {
+            gameState.progress.isGameOver = true;
+            gameState.progress.gameOverTimer = 0.0f;
+        }
+        if (gameState.player.lastCheckpointItemId != -1) {
+            gameState.player.position = gameState.player.lastCheckpoint;
+        } else {
+            gameState.player.position = glm::vec3(0, 6.0f, -25.0f);
+        }
+        gameState.player.velocity = glm::vec3(0, 0, 0);
+    }
+}
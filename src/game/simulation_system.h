@@ -0,0 +1,131 @@
+/**
+ * @file simulation_system.h
+ * @brief シミュレーションシステム
+ * @details ウィンドウ・描画・音声に依存しないゲームシミュレーションの1ステップを提供します。
+ * ゲーム本体とヘッドレス実行（slime_headless）の両方から利用されます。
+ */
+#pragma once
+
+#include "game_state.h"
+#include "platform_system.h"
+#include "input_replay.h"
+#include <functional>
+#include <string>
+
+/**
+ * @brief シミュレーションイベント
+ * @details 効果音の再生やクリア処理など、シミュレーション外で行う処理への通知です。
+ * 未設定のコールバックは呼び出されません。
+ */
+struct SimulationEvents {
+    std::function<void(const std::string&)> onPlaySFX;  // 効果音名（"on_ground"、"damage"、"item"、"jump"）
+    std::function<void()> onGoalReached;                 // ゴール到達時（クリアフラグ設定後に呼ばれる）
+};
+
+/**
+ * @brief シミュレーションシステム
+ * @details プラットフォーム・ギミックの更新、物理演算と衝突判定、アイテム収集を担当します。
+ * GLFW、OpenGL、SDLには依存しません。
+ */
+class SimulationSystem {
+public:
+    /**
+     * @brief ステージ上のギミックを更新する
+     * @details プラットフォーム、重力反転エリア、スイッチ、大砲を通常モードで更新します。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム
+     * @param scaledDeltaTime スケールされたデルタタイム
+     */
+    static void updateWorld(GameState& gameState, PlatformSystem& platformSystem, float scaledDeltaTime);
+
+    /**
+     * @brief プレイヤーの入力を適用する
+     * @details 移動とジャンプ（足場の上ならジャンプ、空中なら二段ジャンプ・バーストジャンプ）を処理します。
+     * ゴール後とゲームオーバー時は何もしません。ゲーム本体の入力処理と入力リプレイの再シミュレーションの両方から呼ばれます。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム（足場判定に使用）
+     * @param input 1ティック分の入力
+     * @param gravityDirection ジャンプの向きの判定に使う重力方向
+     * @param scaledDeltaTime スケールされたデルタタイム
+     * @param events シミュレーションイベント
+     */
+    static void applyInput(GameState& gameState, PlatformSystem& platformSystem, const TickInput& input,
+                           const glm::vec3& gravityDirection, float scaledDeltaTime, const SimulationEvents& events);
+
+    /**
+     * @brief 物理演算と衝突判定を更新する
+     * @details 重力、速度、位置、プラットフォーム衝突、ゴール判定、落下判定を処理します。
+     * ゲームオーバー時は何もしません。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム
+     * @param currentStage 現在のステージ番号（落下時の復帰位置の決定に使用）
+     * @param deltaTime デルタタイム
+     * @param scaledDeltaTime スケールされたデルタタイム
+     * @param events シミュレーションイベント
+     */
+    static void updatePhysics(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                              float deltaTime, float scaledDeltaTime, const SimulationEvents& events);
+
+    /**
+     * @brief トリガーの接触判定を更新する
+     * @details プレイヤー位置でTriggerSystem::update()を1回だけ行い、スイッチと大砲のイベントを処理します。
+     * アイテムの収集と重力反転エリアは、この結果をupdateItems()と次ステップのupdatePhysics()で参照します。
+     * リプレイ再生中はスイッチと大砲を作動させません。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム（スイッチの対象）
+     */
+    static void updateTriggers(GameState& gameState, PlatformSystem& platformSystem);
+
+    /**
+     * @brief アイテムを更新する
+     * @details アイテムの回転、上下動と、updateTriggers()の結果による収集判定を処理します。
+     *
+     * @param gameState ゲーム状態
+     * @param scaledDeltaTime スケールされたデルタタイム
+     * @param events シミュレーションイベント
+     */
+    static void updateItems(GameState& gameState, float scaledDeltaTime, const SimulationEvents& events);
+
+    /**
+     * @brief シミュレーションを1ステップ進める
+     * @details 入力なしでギミック、物理演算、トリガー、アイテムを順に更新します。
+     * ヘッドレス実行用で、ゲーム本体はGameUpdaterから個別の関数を呼び出します。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム
+     * @param currentStage 現在のステージ番号
+     * @param deltaTime デルタタイム
+     * @param events シミュレーションイベント
+     */
+    static void step(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                     float deltaTime, const SimulationEvents& events = SimulationEvents());
+
+    /**
+     * @brief 入力を与えてシミュレーションを1ステップ進める
+     * @details ゲーム本体と同じ順序（ギミック、timeScaleの変更と入力、物理演算、トリガー、アイテム）で更新します。
+     * timeScaleの変更はゲーム本体と同じく、ギミックの更新後に反映されます。
+     * ジャンプの判定はゲーム本体と同じく下向きの重力方向で行います。
+     *
+     * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム
+     * @param currentStage 現在のステージ番号
+     * @param deltaTime デルタタイム
+     * @param input 1ティック分の入力
+     * @param events シミュレーションイベント
+     */
+    static void step(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                     float deltaTime, const TickInput& input, const SimulationEvents& events = SimulationEvents());
+
+private:
+    static void emitSFX(const SimulationEvents& events, const std::string& name);
+    static void applyJump(GameState& gameState, PlatformSystem& platformSystem, const glm::vec3& gravityDirection,
+                          const SimulationEvents& events);
+    static void resolveTunneling(GameState& gameState, PlatformSystem& platformSystem, const glm::vec3& stepStart,
+                                 const glm::vec3& stepDisplacement, const glm::vec3& playerSize);
+    static void respawnAfterFall(GameState& gameState, PlatformSystem& platformSystem, int currentStage,
+                                 const SimulationEvents& events);
+};
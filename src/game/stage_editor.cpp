@@ -220,6 +220,7 @@ void StageEditor::moveSelectedObject(EditorState& editorState, PlatformSystem& p
             platform.position.z = std::round(platform.position.z / editorState.gridSize) * editorState.gridSize;
         }
     }, *editorState.selectedPlatform);
+    platformSystem.markSpatialIndexDirty();
 }
 
 void StageEditor::renderEditorUI(GLFWwindow* window, const EditorState& editorState,
@@ -740,6 +741,7 @@ void StageEditor::processEditorInput(GLFWwindow* window, GameState& gameState,
             
             platform.position = newPosition;
         }, *editorState.selectedPlatform);
+        platformSystem.markSpatialIndexDirty();
     }
     
     if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) {
@@ -4,7 +4,9 @@
 
 #include "stage_manager.h"
 #include "json_stage_loader.h"
-#include "../core/constants/game_constants.h"
+#include "trigger_system.h"
+#include "../core/constants/stage_constants.h"
+#include "../core/constants/color_constants.h"
 #include "../core/constants/debug_config.h"
 #include "../core/utils/stage_utils.h"
 #include "../core/utils/resource_path.h"
@@ -130,7 +132,6 @@ bool StageManager::loadStage(int stageNumber, GameState& gameState, PlatformSyst
         return false;
     }
     
-    gameState.platforms.clear();
     gameState.gravityZones.clear();
     gameState.switches.clear();
     gameState.cannons.clear();
@@ -194,6 +195,8 @@ bool StageManager::loadStage(int stageNumber, GameState& gameState, PlatformSyst
     gameState.progress.currentStage = stageNumber;
     
     stageIt->generateFunction(gameState, platformSystem);
+    platformSystem.rebuildSpatialIndex();  // 静的ツリーは読み込み時に一度だけ構築する
+    TriggerSystem::rebuild(gameState, stageNumber == 0);
     
     if (stageNumber != 0 && stageNumber != 6 && gameState.progress.selectedSecretStarType == GameProgressState::SecretStarType::MAX_SPEED_STAR) {
         gameState.progress.timeScale = 3.0f;
@@ -0,0 +1,562 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "submission_queue.h"
+#include "replay_codec.h"
+#include "http_worker.h"
+#include "leaderboard_cache.h"
+#include "../core/utils/completion_queue.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+    constexpr const char* QUEUE_FILE_NAME = "submission_queue.jsonl";
+    constexpr const char* CLIENT_FILE_NAME = "submission_client.json";
+    constexpr size_t CLIENT_ID_BYTES = 16;
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 追加された記録（送信キューのスレッドでエンコードしてファイルに書き込む）
+     */
+    struct Job {
+        int stageNumber = 0;
+        float time = 0.0f;
+        std::string playerName;
+        ReplayData replayData;
+        std::function<void(bool)> callback;
+    };
+
+    /**
+     * @brief ファイルに書き込み済みの送信待ちの記録
+     */
+    struct Submission {
+        uint64_t id = 0;
+        int stageNumber = 0;
+        float time = 0.0f;
+        std::string playerName;
+        std::string recordedDate;
+        float frameRate = 0.0f;
+        std::string replay;        // ReplayCodecの形式をBase64にしたもの（リプレイなしの場合は空）
+        int replayVersion = 0;
+        std::string inputs;        // 入力リプレイをBase64にしたもの（ない場合は空）
+        int inputsVersion = 0;
+        std::function<void(bool)> callback;  // 今回の起動中に追加したものだけ
+    };
+
+    struct QueueState {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Job> jobs;                // ファイルへの書き込み待ち
+        std::vector<Submission> pending;     // 送信待ち（追加した順）
+        std::vector<uint64_t> finishedIds;   // 完了の行の書き込み待ち
+        uint64_t nextId = 1;                 // 送信キューのファイルを消しても、インストールごとに重ならないよう保存する
+        std::string clientId;                // インストールごとのID（サーバーが再送による重複を見分けるため）
+        uint64_t inFlightId = 0;             // 送信中の記録（0の場合はなし）
+        int failureCount = 0;                // 続けて送信できなかった回数
+        Clock::time_point nextAttempt;
+        std::string url;
+        bool stopping = false;
+        std::thread thread;
+
+        ~QueueState() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    };
+
+    QueueState state;
+
+    std::string getSaveFilePath(const char* fileName) {
+        std::error_code error;
+        if (!std::filesystem::is_directory("assets/save", error) && std::filesystem::is_directory("../assets/save", error)) {
+            return std::string("../assets/save/") + fileName;
+        }
+        return std::string("assets/save/") + fileName;
+    }
+
+    std::string getQueueFilePath() {
+        return getSaveFilePath(QUEUE_FILE_NAME);
+    }
+
+    std::string generateClientId() {
+        std::random_device random;
+        std::string clientId;
+        constexpr const char* HEX = "0123456789abcdef";
+        for (size_t i = 0; i < CLIENT_ID_BYTES; i++) {
+            unsigned int value = random() & 0xFF;
+            clientId += HEX[value >> 4];
+            clientId += HEX[value & 0x0F];
+        }
+        return clientId;
+    }
+
+    /**
+     * @brief インストールごとのIDと次の記録のIDを保存する
+     */
+    void saveClient(const std::string& clientId, uint64_t nextId) {
+        std::string path = getSaveFilePath(CLIENT_FILE_NAME);
+        std::string tempPath = path + ".tmp";
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "Submission queue: Failed to open for writing: " << tempPath << std::endl;
+                return;
+            }
+            file << nlohmann::json{{"clientId", clientId}, {"nextId", nextId}}.dump();
+            if (!file) {
+                return;
+            }
+        }
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            std::cerr << "Submission queue: Failed to replace " << path << ": " << error.message() << std::endl;
+        }
+    }
+
+    /**
+     * @brief インストールごとのIDを読み込む（ない場合は作って保存する）
+     */
+    std::string loadClient(uint64_t& nextId) {
+        std::string clientId;
+        std::ifstream file(getSaveFilePath(CLIENT_FILE_NAME));
+        if (file.is_open()) {
+            try {
+                nlohmann::json json;
+                file >> json;
+                clientId = json.value("clientId", "");
+                nextId = std::max(nextId, json.value("nextId", static_cast<uint64_t>(1)));
+            } catch (const std::exception& e) {
+                std::cerr << "Submission queue: Failed to parse client file: " << e.what() << std::endl;
+            }
+        }
+        if (clientId.empty()) {
+            clientId = generateClientId();
+            saveClient(clientId, nextId);
+        }
+        return clientId;
+    }
+
+    nlohmann::json toJson(const Submission& submission) {
+        return {
+            {"op", "add"},
+            {"id", submission.id},
+            {"stageNumber", submission.stageNumber},
+            {"time", submission.time},
+            {"playerName", submission.playerName},
+            {"recordedDate", submission.recordedDate},
+            {"frameRate", submission.frameRate},
+            {"replay", submission.replay},
+            {"replayVersion", submission.replayVersion},
+            {"inputs", submission.inputs},
+            {"inputsVersion", submission.inputsVersion}
+        };
+    }
+
+    Submission fromJson(const nlohmann::json& json) {
+        Submission submission;
+        submission.id = json.value("id", static_cast<uint64_t>(0));
+        submission.stageNumber = json.value("stageNumber", 0);
+        submission.time = json.value("time", 0.0f);
+        submission.playerName = json.value("playerName", "");
+        submission.recordedDate = json.value("recordedDate", "");
+        submission.frameRate = json.value("frameRate", 0.0f);
+        submission.replay = json.value("replay", "");
+        submission.replayVersion = json.value("replayVersion", 0);
+        submission.inputs = json.value("inputs", "");
+        submission.inputsVersion = json.value("inputsVersion", 0);
+        return submission;
+    }
+
+    /**
+     * @brief ファイルに行を追記する
+     * @details 1行が1件の操作です。書き込み途中で終了した場合、最後の行だけが壊れます（読み込み時に捨てる）。
+     */
+    void appendLines(const std::vector<std::string>& lines) {
+        std::string path = getQueueFilePath();
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        std::ofstream file(path, std::ios::app | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Submission queue: Failed to open for writing: " << path << std::endl;
+            return;
+        }
+        for (const auto& line : lines) {
+            file << line << '\n';
+        }
+        file.flush();
+    }
+
+    /**
+     * @brief 送信待ちの記録だけでファイルを書き直す
+     */
+    void rewrite(const std::vector<Submission>& submissions) {
+        std::string path = getQueueFilePath();
+        std::error_code error;
+        if (submissions.empty()) {
+            std::filesystem::remove(path, error);
+            return;
+        }
+
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc | std::ios::binary);
+            if (!file.is_open()) {
+                std::cerr << "Submission queue: Failed to open for writing: " << tempPath << std::endl;
+                return;
+            }
+            for (const auto& submission : submissions) {
+                file << toJson(submission).dump() << '\n';
+            }
+            if (!file) {
+                return;
+            }
+        }
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            std::cerr << "Submission queue: Failed to replace " << path << ": " << error.message() << std::endl;
+        }
+    }
+
+    /**
+     * @brief ファイルから送信待ちの記録を読み込む
+     * @details 追加の行から完了の行を差し引き、同じステージとプレイヤー名では最も速い記録だけを残して、ファイルを詰め直します。
+     */
+    std::vector<Submission> load(uint64_t& nextId) {
+        std::vector<Submission> submissions;
+        std::ifstream file(getQueueFilePath(), std::ios::binary);
+        if (!file.is_open()) {
+            return submissions;
+        }
+
+        std::map<uint64_t, Submission> added;
+        std::string line;
+        while (std::getline(file, line)) {
+            nlohmann::json json;
+            try {
+                json = nlohmann::json::parse(line);
+            } catch (const std::exception&) {
+                printf("ONLINE: Submission queue has a broken line, ignoring the rest\n");
+                break;
+            }
+            if (!json.is_object()) {
+                break;
+            }
+            uint64_t id = json.value("id", static_cast<uint64_t>(0));
+            nextId = std::max(nextId, id + 1);
+            if (json.value("op", "") == "add") {
+                added[id] = fromJson(json);
+            } else {
+                added.erase(id);
+            }
+        }
+        file.close();
+
+        for (auto& [id, submission] : added) {
+            auto same = std::find_if(submissions.begin(), submissions.end(), [&submission](const Submission& other) {
+                return other.stageNumber == submission.stageNumber && other.playerName == submission.playerName;
+            });
+            if (same == submissions.end()) {
+                submissions.push_back(std::move(submission));
+            } else if (submission.time < same->time) {
+                *same = std::move(submission);
+            }
+        }
+        rewrite(submissions);
+        if (!submissions.empty()) {
+            printf("ONLINE: %zu pending submissions from the last session\n", submissions.size());
+        }
+        return submissions;
+    }
+
+    Submission encode(Job& job, uint64_t id) {
+        Submission submission;
+        submission.id = id;
+        submission.stageNumber = job.stageNumber;
+        submission.time = job.time;
+        submission.playerName = job.playerName;
+        submission.callback = std::move(job.callback);
+        if (!job.replayData.frames.empty()) {
+            submission.recordedDate = job.replayData.recordedDate;
+            submission.frameRate = job.replayData.frameRate;
+            submission.replay = ReplayCodec::toBase64(ReplayCodec::encode(job.replayData));
+            submission.replayVersion = ReplayCodec::FORMAT_VERSION;
+            // 入力リプレイがあれば、サーバー側で再シミュレーションして検証できるように添付する
+            if (!job.replayData.inputs.inputs.empty()) {
+                submission.inputs = ReplayCodec::toBase64(ReplayCodec::encodeInputs(job.replayData.inputs));
+                submission.inputsVersion = ReplayCodec::INPUT_FORMAT_VERSION;
+            }
+        }
+        return submission;
+    }
+
+    std::string makeBody(const Submission& submission, const std::string& clientId) {
+        nlohmann::json jsonData;
+        // 再送で同じ記録が2回登録されないよう、サーバーはclientIdとsubmissionIdの組で重複を取り除く
+        jsonData["clientId"] = clientId;
+        jsonData["submissionId"] = submission.id;
+        jsonData["stageNumber"] = submission.stageNumber;
+        jsonData["time"] = submission.time;
+        jsonData["playerName"] = submission.playerName;
+        if (!submission.replay.empty()) {
+            nlohmann::json replayJson;
+            replayJson["stageNumber"] = submission.stageNumber;
+            replayJson["clearTime"] = submission.time;
+            replayJson["recordedDate"] = submission.recordedDate;
+            replayJson["frameRate"] = submission.frameRate;
+            replayJson["format"] = "slrp";
+            replayJson["version"] = submission.replayVersion;
+            replayJson["data"] = submission.replay;
+            if (!submission.inputs.empty()) {
+                replayJson["inputs"] = submission.inputs;
+                replayJson["inputsVersion"] = submission.inputsVersion;
+            }
+            jsonData["replayData"] = replayJson;
+        }
+        return jsonData.dump();
+    }
+
+    void postCallback(std::function<void(bool)> callback, bool success) {
+        if (callback) {
+            CompletionQueue::post([callback = std::move(callback), success]() {
+                callback(success);
+            });
+        }
+    }
+
+    /**
+     * @brief 送信待ちの記録を取り除く（stateのmutexを保持して呼び出す）
+     */
+    void finish(uint64_t id, bool success) {
+        auto it = std::find_if(state.pending.begin(), state.pending.end(),
+                               [id](const Submission& submission) { return submission.id == id; });
+        if (it == state.pending.end()) {
+            return;
+        }
+        postCallback(std::move(it->callback), success);
+        state.pending.erase(it);
+        state.finishedIds.push_back(id);
+    }
+
+    void onSubmitted(uint64_t id, const HttpResponse& response) {
+        bool accepted = false;
+        bool rejected = false;
+        if (response.success) {
+            try {
+                accepted = nlohmann::json::parse(response.body).value("success", false);
+            } catch (...) {
+                accepted = false;
+            }
+            rejected = !accepted;
+        } else if (response.httpCode >= 400 && response.httpCode < 500) {
+            // 記録の内容が拒否された場合は、再送しても変わらない
+            rejected = true;
+        }
+
+        int stageNumber = 0;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.inFlightId = 0;
+            auto it = std::find_if(state.pending.begin(), state.pending.end(),
+                                   [id](const Submission& submission) { return submission.id == id; });
+            if (it != state.pending.end()) {
+                stageNumber = it->stageNumber;
+            }
+
+            if (accepted || rejected) {
+                finish(id, accepted);
+                state.failureCount = 0;
+                state.nextAttempt = Clock::now();
+            } else {
+                state.failureCount++;
+                float delay = std::min(SubmissionQueue::MAX_RETRY_SECONDS,
+                                       SubmissionQueue::INITIAL_RETRY_SECONDS * static_cast<float>(1 << std::min(state.failureCount - 1, 16)));
+                state.nextAttempt = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(delay));
+                printf("ONLINE: Failed to submit record (HTTP %ld), retrying in %.0fs\n", response.httpCode, delay);
+            }
+        }
+        state.wake.notify_all();
+
+        if (accepted) {
+            printf("ONLINE: Record submitted for stage %d\n", stageNumber);
+            // 自分の記録でランキングが変わるため、次の取得で再検証させる
+            CompletionQueue::post([stageNumber]() {
+                LeaderboardCache::invalidate(stageNumber);
+            });
+        } else if (rejected) {
+            printf("ONLINE: Record for stage %d was rejected (HTTP %ld)\n", stageNumber, response.httpCode);
+        }
+    }
+
+    void workerLoop() {
+        uint64_t nextId = 1;
+        std::vector<Submission> loaded = load(nextId);
+        std::string clientId = loadClient(nextId);
+
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.nextId = std::max(state.nextId, nextId);
+        state.clientId = clientId;
+        state.pending.insert(state.pending.begin(), std::make_move_iterator(loaded.begin()), std::make_move_iterator(loaded.end()));
+
+        while (true) {
+            // 追加された記録をエンコードしてファイルに書き込む
+            if (!state.jobs.empty()) {
+                Job job = std::move(state.jobs.front());
+                state.jobs.pop_front();
+
+                // 同じステージにもっと速い（同じ）記録があれば送らない
+                bool hasBetter = std::any_of(state.pending.begin(), state.pending.end(), [&job](const Submission& submission) {
+                    return submission.stageNumber == job.stageNumber && submission.playerName == job.playerName &&
+                           submission.time <= job.time;
+                });
+                if (hasBetter) {
+                    printf("ONLINE: A faster record for stage %d is already pending, skipping %.2fs\n", job.stageNumber, job.time);
+                    postCallback(std::move(job.callback), false);
+                    continue;
+                }
+
+                uint64_t id = state.nextId++;
+                uint64_t nextId = state.nextId;
+                lock.unlock();
+                saveClient(state.clientId, nextId);
+                Submission submission = encode(job, id);
+                appendLines({toJson(submission).dump()});
+                lock.lock();
+
+                // 送信中でない遅い記録は、この記録に置き換える
+                std::vector<uint64_t> slower;
+                for (const auto& other : state.pending) {
+                    if (other.stageNumber == submission.stageNumber && other.playerName == submission.playerName &&
+                        other.id != state.inFlightId) {
+                        slower.push_back(other.id);
+                    }
+                }
+                for (uint64_t slowerId : slower) {
+                    finish(slowerId, false);
+                }
+                printf("ONLINE: Queued record for stage %d: %.2fs (%zu pending)\n",
+                       submission.stageNumber, submission.time, state.pending.size() + 1);
+                state.pending.push_back(std::move(submission));
+                continue;
+            }
+
+            // 完了した記録を書き込み、全て完了したらファイルを詰め直す
+            if (!state.finishedIds.empty()) {
+                std::vector<std::string> lines;
+                for (uint64_t id : state.finishedIds) {
+                    lines.push_back(nlohmann::json{{"op", "done"}, {"id", id}}.dump());
+                }
+                state.finishedIds.clear();
+                bool isEmpty = state.pending.empty() && state.jobs.empty();
+                lock.unlock();
+                if (isEmpty) {
+                    rewrite({});
+                } else {
+                    appendLines(lines);
+                }
+                lock.lock();
+                continue;
+            }
+
+            if (state.stopping) {
+                break;
+            }
+
+            // 送信中の記録がなければ、最も古い記録を送信する
+            bool canSend = state.inFlightId == 0 && !state.pending.empty() && !state.url.empty();
+            if (canSend && Clock::now() >= state.nextAttempt) {
+                Submission submission = state.pending.front();
+                submission.callback = nullptr;
+                uint64_t id = submission.id;
+                state.inFlightId = id;
+
+                HttpRequest request;
+                request.method = HttpRequest::Method::Post;
+                request.url = state.url;
+                // 大きなリプレイを遅い回線で送ることもあるため、全体の時間では打ち切らない（ほとんど送れない場合に中断する）
+                request.timeoutSeconds = 0;
+                // JSONの組み立ては通信スレッドで行う
+                request.makeBody = [submission = std::move(submission), clientId = state.clientId]() {
+                    return makeBody(submission, clientId);
+                };
+                request.onComplete = [id](const HttpResponse& response) {
+                    onSubmitted(id, response);
+                };
+                lock.unlock();
+                HttpWorker::submit(std::move(request));
+                lock.lock();
+                continue;
+            }
+
+            if (canSend) {
+                state.wake.wait_until(lock, state.nextAttempt);
+            } else {
+                state.wake.wait(lock);
+            }
+        }
+    }
+}
+
+void SubmissionQueue::start(const std::string& url) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.url = url;
+    if (!state.thread.joinable() && !state.stopping) {
+        state.nextAttempt = Clock::now();
+        state.thread = std::thread(workerLoop);
+    }
+    state.wake.notify_all();
+}
+
+void SubmissionQueue::enqueue(int stageNumber, float time, const std::string& playerName, ReplayData replayData,
+                              std::function<void(bool)> callback) {
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.stopping) {
+            return;
+        }
+        Job job;
+        job.stageNumber = stageNumber;
+        job.time = time;
+        job.playerName = playerName;
+        job.replayData = std::move(replayData);
+        job.callback = std::move(callback);
+        state.jobs.push_back(std::move(job));
+    }
+    state.wake.notify_all();
+}
+
+size_t SubmissionQueue::pendingCount() {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.pending.size() + state.jobs.size();
+}
+
+void SubmissionQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stopping = true;
+    }
+    state.wake.notify_all();
+    if (state.thread.joinable()) {
+        state.thread.join();
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ * @file submission_queue.h
+ * @brief タイム記録の送信キュー
+ * @details 送信する記録をファイルに保存してから、通信できるようになるまで再送します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "replay_state.h"
+#include <functional>
+#include <string>
+
+/**
+ * @brief タイム記録の送信キュー
+ * @details 送信する記録（リプレイを含む）は送信キューのスレッドでエンコードし、
+ * assets/save/submission_queue.jsonlに1行ずつ追記してから送信します。サーバーが受け付けた（または拒否した）記録は
+ * 完了の行を追記して取り除くため、通信できないまま終了しても次回の起動時に続きから送信します。
+ *
+ * 同じステージの送信待ちの記録は最も速い1件だけを残します（送信中のものは取り消さない）。
+ * 通信できなかった場合やサーバーのエラー（5xx）の場合は、INITIAL_RETRY_SECONDSから倍にしながら
+ * MAX_RETRY_SECONDSまで間隔を空けて再送します。サーバーが登録した後に応答が届かず再送した場合も重複しないよう、
+ * 記録にはインストールごとのID（assets/save/submission_client.json）と記録のIDを付けて送ります。
+ *
+ * enqueue()はデータを渡すだけで、ファイルの書き込みや通信を待ちません。
+ * コールバックはCompletionQueueを通してメインスレッドで呼び出します。
+ */
+class SubmissionQueue {
+public:
+    static constexpr float INITIAL_RETRY_SECONDS = 2.0f;  /**< @brief 最初の再送までの間隔（秒） */
+    static constexpr float MAX_RETRY_SECONDS = 300.0f;    /**< @brief 再送の間隔の上限（秒） */
+
+    /**
+     * @brief 送信キューを開始する
+     * @details ファイルに残っている送信待ちの記録を読み込み、送信を始めます。2回目以降はURLだけを変更します。
+     * @param url 記録を送信するURL
+     */
+    static void start(const std::string& url);
+
+    /**
+     * @brief 記録を送信キューに追加する
+     * @param stageNumber ステージ番号
+     * @param time クリアタイム（秒）
+     * @param playerName プレイヤー名（送信する形に変換済みのもの）
+     * @param replayData リプレイデータ（フレームが空の場合はリプレイなしで送信する）
+     * @param callback 完了時のコールバック関数（任意）。サーバーが受け付けた場合true、拒否された場合や
+     * より速い記録に置き換えた場合false。通信できない間は呼び出さず、再送を続けます。
+     */
+    static void enqueue(int stageNumber, float time, const std::string& playerName, ReplayData replayData,
+                        std::function<void(bool)> callback = nullptr);
+
+    /**
+     * @brief 送信待ちの記録の件数を取得する
+     * @return 件数（送信中のものを含む）
+     */
+    static size_t pendingCount();
+
+    /**
+     * @brief 送信キューのスレッドを終了する
+     * @details 追加済みの記録をファイルに書き終えてから終了します（送信は次回の起動時に続けます）。
+     * HttpWorker::shutdown()より前に呼び出します。
+     */
+    static void shutdown();
+};
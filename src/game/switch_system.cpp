@@ -3,7 +3,8 @@
 #endif
 
 #include "switch_system.h"
-#include "../core/constants/game_constants.h"
+#include "../core/constants/physics_constants.h"
+#include "../core/constants/stage_constants.h"
 #include <iostream>
 
 void SwitchSystem::updateSwitches(GameState& gameState, float deltaTime) {
@@ -29,50 +30,40 @@ void SwitchSystem::updateSwitches(GameState& gameState, float deltaTime) {
     }
 }
 
-bool SwitchSystem::checkSwitchCollision(GameState& gameState, const glm::vec3& playerPos, const glm::vec3& playerSize) {
-    for (auto& switch_obj : gameState.switches) {
-        if (switch_obj.cooldownTimer > 0.0f) continue; // クールダウン中は無視
+bool SwitchSystem::checkSwitchCollision(GameState& gameState, PlatformSystem& platformSystem) {
+    auto& platforms = platformSystem.getPlatforms();
+    
+    // イベントはボリューム順（スイッチの番号順）に並ぶため、最初に触れたスイッチだけを処理する
+    for (const auto& event : gameState.triggers.events) {
+        if (event.type != TriggerType::Switch || event.phase == TriggerPhase::Exit) continue;
+        if (event.targetIndex >= static_cast<int>(gameState.switches.size())) continue;
         
-        glm::vec3 switchMin = switch_obj.position - switch_obj.size * GameConstants::PhysicsCalculationConstants::PLATFORM_HALF_SIZE_MULTIPLIER;
-        glm::vec3 switchMax = switch_obj.position + switch_obj.size * GameConstants::PhysicsCalculationConstants::PLATFORM_HALF_SIZE_MULTIPLIER;
-        glm::vec3 playerMin = playerPos - playerSize * GameConstants::PhysicsCalculationConstants::PLAYER_HALF_SIZE_MULTIPLIER;
-        glm::vec3 playerMax = playerPos + playerSize * GameConstants::PhysicsCalculationConstants::PLAYER_HALF_SIZE_MULTIPLIER;
+        auto& switch_obj = gameState.switches[event.targetIndex];
+        if (switch_obj.cooldownTimer > 0.0f) continue; // クールダウン中は無視
         
-        if (playerMax.x >= switchMin.x && playerMin.x <= switchMax.x &&
-            playerMax.y >= switchMin.y && playerMin.y <= switchMax.y &&
-            playerMax.z >= switchMin.z && playerMin.z <= switchMax.z) {
+        if (!switch_obj.isPressed) {
+            switch_obj.isPressed = true;
+            switch_obj.pressTimer = 0.0f;
+            switch_obj.cooldownTimer = GameConstants::StageConstants::SWITCH_COOLDOWN_TIME; // クールダウン
             
-            if (!switch_obj.isPressed) {
-                switch_obj.isPressed = true;
-                switch_obj.pressTimer = 0.0f;
-                switch_obj.cooldownTimer = GameConstants::StageConstants::SWITCH_COOLDOWN_TIME; // クールダウン
-                
-                if (!switch_obj.isMultiSwitch) {
-                    for (size_t i = 0; i < switch_obj.targetPlatformIndices.size(); i++) {
-                        int platformIndex = switch_obj.targetPlatformIndices[i];
-                        if (platformIndex >= 0 && platformIndex < static_cast<int>(gameState.platforms.size())) {
-                            bool targetState = switch_obj.targetStates[i];
-                            if (switch_obj.isToggle) {
-                                if (targetState) {
-                                    gameState.platforms[platformIndex].size = gameState.platforms[platformIndex].originalSize;
-                                } else {
-                                    gameState.platforms[platformIndex].size = glm::vec3(0, 0, 0);
-                                }
-                                switch_obj.targetStates[i] = !targetState;
-                            } else {
-                                if (targetState) {
-                                    gameState.platforms[platformIndex].size = gameState.platforms[platformIndex].originalSize;
-                                } else {
-                                    gameState.platforms[platformIndex].size = glm::vec3(0, 0, 0);
-                                }
-                            }
+            if (!switch_obj.isMultiSwitch) {
+                for (size_t i = 0; i < switch_obj.targetPlatformIndices.size(); i++) {
+                    int platformIndex = switch_obj.targetPlatformIndices[i];
+                    if (platformIndex >= 0 && platformIndex < static_cast<int>(platforms.size())) {
+                        bool targetState = switch_obj.targetStates[i];
+                        // サイズではなく表示状態で切り替える（非表示の足場は衝突判定・描画の対象外）
+                        std::visit([targetState](auto& platform) {
+                            platform.isVisible = targetState;
+                        }, platforms[platformIndex]);
+                        platformSystem.refreshCollisionBounds(platformIndex);
+                        if (switch_obj.isToggle) {
+                            switch_obj.targetStates[i] = !targetState;
                         }
                     }
                 }
             }
-            return true;
         }
+        return true;
     }
     return false;
 }
-
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "game_state.h"
+#include "platform_system.h"
 
 /**
  * @brief スイッチシステム
@@ -24,12 +25,12 @@ public:
     
     /**
      * @brief スイッチとの衝突判定
-     * @details プレイヤーとスイッチの衝突を判定します。
+     * @details 直前のTriggerSystem::update()の結果からプレイヤーと接触しているスイッチを押し、
+     * 対象プラットフォームの表示状態を切り替えます。
      * 
      * @param gameState ゲーム状態
-     * @param playerPos プレイヤー位置
-     * @param playerSize プレイヤーサイズ
-     * @return 衝突した場合true
+     * @param platformSystem プラットフォームシステム（targetPlatformIndicesの参照先）
+     * @return 接触しているスイッチがある場合true
      */
-    static bool checkSwitchCollision(GameState& gameState, const glm::vec3& playerPos, const glm::vec3& playerSize);
+    static bool checkSwitchCollision(GameState& gameState, PlatformSystem& platformSystem);
 };
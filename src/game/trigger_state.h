@@ -0,0 +1,80 @@
+/**
+ * @file trigger_state.h
+ * @brief トリガーボリュームの状態を管理する構造体
+ * @details アイテム、重力ゾーン、スイッチ、大砲、ステージ選択エリアなどの判定範囲と、
+ * プレイヤーとの接触イベントを保持します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "../physics/aabb_tree.h"
+
+/**
+ * @brief トリガーの種類
+ * @details 接触イベントの通知先を表します。targetIndexは種類ごとの配列のインデックスです。
+ */
+enum class TriggerType {
+    Item,         // ItemState::items
+    GravityZone,  // GameState::gravityZones
+    Switch,       // GameState::switches
+    Cannon,       // GameState::cannons
+    StageArea,    // GameConstants::STAGE_AREAS（targetIndexはステージ番号-1）
+    Leaderboard   // UIState::leaderboardPosition（targetIndexは常に0）
+};
+
+/**
+ * @brief 接触イベントの段階
+ */
+enum class TriggerPhase {
+    Enter,  // このステップで内側に入った
+    Stay,   // 前のステップから内側にいる
+    Exit    // このステップで外側に出た
+};
+
+/**
+ * @brief トリガーボリューム
+ * @details プレイヤーの中心点が内側にあるかで判定します。
+ * プレイヤーの大きさを考慮する場合は、登録時にその分だけ範囲を広げておきます。
+ */
+struct TriggerVolume {
+    enum class Shape {
+        Sphere,
+        Box
+    };
+
+    TriggerType type;
+    int targetIndex;
+    Shape shape;
+    glm::vec3 center;
+    glm::vec3 halfExtents;  // Boxの場合の半サイズ
+    float radius;           // Sphereの場合の半径
+    bool inclusive;         // 境界上を内側とみなす場合true
+};
+
+/**
+ * @brief 接触イベント
+ */
+struct TriggerEvent {
+    int volumeId;
+    TriggerType type;
+    int targetIndex;
+    TriggerPhase phase;
+};
+
+/**
+ * @brief トリガーボリュームの状態を管理する構造体
+ * @details ボリュームはステージ読み込み時にTriggerSystem::rebuild()で登録し、静的AABBツリーで索引します。
+ */
+struct TriggerState {
+    std::vector<TriggerVolume> volumes;
+    AABBTree tree;
+    std::vector<int> insideVolumes;    // 直前のupdateで内側にいたボリューム（昇順）
+    std::vector<TriggerEvent> events;  // 直前のupdateで発生したイベント（ボリュームID順）
+    std::vector<int> candidateScratch;
+    std::vector<int> nextInsideScratch;
+};
@@ -0,0 +1,137 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "trigger_system.h"
+#include "../core/constants/physics_constants.h"
+#include "../core/constants/stage_constants.h"
+#include <algorithm>
+
+void TriggerSystem::rebuild(GameState& gameState, bool includeStageSelection) {
+    TriggerState& triggers = gameState.triggers;
+    triggers.volumes.clear();
+    triggers.insideVolumes.clear();
+    triggers.events.clear();
+
+    for (int i = 0; i < static_cast<int>(gameState.items.items.size()); i++) {
+        addSphere(triggers, TriggerType::Item, i, gameState.items.items[i].position,
+                  GameConstants::StageConstants::ITEM_COLLECT_RADIUS, false);
+    }
+
+    for (int i = 0; i < static_cast<int>(gameState.gravityZones.size()); i++) {
+        const auto& zone = gameState.gravityZones[i];
+        addSphere(triggers, TriggerType::GravityZone, i, zone.position, zone.radius, true);
+    }
+
+    // スイッチと大砲はプレイヤーの箱との重なりで判定していたため、プレイヤーの半サイズだけ広げる
+    glm::vec3 playerHalfSize = GameConstants::PLAYER_SIZE * 0.5f;
+    for (int i = 0; i < static_cast<int>(gameState.switches.size()); i++) {
+        const auto& switchObj = gameState.switches[i];
+        addBox(triggers, TriggerType::Switch, i, switchObj.position, switchObj.size * 0.5f + playerHalfSize, true);
+    }
+    for (int i = 0; i < static_cast<int>(gameState.cannons.size()); i++) {
+        const auto& cannon = gameState.cannons[i];
+        addBox(triggers, TriggerType::Cannon, i, cannon.position, cannon.size * 0.5f + playerHalfSize, false);
+    }
+
+    if (includeStageSelection) {
+        // 選択エリアは高さを問わないため、Y方向は十分に大きくとる
+        const float unboundedHalfHeight = GameConstants::StageConstants::TRIGGER_UNBOUNDED_HALF_HEIGHT;
+        for (int stage = 0; stage < 5; stage++) {
+            const auto& stageArea = GameConstants::STAGE_AREAS[stage];
+            addBox(triggers, TriggerType::StageArea, stage, glm::vec3(stageArea.x, 0.0f, stageArea.z),
+                   glm::vec3(GameConstants::STAGE_SELECTION_RANGE, unboundedHalfHeight, GameConstants::STAGE_SELECTION_RANGE), false);
+        }
+        const glm::vec3& leaderboardPos = gameState.ui.leaderboardPosition;
+        addBox(triggers, TriggerType::Leaderboard, 0, glm::vec3(leaderboardPos.x, 0.0f, leaderboardPos.z),
+               glm::vec3(GameConstants::LEADERBOARD_SELECTION_RANGE, unboundedHalfHeight, GameConstants::LEADERBOARD_SELECTION_RANGE), false);
+    }
+
+    std::vector<AABBTree::BuildEntry> entries;
+    entries.reserve(triggers.volumes.size());
+    for (int i = 0; i < static_cast<int>(triggers.volumes.size()); i++) {
+        const TriggerVolume& volume = triggers.volumes[i];
+        glm::vec3 halfExtents = (volume.shape == TriggerVolume::Shape::Sphere) ? glm::vec3(volume.radius) : volume.halfExtents;
+        entries.push_back({volume.center - halfExtents, volume.center + halfExtents, i});
+    }
+    triggers.tree.build(entries);
+}
+
+void TriggerSystem::update(GameState& gameState, const glm::vec3& playerPosition) {
+    TriggerState& triggers = gameState.triggers;
+    triggers.events.clear();
+
+    triggers.candidateScratch.clear();
+    triggers.tree.query(playerPosition, playerPosition, triggers.candidateScratch);
+
+    std::vector<int>& nextInside = triggers.nextInsideScratch;
+    nextInside.clear();
+    for (int volumeId : triggers.candidateScratch) {
+        if (contains(triggers.volumes[volumeId], playerPosition)) {
+            nextInside.push_back(volumeId);
+        }
+    }
+    std::sort(nextInside.begin(), nextInside.end());
+
+    // 前回と今回の内側集合（どちらも昇順）を突き合わせてイベントを作る
+    const std::vector<int>& previousInside = triggers.insideVolumes;
+    size_t previous = 0;
+    size_t next = 0;
+    while (previous < previousInside.size() || next < nextInside.size()) {
+        int volumeId;
+        TriggerPhase phase;
+        if (next >= nextInside.size() || (previous < previousInside.size() && previousInside[previous] < nextInside[next])) {
+            volumeId = previousInside[previous++];
+            phase = TriggerPhase::Exit;
+        } else if (previous >= previousInside.size() || nextInside[next] < previousInside[previous]) {
+            volumeId = nextInside[next++];
+            phase = TriggerPhase::Enter;
+        } else {
+            volumeId = nextInside[next++];
+            previous++;
+            phase = TriggerPhase::Stay;
+        }
+        const TriggerVolume& volume = triggers.volumes[volumeId];
+        triggers.events.push_back({volumeId, volume.type, volume.targetIndex, phase});
+    }
+
+    std::swap(triggers.insideVolumes, nextInside);
+}
+
+bool TriggerSystem::findInside(const GameState& gameState, TriggerType type, int& outTargetIndex) {
+    bool found = false;
+    for (const auto& event : gameState.triggers.events) {
+        if (event.type != type || event.phase == TriggerPhase::Exit) continue;
+        if (!found || event.targetIndex < outTargetIndex) {
+            outTargetIndex = event.targetIndex;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void TriggerSystem::addSphere(TriggerState& triggers, TriggerType type, int targetIndex,
+                              const glm::vec3& center, float radius, bool inclusive) {
+    triggers.volumes.push_back({type, targetIndex, TriggerVolume::Shape::Sphere, center, glm::vec3(0.0f), radius, inclusive});
+}
+
+void TriggerSystem::addBox(TriggerState& triggers, TriggerType type, int targetIndex,
+                           const glm::vec3& center, const glm::vec3& halfExtents, bool inclusive) {
+    triggers.volumes.push_back({type, targetIndex, TriggerVolume::Shape::Box, center, halfExtents, 0.0f, inclusive});
+}
+
+bool TriggerSystem::contains(const TriggerVolume& volume, const glm::vec3& point) {
+    glm::vec3 offset = point - volume.center;
+    if (volume.shape == TriggerVolume::Shape::Sphere) {
+        // 平方根を避けて距離の2乗で比較する
+        float distanceSquared = glm::dot(offset, offset);
+        float radiusSquared = volume.radius * volume.radius;
+        return volume.inclusive ? distanceSquared <= radiusSquared : distanceSquared < radiusSquared;
+    }
+
+    glm::vec3 distance = glm::abs(offset);
+    if (volume.inclusive) {
+        return distance.x <= volume.halfExtents.x && distance.y <= volume.halfExtents.y && distance.z <= volume.halfExtents.z;
+    }
+    return distance.x < volume.halfExtents.x && distance.y < volume.halfExtents.y && distance.z < volume.halfExtents.z;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file trigger_system.h
+ * @brief トリガーシステム
+ * @details アイテム、重力ゾーン、スイッチ、大砲、ステージ選択エリアの接触判定をまとめて行います。
+ */
+#pragma once
+
+#include "game_state.h"
+
+/**
+ * @brief トリガーシステム
+ * @details 全てのトリガーボリュームを1つの空間インデックスに登録し、1ステップにつき
+ * プレイヤー位置で1回だけ問い合わせて、Enter/Stay/Exitイベントを生成します。
+ * 各システムは全要素を走査する代わりに、TriggerState::eventsのうち自分の種類のものだけを処理します。
+ */
+class TriggerSystem {
+public:
+    /**
+     * @brief トリガーボリュームを登録し直す
+     * @details アイテム、重力ゾーン、スイッチ、大砲（とステージ選択フィールドの場合は選択エリア）から
+     * ボリュームを作り、空間インデックスを構築します。ステージ読み込みの完了時に呼び出します。
+     * 接触状態はリセットされます。
+     *
+     * @param gameState ゲーム状態
+     * @param includeStageSelection ステージ選択エリアとランキングボードを登録する場合true
+     */
+    static void rebuild(GameState& gameState, bool includeStageSelection);
+
+    /**
+     * @brief プレイヤー位置で接触判定を行う
+     * @details 前回の結果と比較してTriggerState::eventsを作り直します。
+     *
+     * @param gameState ゲーム状態
+     * @param playerPosition プレイヤー位置
+     */
+    static void update(GameState& gameState, const glm::vec3& playerPosition);
+
+    /**
+     * @brief 内側にいる指定種類のトリガーのうち最小のtargetIndexを取得する
+     * @details 直前のupdateの結果（EnterまたはStay）から探します。
+     *
+     * @param gameState ゲーム状態
+     * @param type トリガーの種類
+     * @param outTargetIndex 出力: targetIndex
+     * @return 見つかった場合true
+     */
+    static bool findInside(const GameState& gameState, TriggerType type, int& outTargetIndex);
+
+private:
+    static void addSphere(TriggerState& triggers, TriggerType type, int targetIndex,
+                          const glm::vec3& center, float radius, bool inclusive);
+    static void addBox(TriggerState& triggers, TriggerType type, int targetIndex,
+                       const glm::vec3& center, const glm::vec3& halfExtents, bool inclusive);
+    static bool contains(const TriggerVolume& volume, const glm::vec3& point);
+};
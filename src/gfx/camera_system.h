@@ -54,8 +54,27 @@ public:
      */
     static CameraConfig calculateCameraConfig(const GameState& gameState, 
                                             const StageManager& stageManager, 
-                                            GLFWwindow* /* window */, 
+                                            GLFWwindow* window, 
                                             float deltaTime) {
+        return calculateCameraConfig(gameState, stageManager, window, deltaTime, gameState.player.position);
+    }
+    
+    /**
+     * @brief 指定したプレイヤー位置でカメラ設定を計算する
+     * @details 固定タイムステップ時に、補間したプレイヤー位置へカメラを追従させるために使用します。
+     * 
+     * @param gameState ゲーム状態
+     * @param stageManager ステージマネージャー
+     * @param window GLFWウィンドウ
+     * @param deltaTime デルタタイム（スムージング用）
+     * @param playerPosition カメラが追従するプレイヤー位置
+     * @return CameraConfig 計算されたカメラ設定
+     */
+    static CameraConfig calculateCameraConfig(const GameState& gameState, 
+                                            const StageManager& stageManager, 
+                                            GLFWwindow* /* window */, 
+                                            float deltaTime,
+                                            const glm::vec3& playerPosition) {
         CameraConfig config;
         config.fov = GameConstants::CAMERA_FOV;
         config.nearPlane = GameConstants::CAMERA_NEAR;
@@ -73,15 +92,15 @@ public:
             float distance = (stageManager.getCurrentStage() == 0) ? 15.0f : 8.0f;
             
             // プレイヤーを中心とした球面座標でカメラ位置を計算
-            targetPosition.x = gameState.player.position.x + distance * cos(yaw) * cos(pitch);
-            targetPosition.y = gameState.player.position.y + distance * sin(pitch);
-            targetPosition.z = gameState.player.position.z + distance * sin(yaw) * cos(pitch);
+            targetPosition.x = playerPosition.x + distance * cos(yaw) * cos(pitch);
+            targetPosition.y = playerPosition.y + distance * sin(pitch);
+            targetPosition.z = playerPosition.z + distance * sin(yaw) * cos(pitch);
             
             // カメラは常にプレイヤーを見る
-            targetTarget = gameState.player.position;
+            targetTarget = playerPosition;
         } else if (gameState.camera.isFirstPersonView) {
             // 1人称視点：プレイヤーの目の位置
-            targetPosition = gameState.player.position + glm::vec3(0, 2.0f, 0); // 目の高さ
+            targetPosition = playerPosition + glm::vec3(0, 2.0f, 0); // 目の高さ
             
             // マウス入力でカメラの向きを制御
             float yaw = glm::radians(gameState.camera.yaw);
@@ -98,12 +117,12 @@ public:
             // 3人称視点
             if (stageManager.getCurrentStage() == 0) {
                 // ステージ選択フィールドでは上からのアングル
-                targetPosition = gameState.player.position + GameConstants::STAGE_SELECT_CAMERA_OFFSET;
+                targetPosition = playerPosition + GameConstants::STAGE_SELECT_CAMERA_OFFSET;
             } else {
                 // 通常のステージでは従来のアングル
-                targetPosition = gameState.player.position + GameConstants::NORMAL_STAGE_CAMERA_OFFSET;
+                targetPosition = playerPosition + GameConstants::NORMAL_STAGE_CAMERA_OFFSET;
             }
-            targetTarget = gameState.player.position;
+            targetTarget = playerPosition;
         }
         
         // カメラスムージング（画面揺れ防止）
@@ -406,6 +406,69 @@ void Renderer3D::renderXMark3D(const glm::vec3& position, const glm::vec3& color
     glEnd();
 }
 
+void Renderer3D::renderCubeBatch(const float* positionX, const float* positionY, const float* positionZ,
+                                 const glm::vec3* colors, size_t count, float size, float alpha) {
+    if (count == 0) {
+        return;
+    }
+    
+    // 単位キューブの面（4頂点ずつ）と面ごとの明るさ
+    static const float faceVertices[6][4][3] = {
+        {{-1, -1,  1}, { 1, -1,  1}, { 1,  1,  1}, {-1,  1,  1}},
+        {{-1, -1, -1}, {-1,  1, -1}, { 1,  1, -1}, { 1, -1, -1}},
+        {{-1,  1, -1}, {-1,  1,  1}, { 1,  1,  1}, { 1,  1, -1}},
+        {{-1, -1, -1}, { 1, -1, -1}, { 1, -1,  1}, {-1, -1,  1}},
+        {{ 1, -1, -1}, { 1,  1, -1}, { 1,  1,  1}, { 1, -1,  1}},
+        {{-1, -1, -1}, {-1, -1,  1}, {-1,  1,  1}, {-1,  1, -1}}
+    };
+    static const float faceShades[6] = {
+        1.0f,
+        1.0f,
+        GameConstants::RenderConstants::LIGHTING_BRIGHTNESS_MULTIPLIER,
+        GameConstants::RenderConstants::LIGHTING_DARKNESS_MULTIPLIER,
+        GameConstants::RenderConstants::LIGHTING_MEDIUM_MULTIPLIER,
+        GameConstants::RenderConstants::LIGHTING_MEDIUM_MULTIPLIER
+    };
+    
+    const size_t vertexCount = count * 24;
+    batchVertices.resize(vertexCount * 3);
+    batchColors.resize(vertexCount * 4);
+    
+    const float halfSize = size * GameConstants::RenderConstants::CUBE_HALF_SIZE;
+    float* vertex = batchVertices.data();
+    float* color = batchColors.data();
+    for (size_t i = 0; i < count; i++) {
+        for (int face = 0; face < 6; face++) {
+            glm::vec3 shadedColor = glm::min(colors[i] * faceShades[face], glm::vec3(1.0f));
+            for (int corner = 0; corner < 4; corner++) {
+                *vertex++ = positionX[i] + faceVertices[face][corner][0] * halfSize;
+                *vertex++ = positionY[i] + faceVertices[face][corner][1] * halfSize;
+                *vertex++ = positionZ[i] + faceVertices[face][corner][2] * halfSize;
+                *color++ = shadedColor.r;
+                *color++ = shadedColor.g;
+                *color++ = shadedColor.b;
+                *color++ = alpha;
+            }
+        }
+    }
+    
+    // 半透明なので奥のキューブを隠さないよう深度は書き込まない
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, batchVertices.data());
+    glColorPointer(4, GL_FLOAT, 0, batchColors.data());
+    glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(vertexCount));
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
 void Renderer3D::drawTexturedCube(const glm::mat4& model, GLuint textureID, float alpha) {
     glPushMatrix();
     glMultMatrixf(glm::value_ptr(model));
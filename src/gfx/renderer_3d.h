@@ -7,6 +7,7 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 
 typedef unsigned int GLuint;
 
@@ -131,11 +132,30 @@ public:
      * @param scale スケール
      */
     void renderXMark3D(const glm::vec3& position, const glm::vec3& color, float scale);
+    
+    /**
+     * @brief 同じ大きさの半透明キューブをまとめて描画する
+     * @details 全キューブの頂点を1つの頂点配列にまとめ、1回の描画呼び出しで描画します。
+     * ゴーストのように多数のキューブを毎フレーム描画する場合に使います。
+     * 位置はSoA（X・Y・Zの別々の配列）で渡します。
+     * @param positionX 位置Xの配列
+     * @param positionY 位置Yの配列
+     * @param positionZ 位置Zの配列
+     * @param colors 色の配列
+     * @param count キューブの数
+     * @param size サイズ
+     * @param alpha アルファ値（ブレンドする）
+     */
+    void renderCubeBatch(const float* positionX, const float* positionY, const float* positionZ,
+                         const glm::vec3* colors, size_t count, float size, float alpha);
 
 private:
     void drawCube(const glm::mat4& model, const glm::vec3& color);
     void drawTexturedCube(const glm::mat4& model, GLuint textureID, float alpha = 1.0f);
     void drawTexturedCubeWithFrontFace(const glm::mat4& model, GLuint frontTextureID, GLuint otherTextureID);
+    
+    std::vector<float> batchVertices;  // renderCubeBatchの頂点配列（フレーム間で使い回す）
+    std::vector<float> batchColors;
 };
 
 } // namespace gfx
@@ -3,17 +3,20 @@
 #endif
 
 #include "input_system.h"
-#include "../physics/physics_system.h"
 #include "../core/constants/game_constants.h"
 #include "audio_manager.h"
 #include "../game/stage_editor.h"
-#include <variant>
+#include "../game/simulation_system.h"
+#include "../game/input_replay_system.h"
 #include <algorithm>
 
 static bool gamepadConnected = false;
 static int gamepadId = GameConstants::InputConstants::DEFAULT_GAMEPAD_ID;
 static bool gamepadButtons[GameConstants::InputConstants::MAX_GAMEPAD_BUTTONS] = {false}; // ボタンの状態を保存
 static bool gamepadButtonsLast[GameConstants::InputConstants::MAX_GAMEPAD_BUTTONS] = {false}; // 前フレームのボタン状態
+static bool spacePressed = false;         // 前回のジャンプ判定時のスペースキーの状態
+static bool gamepadJumpPressed = false;   // 前回のジャンプ判定時のジャンプボタンの状態
+static bool jumpLatched = false;          // latchJumpInput()で検出した、まだ処理していないジャンプ
 
 void InputSystem::mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     GameState* gameState = static_cast<GameState*>(glfwGetWindowUserPointer(window));
@@ -65,12 +68,7 @@ void InputSystem::scroll_callback(GLFWwindow* window, double xoffset, double yof
                                        std::min(GameConstants::InputConstants::MAX_CAMERA_DISTANCE, gameState->camera.distance));
 }
 
-void InputSystem::processInput(GLFWwindow* window, GameState& gameState, float deltaTime) {
-    float moveSpeed = GameConstants::InputConstants::MOVE_SPEED;
-    
-    glm::vec3 gravityDirection = glm::vec3(0, -1, 0); // デフォルトは下向き
-    PhysicsSystem::isPlayerInGravityZone(gameState, gameState.player.position, gravityDirection);
-    
+void InputSystem::processInput(GLFWwindow* window, GameState& gameState, PlatformSystem& platformSystem, float deltaTime) {
     glm::vec3 moveDir(0.0f);
     
     gameState.player.isMovingBackward = false;
@@ -167,151 +165,62 @@ void InputSystem::processInput(GLFWwindow* window, GameState& gameState, float d
         }
     }
 
-    if (glm::length(moveDir) > 0.0f) {
-        moveDir = glm::normalize(moveDir);
-        
-        float moveDistance = moveSpeed * deltaTime;
-        
-        if (gameState.skills.isInBurstJumpAir) {
-            moveDistance *= 2.0f;
-
-        }
-        
-        glm::vec3 newPosition = gameState.player.position;
-        newPosition.x += moveDir.x * moveDistance;
-        newPosition.z += moveDir.z * moveDistance;
-        
-        glm::vec3 playerSize = glm::vec3(1.0f, 1.0f, 1.0f);
-        if (!PhysicsSystem::checkPlatformCollisionHorizontal(gameState, newPosition, playerSize)) {
-            gameState.player.position = newPosition;
-        }
-    }
+    // 移動方向は量子化してから適用し、入力リプレイの再シミュレーションと同じ結果にする
+    TickInput moveInput;
+    InputReplaySystem::setMoveDirection(moveInput, moveDir);
+    gameState.replay.tickInput.moveX = moveInput.moveX;
+    gameState.replay.tickInput.moveZ = moveInput.moveZ;
+    SimulationSystem::applyInput(gameState, platformSystem, moveInput, glm::vec3(0, -1, 0), deltaTime, SimulationEvents());
 }
 
 void InputSystem::processJumpAndFloat(GLFWwindow* window, GameState& gameState, float deltaTime, const glm::vec3& gravityDirection, PlatformSystem& platformSystem, io::AudioManager& audioManager) {
     if (gameState.progress.isGoalReached) {
+        jumpLatched = false;
         return; // ゴール後はジャンプ入力を無視
     }
     
     if (gameState.progress.isGameOver) {
+        jumpLatched = false;
         return; // ゲームオーバー時はジャンプ入力を無視
     }
     
-    static bool spacePressed = false;
-    static bool gamepadJumpPressed = false;
-    
     bool spaceCurrentlyPressed = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
     bool gamepadJumpCurrentlyPressed = isGamepadButtonPressed(0); // Aボタン（通常は0番）
     
-    bool shouldJump = (spaceCurrentlyPressed && !spacePressed) || 
+    bool shouldJump = jumpLatched ||
+                     (spaceCurrentlyPressed && !spacePressed) || 
                      (gamepadJumpCurrentlyPressed && !gamepadJumpPressed);
+    jumpLatched = false;
 
     if (shouldJump) {
-        glm::vec3 playerSize = glm::vec3(1.0f, 1.0f, 1.0f);
-        bool onPlatform = false;
-        
-        const auto& platforms = platformSystem.getPlatforms();
-        
-        for (const auto& platform : platforms) {
-            std::visit([&](const auto& p) {
-                if (p.size.x <= 0 || p.size.y <= 0 || p.size.z <= 0) return;
-                
-                if (gravityDirection.y > 0.5f) {
-                    glm::vec3 platformMin = p.position - p.size * 0.5f;
-                    glm::vec3 platformMax = p.position + p.size * 0.5f;
-                    glm::vec3 playerMin = gameState.player.position - playerSize * 0.5f;
-                    glm::vec3 playerMax = gameState.player.position + playerSize * 0.5f;
-                    
-                    bool horizontalOverlap = (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
-                                             playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
-                    
-                    if (horizontalOverlap && std::abs(playerMax.y - platformMin.y) < 0.5f) {
-                        onPlatform = true;
-                    }
-                } else {
-                    glm::vec3 platformMin = p.position - p.size * 0.5f;
-                    glm::vec3 platformMax = p.position + p.size * 0.5f;
-                    glm::vec3 playerMin = gameState.player.position - playerSize * 0.5f;
-                    glm::vec3 playerMax = gameState.player.position + playerSize * 0.5f;
-                    
-                    bool horizontalOverlap = (playerMax.x >= platformMin.x && playerMin.x <= platformMax.x &&
-                                             playerMax.z >= platformMin.z && playerMin.z <= platformMax.z);
-                    
-                    if (horizontalOverlap && std::abs(playerMin.y - platformMax.y) < 0.5f) {
-                        onPlatform = true;
-                    }
-                }
-            }, platform);
-            
-            if (onPlatform) break;
-        }
+        TickInput jumpInput;
+        jumpInput.buttons = TickInput::BUTTON_JUMP;
+        gameState.replay.tickInput.buttons |= TickInput::BUTTON_JUMP;
         
-        if (onPlatform) {
+        SimulationEvents events;
+        events.onPlaySFX = [&](const std::string& sfxName) {
             if (gameState.audioEnabled) {
-                audioManager.playSFX("jump");
+                audioManager.playSFX(sfxName);
             }
-            
-            if (gameState.skills.isBurstJumpActive && !gameState.skills.hasUsedBurstJump) {
-                if (gravityDirection.y > 0.5f) {
-                    gameState.player.velocity.y = -20.0f; // 重力反転時は下向きにバーストジャンプ
-                } else {
-                    gameState.player.velocity.y = 20.0f; // 通常時は上向きにバーストジャンプ
-                }
-                gameState.skills.hasUsedBurstJump = true;
-                gameState.skills.isBurstJumpActive = false; // バーストジャンプを使用したので非アクティブに
-                gameState.skills.burstJumpDelayTimer = 0.01f; // 1秒後に空中フラグを設定
-            } else {
-                if (gravityDirection.y > 0.5f) {
-                    gameState.player.velocity.y = -8.0f; // 重力反転時は下向きにジャンプ
-                } else {
-                    gameState.player.velocity.y = 8.0f; // 通常時は上向きにジャンプ
-                }
-            }
-            gameState.player.canDoubleJump = true;
-            if (gameState.skills.isInBurstJumpAir) {
-                gameState.skills.isInBurstJumpAir = false; // バーストジャンプ空中フラグをリセット
-            }
-        } else if ((gameState.progress.selectedSecretStarType == GameProgressState::SecretStarType::NONE) && 
-                   !gameState.progress.isTimeAttackMode &&
-                   ((gameState.progress.isEasyMode && gameState.player.canDoubleJump) || 
-                   (!gameState.progress.isEasyMode && gameState.skills.hasDoubleJumpSkill && gameState.skills.doubleJumpRemainingUses > 0 && gameState.player.canDoubleJump))) {
-            if (gameState.progress.currentStage != 0) {
-                if (gameState.audioEnabled) {
-                    audioManager.playSFX("jump");
-                }
-                
-                if (gravityDirection.y > 0.5f) {
-                    gameState.player.velocity.y = -6.0f; // 重力反転時は下向きにジャンプ
-                } else {
-                    gameState.player.velocity.y = 6.0f; // 通常時は上向きにジャンプ
-                }
-                gameState.player.canDoubleJump = false; // 二段ジャンプを使用
-                
-                if (!gameState.progress.isEasyMode) {
-                    gameState.skills.doubleJumpRemainingUses--;
-                }
-            }
-        } else if ((gameState.progress.selectedSecretStarType == GameProgressState::SecretStarType::NONE) && 
-                   !gameState.progress.isTimeAttackMode &&
-                   gameState.skills.isBurstJumpActive && !gameState.skills.hasUsedBurstJump && !gameState.skills.isInBurstJumpAir) {
-            if (gameState.audioEnabled) {
-                audioManager.playSFX("jump");
-            }
-            
-            if (gravityDirection.y > 0.5f) {
-                gameState.player.velocity.y = -20.0f; // 重力反転時は下向きにバーストジャンプ
-            } else {
-                gameState.player.velocity.y = 20.0f; // 通常時は上向きにバーストジャンプ
-            }
-            gameState.skills.hasUsedBurstJump = true;
-            gameState.skills.isBurstJumpActive = false; // バーストジャンプを使用したので非アクティブに
-            gameState.skills.isInBurstJumpAir = true; // バーストジャンプ空中フラグを設定
-        }
+        };
+        SimulationSystem::applyInput(gameState, platformSystem, jumpInput, gravityDirection, deltaTime, events);
     }
     spacePressed = spaceCurrentlyPressed;
     gamepadJumpPressed = gamepadJumpCurrentlyPressed;
 }
 
+void InputSystem::latchJumpInput(GLFWwindow* window) {
+    bool spaceCurrentlyPressed = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+    bool gamepadJumpCurrentlyPressed = isGamepadButtonPressed(0);
+    if ((spaceCurrentlyPressed && !spacePressed) || (gamepadJumpCurrentlyPressed && !gamepadJumpPressed)) {
+        jumpLatched = true;
+    }
+}
+
+void InputSystem::clearLatchedJump() {
+    jumpLatched = false;
+}
+
 void InputSystem::initializeGamepad() {
     if (glfwJoystickPresent(gamepadId)) {
         gamepadConnected = true;
@@ -41,17 +41,19 @@ public:
     
     /**
      * @brief 入力処理
-     * @details キーボード入力の処理を実行します。
+     * @details キーボード・ゲームパッドの移動入力をカメラの向きに応じたワールド座標系の方向にし、
+     * SimulationSystem::applyInput()で適用します。適用した入力はReplayState::tickInputにも記録します。
      * 
      * @param window GLFWウィンドウ
      * @param gameState ゲーム状態
+     * @param platformSystem プラットフォームシステム
      * @param deltaTime デルタタイム
      */
-    static void processInput(GLFWwindow* window, GameState& gameState, float deltaTime);
+    static void processInput(GLFWwindow* window, GameState& gameState, PlatformSystem& platformSystem, float deltaTime);
     
     /**
      * @brief ジャンプと浮遊の処理
-     * @details ジャンプと浮遊の入力処理を実行します。
+     * @details ジャンプボタンの押し始めを検出し、SimulationSystem::applyInput()でジャンプを適用します。
      * 
      * @param window GLFWウィンドウ
      * @param gameState ゲーム状態
@@ -62,6 +64,22 @@ public:
      */
     static void processJumpAndFloat(GLFWwindow* window, GameState& gameState, float deltaTime, const glm::vec3& gravityDirection, PlatformSystem& platformSystem, io::AudioManager& audioManager);
     
+    /**
+     * @brief ジャンプボタンの押し始めを次のprocessJumpAndFloat()まで保持する
+     * @details 固定ティックでは描画フレームごとに呼び出します。ティックが進まないフレームに押して離した場合も、
+     * 次のティックでジャンプします。
+     * 
+     * @param window GLFWウィンドウ
+     */
+    static void latchJumpInput(GLFWwindow* window);
+    
+    /**
+     * @brief 保持しているジャンプを破棄する
+     * @details 固定ティックでは各ティックの後に呼び出し、processJumpAndFloat()を呼び出さなかったティック（UIの操作中など）の
+     * ジャンプを持ち越さないようにします。
+     */
+    static void clearLatchedJump();
+    
     /**
      * @brief ゲームパッドを初期化する
      * @details ゲームパッドの接続を確認し、初期化します。
@@ -0,0 +1,117 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "aabb_batch.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AABB_BATCH_SSE2
+#endif
+
+void AABBBatch::resize(int newCount) {
+    size_t paddedCount = static_cast<size_t>((newCount + LANE_WIDTH - 1) / LANE_WIDTH) * LANE_WIDTH;
+    minX.resize(paddedCount); minY.resize(paddedCount); minZ.resize(paddedCount);
+    maxX.resize(paddedCount); maxY.resize(paddedCount); maxZ.resize(paddedCount);
+    activeMask.resize(paddedCount);
+
+    // 余りのレーンと縮小で外れた要素は無効にしておく
+    for (size_t i = static_cast<size_t>(std::min(newCount, count)); i < paddedCount; i++) {
+        activeMask[i] = 0;
+    }
+    count = newCount;
+}
+
+void AABBBatch::query(const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<int>& outIndices) const {
+    const int paddedCount = static_cast<int>(activeMask.size());
+
+#if defined(__AVX__)
+    const __m256 qMinX = _mm256_set1_ps(queryMin.x), qMinY = _mm256_set1_ps(queryMin.y), qMinZ = _mm256_set1_ps(queryMin.z);
+    const __m256 qMaxX = _mm256_set1_ps(queryMax.x), qMaxY = _mm256_set1_ps(queryMax.y), qMaxZ = _mm256_set1_ps(queryMax.z);
+    for (int base = 0; base < paddedCount; base += LANE_WIDTH) {
+        __m256 mask = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&activeMask[base])));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(qMaxX, _mm256_loadu_ps(&minX[base]), _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(qMinX, _mm256_loadu_ps(&maxX[base]), _CMP_LE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(qMaxY, _mm256_loadu_ps(&minY[base]), _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(qMinY, _mm256_loadu_ps(&maxY[base]), _CMP_LE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(qMaxZ, _mm256_loadu_ps(&minZ[base]), _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(qMinZ, _mm256_loadu_ps(&maxZ[base]), _CMP_LE_OQ));
+
+        unsigned int bits = static_cast<unsigned int>(_mm256_movemask_ps(mask));
+        for (int lane = 0; bits != 0; lane++, bits >>= 1) {
+            if (bits & 1u) {
+                outIndices.push_back(base + lane);
+            }
+        }
+    }
+#elif defined(AABB_BATCH_SSE2)
+    const __m128 qMinX = _mm_set1_ps(queryMin.x), qMinY = _mm_set1_ps(queryMin.y), qMinZ = _mm_set1_ps(queryMin.z);
+    const __m128 qMaxX = _mm_set1_ps(queryMax.x), qMaxY = _mm_set1_ps(queryMax.y), qMaxZ = _mm_set1_ps(queryMax.z);
+    auto overlapMask4 = [&](int base) {
+        __m128 mask = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&activeMask[base])));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(qMaxX, _mm_loadu_ps(&minX[base])));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(qMinX, _mm_loadu_ps(&maxX[base])));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(qMaxY, _mm_loadu_ps(&minY[base])));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(qMinY, _mm_loadu_ps(&maxY[base])));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(qMaxZ, _mm_loadu_ps(&minZ[base])));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(qMinZ, _mm_loadu_ps(&maxZ[base])));
+        return static_cast<unsigned int>(_mm_movemask_ps(mask));
+    };
+    for (int base = 0; base < paddedCount; base += LANE_WIDTH) {
+        unsigned int bits = overlapMask4(base) | (overlapMask4(base + 4) << 4);
+        for (int lane = 0; bits != 0; lane++, bits >>= 1) {
+            if (bits & 1u) {
+                outIndices.push_back(base + lane);
+            }
+        }
+    }
+#else
+    for (int i = 0; i < paddedCount; i++) {
+        if (overlaps(i, queryMin, queryMax)) {
+            outIndices.push_back(i);
+        }
+    }
+#endif
+}
+
+bool AABBBatch::sweep(int index, const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& displacement, float& outTime) const {
+    if (activeMask[index] == 0) return false;
+
+    const float targetMin[3] = {minX[index], minY[index], minZ[index]};
+    const float targetMax[3] = {maxX[index], maxY[index], maxZ[index]};
+    float enterTime = -std::numeric_limits<float>::infinity();
+    float exitTime = std::numeric_limits<float>::infinity();
+
+    for (int axis = 0; axis < 3; axis++) {
+        float d = displacement[axis];
+        if (d == 0.0f) {
+            // この軸で動かない場合は、開始時点でスラブ内にいなければ接触しない
+            if (boxMax[axis] < targetMin[axis] || boxMin[axis] > targetMax[axis]) return false;
+            continue;
+        }
+
+        float axisEnter = (d > 0.0f) ? (targetMin[axis] - boxMax[axis]) / d : (targetMax[axis] - boxMin[axis]) / d;
+        float axisExit = (d > 0.0f) ? (targetMax[axis] - boxMin[axis]) / d : (targetMin[axis] - boxMax[axis]) / d;
+        enterTime = std::max(enterTime, axisEnter);
+        exitTime = std::min(exitTime, axisExit);
+        if (enterTime > exitTime) return false;
+    }
+
+    if (enterTime < 0.0f || enterTime > 1.0f) return false;
+    outTime = enterTime;
+    return true;
+}
+
+void AABBBatch::filter(const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<int>& indices) const {
+    size_t kept = 0;
+    for (int index : indices) {
+        if (overlaps(index, queryMin, queryMax)) {
+            indices[kept++] = index;
+        }
+    }
+    indices.resize(kept);
+}
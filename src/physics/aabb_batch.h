@@ -0,0 +1,107 @@
+/**
+ * @file aabb_batch.h
+ * @brief AABBバッチ
+ * @details 境界ボックスを構造体配列（SoA）で保持し、SIMDでまとめて重なり判定を行います。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * @brief AABBバッチ
+ * @details 最小・最大座標を軸ごとの配列に、有効フラグをレーンマスク（0または-1）の配列に保持します。
+ * 判定はAVXが有効なビルドでは8要素ずつ、SSE2では4要素×2で8要素ずつ行います（どちらもない場合はスカラー）。
+ * 配列は8の倍数に切り上げて確保し、余りのレーンは無効として扱うため端数処理は不要です。
+ */
+class AABBBatch {
+public:
+    static constexpr int LANE_WIDTH = 8;
+
+    /**
+     * @brief 要素数を変更する
+     * @details 追加された要素は無効状態で初期化されます。
+     * @param count 要素数
+     */
+    void resize(int count);
+
+    /**
+     * @brief 全要素を削除する
+     */
+    void clear() { resize(0); }
+
+    /**
+     * @brief 要素を設定する
+     * @param index 要素のインデックス
+     * @param min AABBの最小座標
+     * @param max AABBの最大座標
+     * @param active 判定対象にする場合true（非表示のプラットフォーム等はfalse）
+     */
+    void set(int index, const glm::vec3& min, const glm::vec3& max, bool active) {
+        minX[index] = min.x; minY[index] = min.y; minZ[index] = min.z;
+        maxX[index] = max.x; maxY[index] = max.y; maxZ[index] = max.z;
+        activeMask[index] = active ? -1 : 0;
+    }
+
+    /**
+     * @brief 1要素と重なるかを判定する
+     * @param index 要素のインデックス
+     * @param queryMin 問い合わせ範囲の最小座標
+     * @param queryMax 問い合わせ範囲の最大座標
+     * @return 有効かつ重なっている場合true
+     */
+    bool overlaps(int index, const glm::vec3& queryMin, const glm::vec3& queryMax) const {
+        return activeMask[index] != 0 &&
+               queryMax.x >= minX[index] && queryMin.x <= maxX[index] &&
+               queryMax.y >= minY[index] && queryMin.y <= maxY[index] &&
+               queryMax.z >= minZ[index] && queryMin.z <= maxZ[index];
+    }
+
+    /**
+     * @brief 移動するAABBが1要素に最初に接触する時刻を求める
+     * @details 移動量をパラメータ t（0〜1）で表し、各軸のスラブに入る時刻と出る時刻から接触時刻を計算します。
+     * 開始時点で既に重なっている要素は対象外です（離散判定で処理するため）。
+     *
+     * @param index 要素のインデックス
+     * @param boxMin 移動開始時のAABBの最小座標
+     * @param boxMax 移動開始時のAABBの最大座標
+     * @param displacement 移動量
+     * @param outTime 出力: 接触時刻（0〜1）
+     * @return 移動中に接触する場合true
+     */
+    bool sweep(int index, const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& displacement, float& outTime) const;
+
+    /**
+     * @brief 全要素から重なる要素を取得する
+     * @param queryMin 問い合わせ範囲の最小座標
+     * @param queryMax 問い合わせ範囲の最大座標
+     * @param outIndices 出力: 重なった要素のインデックス（末尾に昇順で追加）
+     */
+    void query(const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<int>& outIndices) const;
+
+    /**
+     * @brief 候補のうち重ならないものを取り除く
+     * @details ブロードフェーズで得た候補を正確な境界ボックスで絞り込みます。候補の順序は保たれます。
+     * @param queryMin 問い合わせ範囲の最小座標
+     * @param queryMax 問い合わせ範囲の最大座標
+     * @param indices 入出力: 候補のインデックス
+     */
+    void filter(const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<int>& indices) const;
+
+    /**
+     * @brief 要素数を取得する
+     * @return 要素数
+     */
+    int size() const { return count; }
+
+private:
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    std::vector<int32_t> activeMask;
+    int count = 0;
+};
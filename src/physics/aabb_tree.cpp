@@ -0,0 +1,336 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "aabb_tree.h"
+#include <algorithm>
+
+namespace {
+    bool overlaps(const glm::vec3& minA, const glm::vec3& maxA, const glm::vec3& minB, const glm::vec3& maxB) {
+        return maxA.x >= minB.x && minA.x <= maxB.x &&
+               maxA.y >= minB.y && minA.y <= maxB.y &&
+               maxA.z >= minB.z && minA.z <= maxB.z;
+    }
+
+    bool contains(const glm::vec3& outerMin, const glm::vec3& outerMax, const glm::vec3& innerMin, const glm::vec3& innerMax) {
+        return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z &&
+               innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+    }
+}
+
+int AABBTree::createProxy(const glm::vec3& min, const glm::vec3& max, int userData, float margin) {
+    int proxyId = allocateNode();
+    nodes[proxyId].min = min - glm::vec3(margin);
+    nodes[proxyId].max = max + glm::vec3(margin);
+    nodes[proxyId].userData = userData;
+    nodes[proxyId].height = 0;
+    insertLeaf(proxyId);
+    proxyCount++;
+    return proxyId;
+}
+
+void AABBTree::destroyProxy(int proxyId) {
+    removeLeaf(proxyId);
+    freeNode(proxyId);
+    proxyCount--;
+}
+
+bool AABBTree::moveProxy(int proxyId, const glm::vec3& min, const glm::vec3& max, float margin) {
+    if (contains(nodes[proxyId].min, nodes[proxyId].max, min, max)) {
+        return false;
+    }
+
+    removeLeaf(proxyId);
+    nodes[proxyId].min = min - glm::vec3(margin);
+    nodes[proxyId].max = max + glm::vec3(margin);
+    insertLeaf(proxyId);
+    return true;
+}
+
+void AABBTree::build(std::vector<BuildEntry>& entries) {
+    clear();
+    if (entries.empty()) return;
+
+    nodes.reserve(entries.size() * 2 - 1);
+    root = buildRange(entries, 0, static_cast<int>(entries.size()));
+    nodes[root].parent = NULL_NODE;
+    proxyCount = static_cast<int>(entries.size());
+}
+
+void AABBTree::clear() {
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+    proxyCount = 0;
+}
+
+void AABBTree::query(const glm::vec3& min, const glm::vec3& max, std::vector<int>& outUserData) {
+    if (root == NULL_NODE) return;
+
+    queryStack.clear();
+    queryStack.push_back(root);
+    while (!queryStack.empty()) {
+        int nodeId = queryStack.back();
+        queryStack.pop_back();
+
+        const Node& node = nodes[nodeId];
+        if (!overlaps(node.min, node.max, min, max)) continue;
+
+        if (node.isLeaf()) {
+            outUserData.push_back(node.userData);
+        } else {
+            queryStack.push_back(node.child1);
+            queryStack.push_back(node.child2);
+        }
+    }
+}
+
+int AABBTree::allocateNode() {
+    if (freeList == NULL_NODE) {
+        nodes.emplace_back();
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    int nodeId = freeList;
+    freeList = nodes[nodeId].parent;
+    nodes[nodeId] = Node();
+    return nodeId;
+}
+
+void AABBTree::freeNode(int nodeId) {
+    nodes[nodeId].parent = freeList;
+    nodes[nodeId].height = -1;
+    freeList = nodeId;
+}
+
+void AABBTree::insertLeaf(int leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // 表面積の増加が最小になる兄弟ノードを探す
+    glm::vec3 leafMin = nodes[leaf].min;
+    glm::vec3 leafMax = nodes[leaf].max;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = surfaceArea(nodes[index].min, nodes[index].max);
+        float combinedArea = surfaceArea(glm::min(nodes[index].min, leafMin), glm::max(nodes[index].max, leafMax));
+
+        // このノードと新しい葉で親を作る場合のコスト
+        float cost = 2.0f * combinedArea;
+        // さらに下に降りる場合に祖先が広がる分のコスト
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child) {
+            float childArea = surfaceArea(glm::min(nodes[child].min, leafMin), glm::max(nodes[child].max, leafMax));
+            if (nodes[child].isLeaf()) {
+                return childArea + inheritanceCost;
+            }
+            return childArea - surfaceArea(nodes[child].min, nodes[child].max) + inheritanceCost;
+        };
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = (cost1 < cost2) ? child1 : child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].min = glm::min(nodes[sibling].min, leafMin);
+    nodes[newParent].max = glm::max(nodes[sibling].max, leafMax);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE) {
+        if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        } else {
+            nodes[oldParent].child2 = newParent;
+        }
+    } else {
+        root = newParent;
+    }
+
+    // 祖先のAABBと高さを更新しながら平衡化する
+    index = nodes[leaf].parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+        refit(index);
+        index = nodes[index].parent;
+    }
+}
+
+void AABBTree::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NULL_NODE) {
+        if (nodes[grandParent].child1 == parent) {
+            nodes[grandParent].child1 = sibling;
+        } else {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != NULL_NODE) {
+            index = balance(index);
+            refit(index);
+            index = nodes[index].parent;
+        }
+    } else {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+}
+
+int AABBTree::balance(int iA) {
+    if (nodes[iA].isLeaf() || nodes[iA].height < 2) {
+        return iA;
+    }
+
+    int iB = nodes[iA].child1;
+    int iC = nodes[iA].child2;
+    int heightDiff = nodes[iC].height - nodes[iB].height;
+
+    // 右が高い場合はCを持ち上げる
+    if (heightDiff > 1) {
+        int iF = nodes[iC].child1;
+        int iG = nodes[iC].child2;
+
+        nodes[iC].child1 = iA;
+        nodes[iC].parent = nodes[iA].parent;
+        nodes[iA].parent = iC;
+
+        if (nodes[iC].parent != NULL_NODE) {
+            if (nodes[nodes[iC].parent].child1 == iA) {
+                nodes[nodes[iC].parent].child1 = iC;
+            } else {
+                nodes[nodes[iC].parent].child2 = iC;
+            }
+        } else {
+            root = iC;
+        }
+
+        if (nodes[iF].height > nodes[iG].height) {
+            nodes[iC].child2 = iF;
+            nodes[iA].child2 = iG;
+            nodes[iG].parent = iA;
+        } else {
+            nodes[iC].child2 = iG;
+            nodes[iA].child2 = iF;
+            nodes[iF].parent = iA;
+        }
+        refit(iA);
+        refit(iC);
+        return iC;
+    }
+
+    // 左が高い場合はBを持ち上げる
+    if (heightDiff < -1) {
+        int iD = nodes[iB].child1;
+        int iE = nodes[iB].child2;
+
+        nodes[iB].child1 = iA;
+        nodes[iB].parent = nodes[iA].parent;
+        nodes[iA].parent = iB;
+
+        if (nodes[iB].parent != NULL_NODE) {
+            if (nodes[nodes[iB].parent].child1 == iA) {
+                nodes[nodes[iB].parent].child1 = iB;
+            } else {
+                nodes[nodes[iB].parent].child2 = iB;
+            }
+        } else {
+            root = iB;
+        }
+
+        if (nodes[iD].height > nodes[iE].height) {
+            nodes[iB].child2 = iD;
+            nodes[iA].child1 = iE;
+            nodes[iE].parent = iA;
+        } else {
+            nodes[iB].child2 = iE;
+            nodes[iA].child1 = iD;
+            nodes[iD].parent = iA;
+        }
+        refit(iA);
+        refit(iB);
+        return iB;
+    }
+
+    return iA;
+}
+
+void AABBTree::refit(int nodeId) {
+    Node& node = nodes[nodeId];
+    const Node& child1 = nodes[node.child1];
+    const Node& child2 = nodes[node.child2];
+    node.min = glm::min(child1.min, child2.min);
+    node.max = glm::max(child1.max, child2.max);
+    node.height = 1 + std::max(child1.height, child2.height);
+}
+
+int AABBTree::buildRange(std::vector<BuildEntry>& entries, int begin, int end) {
+    if (end - begin == 1) {
+        int leaf = allocateNode();
+        nodes[leaf].min = entries[begin].min;
+        nodes[leaf].max = entries[begin].max;
+        nodes[leaf].userData = entries[begin].userData;
+        nodes[leaf].height = 0;
+        return leaf;
+    }
+
+    // 中心点の広がりが最大の軸で中央値分割する
+    glm::vec3 centerMin = (entries[begin].min + entries[begin].max) * 0.5f;
+    glm::vec3 centerMax = centerMin;
+    for (int i = begin + 1; i < end; i++) {
+        glm::vec3 center = (entries[i].min + entries[i].max) * 0.5f;
+        centerMin = glm::min(centerMin, center);
+        centerMax = glm::max(centerMax, center);
+    }
+    glm::vec3 extent = centerMax - centerMin;
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    int mid = begin + (end - begin) / 2;
+    std::nth_element(entries.begin() + begin, entries.begin() + mid, entries.begin() + end,
+                     [axis](const BuildEntry& a, const BuildEntry& b) {
+                         return (a.min[axis] + a.max[axis]) < (b.min[axis] + b.max[axis]);
+                     });
+
+    int child1 = buildRange(entries, begin, mid);
+    int child2 = buildRange(entries, mid, end);
+    int nodeId = allocateNode();
+    nodes[nodeId].child1 = child1;
+    nodes[nodeId].child2 = child2;
+    nodes[child1].parent = nodeId;
+    nodes[child2].parent = nodeId;
+    refit(nodeId);
+    return nodeId;
+}
+
+float AABBTree::surfaceArea(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file aabb_tree.h
+ * @brief AABBツリー
+ * @details 軸平行境界ボックス（AABB）の階層構造によるブロードフェーズを提供します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * @brief AABBツリー
+ * @details 葉ノードにAABBとユーザーデータ（プラットフォームインデックス等）を持つ二分木です。
+ *
+ * 次の2通りの使い方を想定しています：
+ * - 静的ツリー: build()で全要素から一括構築する（以降は変更しない）
+ * - 動的ツリー: createProxy()/moveProxy()で逐次更新する。葉のAABBはマージン分だけ太らせて登録し、
+ *   実際のAABBが太らせたAABBからはみ出した場合のみ再挿入する
+ *
+ * 挿入時は表面積が最小になる兄弟ノードを選び、回転により木の高さを平衡に保ちます。
+ */
+class AABBTree {
+public:
+    static constexpr int NULL_NODE = -1;
+
+    /**
+     * @brief 一括構築用の要素
+     */
+    struct BuildEntry {
+        glm::vec3 min;
+        glm::vec3 max;
+        int userData;
+    };
+
+    /**
+     * @brief 要素を追加する
+     * @param min AABBの最小座標
+     * @param max AABBの最大座標
+     * @param userData ユーザーデータ
+     * @param margin AABBを太らせる量（動的ツリー用）
+     * @return プロキシID（moveProxy/destroyProxyで使用）
+     */
+    int createProxy(const glm::vec3& min, const glm::vec3& max, int userData, float margin = 0.0f);
+
+    /**
+     * @brief 要素を削除する
+     * @param proxyId createProxyで取得したプロキシID
+     */
+    void destroyProxy(int proxyId);
+
+    /**
+     * @brief 要素のAABBを更新する
+     * @details 新しいAABBが登録済みの太らせたAABBに収まっている場合は何もしません。
+     *
+     * @param proxyId プロキシID
+     * @param min 新しいAABBの最小座標
+     * @param max 新しいAABBの最大座標
+     * @param margin 再挿入時にAABBを太らせる量
+     * @return 再挿入した場合true
+     */
+    bool moveProxy(int proxyId, const glm::vec3& min, const glm::vec3& max, float margin);
+
+    /**
+     * @brief 全要素から木を一括構築する
+     * @details 既存の要素は破棄されます。最も長い軸の中央値で再帰的に分割します。
+     *
+     * @param entries 要素（構築中に並べ替えられます）
+     */
+    void build(std::vector<BuildEntry>& entries);
+
+    /**
+     * @brief 全要素を削除する
+     */
+    void clear();
+
+    /**
+     * @brief AABBと重なる要素を取得する
+     * @param min 問い合わせ範囲の最小座標
+     * @param max 問い合わせ範囲の最大座標
+     * @param outUserData 出力: 重なった要素のユーザーデータ（末尾に追加、順不同）
+     */
+    void query(const glm::vec3& min, const glm::vec3& max, std::vector<int>& outUserData);
+
+    /**
+     * @brief 要素数を取得する
+     * @return 要素数
+     */
+    int getProxyCount() const { return proxyCount; }
+
+    /**
+     * @brief 木の高さを取得する
+     * @return 木の高さ（空の場合は0）
+     */
+    int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+private:
+    struct Node {
+        glm::vec3 min = glm::vec3(0.0f);
+        glm::vec3 max = glm::vec3(0.0f);
+        int parent = NULL_NODE;  // 未使用ノードの場合は次の未使用ノード
+        int child1 = NULL_NODE;
+        int child2 = NULL_NODE;
+        int height = -1;         // 葉は0、未使用ノードは-1
+        int userData = -1;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    int allocateNode();
+    void freeNode(int nodeId);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int nodeId);
+    void refit(int nodeId);
+    int buildRange(std::vector<BuildEntry>& entries, int begin, int end);
+
+    static float surfaceArea(const glm::vec3& min, const glm::vec3& max);
+
+    std::vector<Node> nodes;
+    std::vector<int> queryStack;
+    int root = NULL_NODE;
+    int freeList = NULL_NODE;
+    int proxyCount = 0;
+};
@@ -0,0 +1,104 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "oriented_box.h"
+#include <cmath>
+
+OrientedBox OrientedBox::fromRotation(const glm::vec3& center, const glm::vec3& size,
+                                      const glm::vec3& rotationAxis, float rotationAngleDegrees) {
+    OrientedBox box;
+    box.center = center;
+    box.halfExtents = size * 0.5f;
+
+    float axisLength = glm::length(rotationAxis);
+    if (axisLength > 0.0f) {
+        // ロドリゲスの回転公式: R = cI + s[k]x + (1 - c)kk^T
+        glm::vec3 k = rotationAxis / axisLength;
+        float angle = glm::radians(rotationAngleDegrees);
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        float t = 1.0f - c;
+        box.axes[0] = glm::vec3(c + t * k.x * k.x, t * k.x * k.y + s * k.z, t * k.x * k.z - s * k.y);
+        box.axes[1] = glm::vec3(t * k.x * k.y - s * k.z, c + t * k.y * k.y, t * k.y * k.z + s * k.x);
+        box.axes[2] = glm::vec3(t * k.x * k.z + s * k.y, t * k.y * k.z - s * k.x, c + t * k.z * k.z);
+    }
+
+    // 上向き（+Y）に最も近い面を上面とする
+    int topAxis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (std::abs(box.axes[i].y) > std::abs(box.axes[topAxis].y)) topAxis = i;
+    }
+    box.topNormal = (box.axes[topAxis].y >= 0.0f) ? box.axes[topAxis] : -box.axes[topAxis];
+    box.topDistance = glm::dot(box.topNormal, center) + box.halfExtents[topAxis];
+    return box;
+}
+
+bool OrientedBox::overlapsAABB(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+    // AABBをA（軸はワールド軸）、OBBをBとした分離軸判定
+    constexpr float EPSILON = 1e-6f;  // 辺同士が平行な場合の誤判定を防ぐ
+    glm::vec3 a = (boxMax - boxMin) * 0.5f;
+    glm::vec3 d = center - (boxMin + boxMax) * 0.5f;
+    const glm::vec3& b = halfExtents;
+
+    // R[i][j] = dot(e_i, axes[j]) = axes[j][i]
+    float r[3][3];
+    float absR[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            r[i][j] = axes[j][i];
+            absR[i][j] = std::abs(r[i][j]) + EPSILON;
+        }
+    }
+
+    // Aの面法線（ワールド軸）
+    for (int i = 0; i < 3; i++) {
+        float rb = b.x * absR[i][0] + b.y * absR[i][1] + b.z * absR[i][2];
+        if (std::abs(d[i]) > a[i] + rb) return false;
+    }
+
+    // Bの面法線
+    for (int j = 0; j < 3; j++) {
+        float ra = a.x * absR[0][j] + a.y * absR[1][j] + a.z * absR[2][j];
+        float distance = d.x * r[0][j] + d.y * r[1][j] + d.z * r[2][j];
+        if (std::abs(distance) > ra + b[j]) return false;
+    }
+
+    // 辺の組み合わせ e_i × axes[j]
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3;
+        int i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            int j1 = (j + 1) % 3;
+            int j2 = (j + 2) % 3;
+            float ra = a[i1] * absR[i2][j] + a[i2] * absR[i1][j];
+            float rb = b[j1] * absR[i][j2] + b[j2] * absR[i][j1];
+            float distance = d[i2] * r[i1][j] - d[i1] * r[i2][j];
+            if (std::abs(distance) > ra + rb) return false;
+        }
+    }
+    return true;
+}
+
+void OrientedBox::computeAABB(glm::vec3& outMin, glm::vec3& outMax) const {
+    glm::vec3 extent = glm::abs(axes[0]) * halfExtents.x +
+                       glm::abs(axes[1]) * halfExtents.y +
+                       glm::abs(axes[2]) * halfExtents.z;
+    outMin = center - extent;
+    outMax = center + extent;
+}
+
+bool OrientedBox::sweepTopPlane(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& displacement, float& outTime) const {
+    float approachSpeed = -glm::dot(topNormal, displacement);
+    if (approachSpeed <= 0.0f) return false;
+
+    // 平面側に最も出っ張ったAABBの点（法線と逆向きのサポート点）と平面との距離
+    glm::vec3 boxCenter = (boxMin + boxMax) * 0.5f;
+    glm::vec3 boxHalf = (boxMax - boxMin) * 0.5f;
+    float supportRadius = glm::dot(glm::abs(topNormal), boxHalf);
+    float gap = glm::dot(topNormal, boxCenter) - supportRadius - topDistance;
+    if (gap < 0.0f || gap > approachSpeed) return false;
+
+    outTime = gap / approachSpeed;
+    return true;
+}
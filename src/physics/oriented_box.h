@@ -0,0 +1,70 @@
+/**
+ * @file oriented_box.h
+ * @brief 有向境界ボックス
+ * @details 回転した直方体の衝突判定に使用する有向境界ボックス（OBB）を提供します。
+ */
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief 有向境界ボックス（OBB）
+ * @details 中心・3つのローカル軸・各軸方向の半サイズで回転した直方体を表します。
+ * 回転角度が変わったときにfromRotation()で作り直し、判定では行列を組み立てずに分離軸判定を行います。
+ * 上面は重力方向（-Y）と逆向きに最も近い面で、平面（法線と原点からの距離）として保持します。
+ */
+struct OrientedBox {
+    glm::vec3 center = glm::vec3(0.0f);
+    glm::vec3 axes[3] = {glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1)};  // ワールド座標系のローカル軸（正規化済み）
+    glm::vec3 halfExtents = glm::vec3(0.0f);
+    glm::vec3 topNormal = glm::vec3(0, 1, 0);  // 上面の法線
+    float topDistance = 0.0f;                  // 上面の平面: dot(topNormal, p) == topDistance
+
+    /**
+     * @brief 回転した直方体からOBBを作成する
+     * @details 描画（glm::rotate）と同じく、回転軸まわりに正の向きへ回転させます。
+     *
+     * @param center 中心位置
+     * @param size サイズ
+     * @param rotationAxis 回転軸
+     * @param rotationAngleDegrees 回転角度（単位: 度）
+     * @return OBB
+     */
+    static OrientedBox fromRotation(const glm::vec3& center, const glm::vec3& size,
+                                    const glm::vec3& rotationAxis, float rotationAngleDegrees);
+
+    /**
+     * @brief 軸平行境界ボックスと重なるかを判定する
+     * @details 分離軸定理（面法線6本と辺の組み合わせ9本）で判定します。接している場合も重なりとみなします。
+     *
+     * @param boxMin AABBの最小座標
+     * @param boxMax AABBの最大座標
+     * @return 重なっている場合true
+     */
+    bool overlapsAABB(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+
+    /**
+     * @brief OBBを囲む軸平行境界ボックスを求める
+     * @param outMin 出力: 最小座標
+     * @param outMax 出力: 最大座標
+     */
+    void computeAABB(glm::vec3& outMin, glm::vec3& outMax) const;
+
+    /**
+     * @brief 移動するAABBが上面の平面に達する時刻を求める
+     * @details AABBの上面側の最も出っ張った点が平面に達する時刻を計算します。
+     * 上面に向かって（法線と逆向きに）移動していない場合や、開始時点で既に平面より下にある場合は対象外です。
+     * 面の範囲内かどうかは判定しないため、呼び出し側でoverlapsAABB()により確認してください。
+     *
+     * @param boxMin 移動開始時のAABBの最小座標
+     * @param boxMax 移動開始時のAABBの最大座標
+     * @param displacement 移動量
+     * @param outTime 出力: 到達時刻（0〜1）
+     * @return 移動中に到達する場合true
+     */
+    bool sweepTopPlane(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& displacement, float& outTime) const;
+};
@@ -0,0 +1,118 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include "../game/game_state.h"
+#include "../game/stage_manager.h"
+#include "../game/platform_system.h"
+#include "../game/json_stage_loader.h"
+#include "../game/simulation_system.h"
+#include "../game/trigger_system.h"
+
+/**
+ * @brief ヘッドレス実行のエントリポイント
+ * @details ウィンドウ・描画・音声なしでステージを読み込み、固定デルタタイムで
+ * シミュレーションを全速力で進めて所要時間を計測します。
+ * 表示やGPUのないビルド環境でのベンチマーク・回帰確認用です。
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        printf("Usage: %s <stage_number | stage.json> [seconds] [tick_rate]\n", argv[0]);
+        printf("  stage_number: 0-6 (assets/stages から読み込み)\n");
+        printf("  stage.json:   任意のステージJSONファイル\n");
+        printf("  seconds:      シミュレーションするゲーム内時間（default: 60）\n");
+        printf("  tick_rate:    1秒あたりのステップ数（default: 60）\n");
+        printf("Examples:\n");
+        printf("  %s 5\n", argv[0]);
+        printf("  %s assets/stages/stage5.json 600 240\n", argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    float simulatedSeconds = (argc > 2) ? static_cast<float>(std::atof(argv[2])) : 60.0f;
+    int tickRate = (argc > 3) ? std::atoi(argv[3]) : 60;
+    if (simulatedSeconds <= 0.0f || tickRate <= 0) {
+        printf("Invalid seconds (%.2f) or tick rate (%d)\n", simulatedSeconds, tickRate);
+        return 1;
+    }
+
+    GameState gameState;
+    initializeGameState(gameState);
+    gameState.audioEnabled = false;
+
+    PlatformSystem platformSystem;
+    StageManager stageManager;
+
+    std::string stageArg = argv[1];
+    int currentStage = 1;
+    bool loaded = false;
+    auto loadStartTime = std::chrono::high_resolution_clock::now();
+
+    if (stageArg.size() > 5 && stageArg.compare(stageArg.size() - 5, 5, ".json") == 0) {
+        platformSystem.clear();
+        loaded = JsonStageLoader::loadStageFromJSON(stageArg, gameState, platformSystem);
+        TriggerSystem::rebuild(gameState, false);
+        gameState.player.lastCheckpoint = gameState.player.position;
+        gameState.player.lastCheckpointItemId = -1;
+        gameState.progress.currentStage = currentStage;
+    } else {
+        currentStage = std::atoi(stageArg.c_str());
+        if (!stageManager.isStageUnlocked(currentStage)) {
+            stageManager.unlockStage(currentStage);
+        }
+        loaded = stageManager.loadStage(currentStage, gameState, platformSystem);
+    }
+
+    if (!loaded || platformSystem.getPlatforms().empty()) {
+        printf("HEADLESS: Failed to load stage: %s\n", stageArg.c_str());
+        return 1;
+    }
+
+    auto loadEndTime = std::chrono::high_resolution_clock::now();
+    float loadMs = std::chrono::duration<float, std::milli>(loadEndTime - loadStartTime).count();
+
+    std::map<std::string, int> sfxCounts;
+    bool goalReached = false;
+    SimulationEvents events;
+    events.onPlaySFX = [&sfxCounts](const std::string& sfxName) {
+        sfxCounts[sfxName]++;
+    };
+    events.onGoalReached = [&goalReached]() {
+        goalReached = true;
+    };
+
+    const float tickDeltaTime = 1.0f / static_cast<float>(tickRate);
+    const long long totalTicks = static_cast<long long>(simulatedSeconds * tickRate);
+
+    auto simStartTime = std::chrono::high_resolution_clock::now();
+    for (long long tick = 0; tick < totalTicks; tick++) {
+        SimulationSystem::step(gameState, platformSystem, currentStage, tickDeltaTime, events);
+    }
+    auto simEndTime = std::chrono::high_resolution_clock::now();
+
+    double simMs = std::chrono::duration<double, std::milli>(simEndTime - simStartTime).count();
+    double usPerTick = totalTicks > 0 ? (simMs * 1000.0) / static_cast<double>(totalTicks) : 0.0;
+    double ticksPerSecond = simMs > 0.0 ? static_cast<double>(totalTicks) / (simMs / 1000.0) : 0.0;
+
+    printf("HEADLESS: stage=%s platforms=%zu items=%zu\n",
+           stageArg.c_str(), platformSystem.getPlatforms().size(), gameState.items.items.size());
+    printf("HEADLESS: load=%.2fms ticks=%lld (%.1fs @ %dHz)\n", loadMs, totalTicks, simulatedSeconds, tickRate);
+    printf("HEADLESS: sim=%.2fms %.3fus/tick %.0f ticks/s (x%.1f realtime)\n",
+           simMs, usPerTick, ticksPerSecond, ticksPerSecond / static_cast<double>(tickRate));
+    printf("HEADLESS: player=(%.3f, %.3f, %.3f) velocity=(%.3f, %.3f, %.3f)\n",
+           gameState.player.position.x, gameState.player.position.y, gameState.player.position.z,
+           gameState.player.velocity.x, gameState.player.velocity.y, gameState.player.velocity.z);
+    printf("HEADLESS: collected=%d/%d lives=%d goal=%s gameOver=%s\n",
+           gameState.items.collectedItems, gameState.items.requiredItems, gameState.progress.lives,
+           goalReached ? "true" : "false", gameState.progress.isGameOver ? "true" : "false");
+    for (const auto& [sfxName, count] : sfxCounts) {
+        printf("HEADLESS: event %s x%d\n", sfxName.c_str(), count);
+    }
+
+    return 0;
+}
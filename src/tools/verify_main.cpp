@@ -0,0 +1,250 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../game/game_state.h"
+#include "../game/stage_manager.h"
+#include "../game/platform_system.h"
+#include "../game/json_stage_loader.h"
+#include "../game/trigger_system.h"
+#include "../game/replay_codec.h"
+#include "../game/input_replay_system.h"
+
+namespace {
+
+/**
+ * @brief 1つのリプレイの検証結果
+ */
+struct VerifyResult {
+    std::string path;
+    bool accepted = false;
+    std::string reason;       // 不合格の理由（合格時は空）
+    int stageNumber = -1;
+    float claimedTime = 0.0f;
+    InputReplaySystem::SimulationResult simulation;
+};
+
+/**
+ * @brief 入力リプレイを読み込む
+ * @details .slin（ReplayCodec::encodeInputs）のほか、ランキング送信時のJSON
+ * （{"time", "replayData": {"clearTime", "inputs"}}、またはreplayDataのみ）を受け付けます。
+ * 申告タイムは"time"、なければ"clearTime"、どちらもなければ入力リプレイに記録されたクリアタイムです。
+ */
+bool readReplayFile(const std::string& path, InputReplay& replay, float& claimedTime) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (!ReplayCodec::decodeInputs(bytes.data(), bytes.size(), replay)) {
+        nlohmann::json submission;
+        try {
+            submission = nlohmann::json::parse(std::string(bytes.begin(), bytes.end()));
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (!submission.is_object()) {
+            return false;
+        }
+        const nlohmann::json& replayJson = submission.contains("replayData") ? submission["replayData"] : submission;
+        if (!replayJson.is_object() || !replayJson.contains("inputs") || !replayJson["inputs"].is_string()) {
+            return false;
+        }
+
+        std::vector<uint8_t> inputBytes;
+        if (!ReplayCodec::fromBase64(replayJson["inputs"].get<std::string>(), inputBytes) ||
+            !ReplayCodec::decodeInputs(inputBytes.data(), inputBytes.size(), replay)) {
+            return false;
+        }
+
+        claimedTime = replay.clearTime;
+        if (submission.contains("time") && submission["time"].is_number()) {
+            claimedTime = submission["time"].get<float>();
+        } else if (replayJson.contains("clearTime") && replayJson["clearTime"].is_number()) {
+            claimedTime = replayJson["clearTime"].get<float>();
+        }
+        return true;
+    }
+
+    claimedTime = replay.clearTime;
+    return true;
+}
+
+VerifyResult verifyReplay(const std::string& path, const GameState& loadedState, const PlatformSystem& loadedPlatforms,
+                          int stageNumber) {
+    VerifyResult result;
+    result.path = path;
+
+    InputReplay replay;
+    if (!readReplayFile(path, replay, result.claimedTime)) {
+        result.reason = "invalid_replay";
+        return result;
+    }
+    result.stageNumber = replay.stageNumber;
+    if (stageNumber >= 0 && replay.stageNumber != stageNumber) {
+        result.reason = "stage_mismatch";
+        return result;
+    }
+
+    // 読み込み済みのステージを複製して使い、リプレイごとにJSONを読み直さない
+    GameState gameState = loadedState;
+    PlatformSystem platformSystem = loadedPlatforms;
+    result.simulation = InputReplaySystem::simulate(replay, gameState, platformSystem);
+
+    const auto& simulation = result.simulation;
+    // 申告タイムと再シミュレーションのタイムは、同じティック数なら浮動小数点の丸め誤差しか違わない
+    float tolerance = 1.0f / static_cast<float>(replay.tickRate) + 1e-3f;
+    if (!simulation.stageHashMatched) {
+        result.reason = "stage_hash_mismatch";
+    } else if (!simulation.goalReached) {
+        result.reason = "goal_not_reached";
+    } else if (simulation.collectedItems < simulation.requiredItems) {
+        result.reason = "items_missing";
+    } else if (!std::isfinite(result.claimedTime) || std::abs(simulation.clearTime - result.claimedTime) > tolerance) {
+        result.reason = "clear_time_mismatch";
+    } else {
+        result.accepted = true;
+    }
+    return result;
+}
+
+bool isReplayFile(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    return extension == ".slin" || extension == ".json";
+}
+
+} // namespace
+
+/**
+ * @brief リプレイ検証のエントリポイント
+ * @details ステージを読み込み、入力リプレイを描画なしで全速力で再シミュレーションして、
+ * 申告されたクリアタイムとアイテム収集が入力から得られるものかを判定します。
+ * ディレクトリを指定した場合は、中のリプレイを複数スレッドで並列に検証します。
+ * 結果は1リプレイにつき1行の"VERIFY:"で出力し、全て合格なら終了コード0、不合格があれば2を返します。
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        printf("Usage: %s <stage_number | stage.json> <replay.slin | replay.json | directory> [--jobs N]\n", argv[0]);
+        printf("  stage_number: 1-5 (assets/stages から読み込み)\n");
+        printf("  stage.json:   任意のステージJSONファイル\n");
+        printf("  replay:       入力リプレイ（.slin）またはランキング送信JSON（replayData.inputsを含む）\n");
+        printf("  directory:    中の.slin/.jsonを全て検証\n");
+        printf("  --jobs N:     並列数（default: CPUコア数）\n");
+        printf("Exit code: 0 = all accepted, 2 = some rejected, 1 = error\n");
+        printf("Examples:\n");
+        printf("  %s 3 assets/replays/stage3_best.slin\n", argv[0]);
+        printf("  %s assets/stages/stage5.json submissions/ --jobs 8\n", argv[0]);
+        return argc < 3 ? 1 : 0;
+    }
+
+    int jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = std::max(std::atoi(argv[++i]), 1);
+        }
+    }
+
+    std::string stageArg = argv[1];
+    std::string replayArg = argv[2];
+
+    std::vector<std::string> replayPaths;
+    std::error_code error;
+    if (std::filesystem::is_directory(replayArg, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator(replayArg, error)) {
+            if (entry.is_regular_file() && isReplayFile(entry.path())) {
+                replayPaths.push_back(entry.path().string());
+            }
+        }
+        std::sort(replayPaths.begin(), replayPaths.end());
+    } else {
+        replayPaths.push_back(replayArg);
+    }
+    if (replayPaths.empty()) {
+        printf("VERIFY: No replay files found: %s\n", replayArg.c_str());
+        return 1;
+    }
+
+    GameState gameState;
+    initializeGameState(gameState);
+    gameState.audioEnabled = false;
+
+    PlatformSystem platformSystem;
+    StageManager stageManager;
+
+    int stageNumber = -1;  // JSONファイルの場合はリプレイのステージ番号を確かめない（ハッシュで確かめる）
+    bool loaded = false;
+    if (stageArg.size() > 5 && stageArg.compare(stageArg.size() - 5, 5, ".json") == 0) {
+        platformSystem.clear();
+        loaded = JsonStageLoader::loadStageFromJSON(stageArg, gameState, platformSystem);
+        platformSystem.rebuildSpatialIndex();
+        TriggerSystem::rebuild(gameState, false);
+        gameState.player.lastCheckpoint = gameState.player.position;
+        gameState.player.lastCheckpointItemId = -1;
+    } else {
+        stageNumber = std::atoi(stageArg.c_str());
+        if (!stageManager.isStageUnlocked(stageNumber)) {
+            stageManager.unlockStage(stageNumber);
+        }
+        loaded = stageManager.loadStage(stageNumber, gameState, platformSystem);
+    }
+
+    if (!loaded || platformSystem.getPlatforms().empty()) {
+        printf("VERIFY: Failed to load stage: %s\n", stageArg.c_str());
+        return 1;
+    }
+
+    std::vector<VerifyResult> results(replayPaths.size());
+    std::atomic<size_t> nextReplay{0};
+    jobs = std::min(jobs, static_cast<int>(replayPaths.size()));
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    auto worker = [&]() {
+        for (size_t index = nextReplay++; index < replayPaths.size(); index = nextReplay++) {
+            results[index] = verifyReplay(replayPaths[index], gameState, platformSystem, stageNumber);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < jobs; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    int acceptedCount = 0;
+    for (const auto& result : results) {
+        const auto& simulation = result.simulation;
+        if (result.accepted) {
+            acceptedCount++;
+            printf("VERIFY: %s OK stage=%d ticks=%zu clear=%.3f claimed=%.3f items=%d/%d\n",
+                   result.path.c_str(), result.stageNumber, simulation.ticks, simulation.clearTime, result.claimedTime,
+                   simulation.collectedItems, simulation.requiredItems);
+        } else {
+            printf("VERIFY: %s REJECT reason=%s stage=%d ticks=%zu clear=%.3f claimed=%.3f items=%d/%d\n",
+                   result.path.c_str(), result.reason.c_str(), result.stageNumber, simulation.ticks, simulation.clearTime,
+                   result.claimedTime, simulation.collectedItems, simulation.requiredItems);
+        }
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    printf("VERIFY: %zu replays, %d accepted, %zu rejected, %.2fms (%d threads)\n",
+           results.size(), acceptedCount, results.size() - acceptedCount, elapsedMs, jobs);
+
+    return (acceptedCount == static_cast<int>(results.size())) ? 0 : 2;
+}